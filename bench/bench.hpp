@@ -0,0 +1,50 @@
+/**
+ * \file Helpers shared by the benchmarks. Each benchmark is a plain
+ * executable that prints its timings; build in Release mode to get
+ * meaningful numbers.
+ */
+#ifndef BENCH_HPP_
+#define BENCH_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace bench {
+
+    /**
+     * Run \c f \c repetitions times and return the fastest run in seconds.
+     */
+    template<typename F>
+    double measure( F f, int repetitions = 5 ) {
+        double best = 1e300 ;
+        for( int r = 0; r < repetitions; ++r ) {
+            const auto start = std::chrono::steady_clock::now() ;
+            f() ;
+            const auto stop = std::chrono::steady_clock::now() ;
+            best = std::min( best, std::chrono::duration<double>( stop - start ).count() ) ;
+        }
+        return best;
+    }
+
+    /**
+     * Print one result line: name, time and throughput in items per second.
+     */
+    inline void report( const std::string& name, double seconds, double items ) {
+        std::cout << "  " << std::left << std::setw( 44 ) << name
+                  << std::right << std::setw( 12 ) << std::setprecision( 4 ) << seconds * 1e3 << " ms"
+                  << std::setw( 12 ) << std::setprecision( 4 ) << items / seconds / 1e6 << " M/s" << std::endl ;
+    }
+
+    /**
+     * Keep the compiler from optimizing away a computed value.
+     */
+    template<typename T>
+    void doNotOptimize( const T& value ) {
+        asm volatile( "" : : "g"( &value ) : "memory" ) ;
+    }
+}
+
+#endif /* BENCH_HPP_ */
@@ -0,0 +1,71 @@
+/**
+ * \file Frequency sweep of a series RLC circuit: the current phasors
+ * I = U / Z computed with std::complex<double>, with Complex<> quantities
+ * and with split real and imaginary arrays in ComplexArray<>.
+ */
+#include <complex>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Complex.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : std::size_t( 1 ) << 20 ;
+    const Resistance r = 10_Ohm ;
+    const Inductance l = 0.1_H ;
+    const Capacitance c = 100e-6_F ;
+
+    std::vector<std::complex<double>> plainZ( n ), plainU( n ), plainI( n ) ;
+    std::vector<Impedance> z( n ) ;
+    std::vector<Complex<Voltage>> u( n ) ;
+    std::vector<Complex<Current>> i( n ) ;
+    ComplexArray<Resistance> zArray( n ) ;
+    ComplexArray<Voltage> uArray( n ) ;
+    ComplexArray<Current> iArray( n ) ;
+    for( std::size_t k = 0; k < n; ++k ) {
+        const AngularVelocity omega = 2 * M_PI * Frequency( 1.0 + k * 1e-3 ) ;
+        z[k] = Impedance( r, omega * l - 1 / ( omega * c ) ) ;
+        u[k] = Complex<Voltage>::polar( 230_V, Angle( k * 1e-6 ) ) ;
+        plainZ[k] = z[k].getValue() ;
+        plainU[k] = u[k].getValue() ;
+        zArray.set( k, z[k] ) ;
+        uArray.set( k, u[k] ) ;
+    }
+    std::cout << "Current phasors I = U / Z, " << n << " frequencies" << std::endl ;
+
+    const double plain = bench::measure( [&]() {
+        for( std::size_t k = 0; k < n; ++k ) {
+            plainI[k] = plainU[k] / plainZ[k] ;
+        }
+        bench::doNotOptimize( plainI ) ;
+    } ) ;
+    bench::report( "std::complex<double> quotient", plain, double( n ) ) ;
+
+    const double typed = bench::measure( [&]() {
+        for( std::size_t k = 0; k < n; ++k ) {
+            i[k] = u[k] / z[k] ;
+        }
+        bench::doNotOptimize( i ) ;
+    } ) ;
+    bench::report( "Complex<> quotient", typed, double( n ) ) ;
+    std::cout << "    " << typed / plain << "x std::complex" << std::endl ;
+
+    const double soa = bench::measure( [&]() {
+        divide( uArray, zArray, iArray ) ;
+        bench::doNotOptimize( iArray ) ;
+    } ) ;
+    bench::report( "ComplexArray quotient", soa, double( n ) ) ;
+    std::cout << "    " << soa / plain << "x std::complex" << std::endl ;
+
+    const double product = bench::measure( [&]() {
+        multiply( iArray, zArray, uArray ) ;
+        bench::doNotOptimize( uArray ) ;
+    } ) ;
+    bench::report( "ComplexArray product", product, double( n ) ) ;
+    std::cout << "  |I| at " << 1.0 + ( n - 1 ) * 1e-3 << " Hz: " << abs( iArray[n - 1] ) << std::endl ;
+    return 0 ;
+}
@@ -0,0 +1,108 @@
+/**
+ * \file Cumulative sums and trapezoidal integrals compared with plain
+ * loops, for throughput and for accuracy against a long double reference.
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Cumulative.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+/**
+ * Largest error relative to the largest magnitude of the reference.
+ */
+template<typename Q>
+double maxError( const std::vector<Q>& x, const std::vector<long double>& reference ) {
+    long double error = 0, scale = 0 ;
+    for( std::size_t i = 0; i < x.size(); ++i ) {
+        error = std::max( error, std::abs( x[i].getValue() - reference[i] ) ) ;
+        scale = std::max( scale, std::abs( reference[i] ) ) ;
+    }
+    return static_cast<double>( error / scale );
+}
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : std::size_t( 1 ) << 24 ;
+    std::mt19937 rng( 7 ) ;
+    std::uniform_real_distribution<double> u( 0.0, 1000.0 ) ;
+    std::vector<Power> power( n ) ;
+    for( auto& p : power ) {
+        p = Power( u( rng ) ) ;
+    }
+    const Time dt = 0.001_s ;
+    std::vector<Energy> energy( n ) ;
+    parallel::ThreadPool single( 1 ) ;
+
+    std::cout << "Cumulative sums of " << n << " Power samples, " << parallel::ThreadPool::global().size()
+              << " threads" << std::endl ;
+
+    // Reference in long double
+    std::vector<long double> sumReference( n ), trapzReference( n ) ;
+    long double s = 0, t = 0 ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        s += power[i].getValue() ;
+        sumReference[i] = s ;
+        if( i > 0 ) {
+            t += 0.5L * dt.getValue() * ( (long double)power[i - 1].getValue() + power[i].getValue() ) ;
+        }
+        trapzReference[i] = t ;
+    }
+
+    std::vector<Power> sums( n ) ;
+    double seconds = bench::measure( [&]() {
+        Power sum ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            sum = sum + power[i] ;
+            sums[i] = sum ;
+        }
+        bench::doNotOptimize( sums ) ;
+    } ) ;
+    bench::report( "cumsum, plain loop", seconds, double( n ) ) ;
+    std::cout << "    relative error " << maxError( sums, sumReference ) << std::endl ;
+
+    seconds = bench::measure( [&]() {
+        cumsum( power.data(), n, sums.data(), single ) ;
+        bench::doNotOptimize( sums ) ;
+    } ) ;
+    bench::report( "cumsum, vector kernel, 1 thread", seconds, double( n ) ) ;
+    std::cout << "    relative error " << maxError( sums, sumReference ) << std::endl ;
+
+    seconds = bench::measure( [&]() {
+        cumsum( power.data(), n, sums.data() ) ;
+        bench::doNotOptimize( sums ) ;
+    } ) ;
+    bench::report( "cumsum, vector kernel, all threads", seconds, double( n ) ) ;
+    std::cout << "    relative error " << maxError( sums, sumReference ) << std::endl ;
+
+    seconds = bench::measure( [&]() {
+        Energy e ;
+        energy[0] = e ;
+        for( std::size_t i = 1; i < n; ++i ) {
+            e = e + 0.5 * ( power[i - 1] + power[i] ) * dt ;
+            energy[i] = e ;
+        }
+        bench::doNotOptimize( energy ) ;
+    } ) ;
+    bench::report( "cumtrapz, plain loop", seconds, double( n ) ) ;
+    std::cout << "    relative error " << maxError( energy, trapzReference ) << std::endl ;
+
+    seconds = bench::measure( [&]() {
+        cumtrapz( power.data(), n, dt, energy.data(), single ) ;
+        bench::doNotOptimize( energy ) ;
+    } ) ;
+    bench::report( "cumtrapz, vector kernel, 1 thread", seconds, double( n ) ) ;
+    std::cout << "    relative error " << maxError( energy, trapzReference ) << std::endl ;
+
+    seconds = bench::measure( [&]() {
+        cumtrapz( power.data(), n, dt, energy.data() ) ;
+        bench::doNotOptimize( energy ) ;
+    } ) ;
+    bench::report( "cumtrapz, vector kernel, all threads", seconds, double( n ) ) ;
+    std::cout << "    relative error " << maxError( energy, trapzReference ) << std::endl ;
+    return 0 ;
+}
@@ -0,0 +1,68 @@
+/**
+ * \file Conversion throughput and rounding error of fp16 and bfloat16
+ * storage of Speed features, and the cost of summing them against the
+ * doubles. Build with -mf16c (or -march=native) for the F16C kernels.
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "HalfPrecision.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+template<typename Format>
+void run( const std::string& name, const std::vector<Speed>& speeds )
+{
+    const std::size_t n = speeds.size() ;
+    std::vector<StoredQuantity<Speed, Format>> stored( n ) ;
+    const double packing = bench::measure( [&]() {
+        pack( speeds.data(), n, stored.data() ) ;
+        bench::doNotOptimize( stored ) ;
+    } ) ;
+
+    std::vector<Speed> restored( n ) ;
+    const double unpacking = bench::measure( [&]() {
+        unpack( stored.data(), n, restored.data() ) ;
+        bench::doNotOptimize( restored ) ;
+    } ) ;
+
+    std::vector<float> floats( n ) ;
+    const double unpackingFloats = bench::measure( [&]() {
+        unpack( stored.data(), n, floats.data() ) ;
+        bench::doNotOptimize( floats ) ;
+    } ) ;
+
+    double worst = 0 ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        worst = std::max( worst, std::fabs( restored[i].getValue() / speeds[i].getValue() - 1.0 ) ) ;
+    }
+    std::cout << name << ": " << sizeof(StoredQuantity<Speed, Format>) << " bytes per value, worst relative error "
+              << worst << std::endl ;
+    bench::report( "  pack", packing, double( n ) ) ;
+    bench::report( "  unpack to Speed", unpacking, double( n ) ) ;
+    bench::report( "  unpack to float", unpackingFloats, double( n ) ) ;
+}
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : 10000000 ;
+    std::mt19937_64 rng( 9 ) ;
+    std::lognormal_distribution<double> traffic( 2.5, 0.6 ) ;
+    std::vector<Speed> speeds( n ) ;
+    for( auto& v : speeds ) {
+        v = Speed( traffic( rng ) ) ;
+    }
+#if defined(__AVX512F__)
+    std::cout << n << " speeds, AVX-512F kernels" << std::endl ;
+#elif defined(__F16C__) && defined(__AVX__)
+    std::cout << n << " speeds, F16C kernels" << std::endl ;
+#else
+    std::cout << n << " speeds, scalar fp16 kernels" << std::endl ;
+#endif
+    run<Float16>( "fp16", speeds ) ;
+    run<BFloat16>( "bfloat16", speeds ) ;
+    return 0;
+}
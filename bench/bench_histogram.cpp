@@ -0,0 +1,80 @@
+/**
+ * \file Histogram of Speed samples on uniform and explicit bins compared
+ * with a plain binning loop.
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Histogram.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : std::size_t( 1 ) << 24 ;
+    const std::size_t bins = 100 ;
+    std::mt19937_64 rng( 9 ) ;
+    std::normal_distribution<double> normal( 20.0, 6.0 ) ;
+    std::vector<Speed> speeds( n ) ;
+    for( auto& s : speeds ) {
+        s = Speed( normal( rng ) ) ;
+    }
+    std::cout << "Histogram of " << n << " speeds, " << bins << " bins, "
+              << parallel::ThreadPool::global().size() << " threads" << std::endl ;
+
+    std::vector<std::uint64_t> plainCounts( bins + 2 ) ;
+    const double plain = bench::measure( [&]() {
+        std::fill( plainCounts.begin(), plainCounts.end(), 0 ) ;
+        for( const Speed& s : speeds ) {
+            const double t = std::floor( ( s.getValue() - 0.0 ) * ( double( bins ) / 40.0 ) ) ;
+            if( t < 0 ) {
+                ++plainCounts[0] ;
+            } else if( t >= double( bins ) ) {
+                ++plainCounts[bins + 1] ;
+            } else {
+                ++plainCounts[std::size_t( t ) + 1] ;
+            }
+        }
+        bench::doNotOptimize( plainCounts ) ;
+    } ) ;
+    bench::report( "plain loop", plain, double( n ) ) ;
+    std::cout << "    " << double( n ) * sizeof(double) / plain * 1e-9 << " GB/s" << std::endl ;
+
+    parallel::ThreadPool single( 1 ) ;
+    Histogram<Speed> uniform( 0_mps, 40_mps, bins ) ;
+    double seconds = bench::measure( [&]() {
+        uniform.clear() ;
+        uniform.add( speeds, single ) ;
+    } ) ;
+    bench::report( "Histogram, uniform bins, 1 thread", seconds, double( n ) ) ;
+    std::size_t mismatches = uniform.underflow() != plainCounts[0] || uniform.overflow() != plainCounts[bins + 1] ;
+    for( std::size_t b = 0; b < bins; ++b ) {
+        mismatches += uniform.count( b ) != plainCounts[b + 1] ;
+    }
+    std::cout << "    " << double( n ) * sizeof(double) / seconds * 1e-9 << " GB/s, "
+              << plain / seconds << "x the plain loop, " << mismatches << " bins differ" << std::endl ;
+
+    seconds = bench::measure( [&]() {
+        uniform.clear() ;
+        uniform.add( speeds ) ;
+    } ) ;
+    bench::report( "Histogram, uniform bins, thread pool", seconds, double( n ) ) ;
+    std::cout << "    " << double( n ) * sizeof(double) / seconds * 1e-9 << " GB/s" << std::endl ;
+
+    std::vector<Speed> edges ;
+    for( std::size_t b = 0; b <= bins; ++b ) {
+        edges.push_back( Speed( 40.0 * double( b ) / double( bins ) ) ) ;
+    }
+    Histogram<Speed> explicitEdges( edges ) ;
+    seconds = bench::measure( [&]() {
+        explicitEdges.clear() ;
+        explicitEdges.add( speeds ) ;
+    } ) ;
+    bench::report( "Histogram, explicit edges", seconds, double( n ) ) ;
+    std::cout << "    " << double( n ) * sizeof(double) / seconds * 1e-9 << " GB/s, mode at "
+              << explicitEdges.center( explicitEdges.maximum() ) << std::endl ;
+    return 0;
+}
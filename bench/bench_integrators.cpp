@@ -0,0 +1,76 @@
+/**
+ * \file Typed ODE integrators compared with the same integrators written on
+ * plain doubles. Integrates many independent harmonic oscillators.
+ */
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Integrators.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+using State = StateVector<Length, Speed> ;
+
+int main()
+{
+    const std::size_t systems = 100000 ;
+    const int steps = 100 ;
+    const Time dt = 0.01_s ;
+    const Frequency omega = 2.0 / 1_s ;
+
+    auto f = [omega]( const Time&, const State& x ) {
+        return DerivativeOf<State>( x.get<1>(), x.get<0>() * ( -1.0 * omega * omega ) ) ;
+    } ;
+
+    std::cout << "RK4, " << systems << " oscillators x " << steps << " steps" << std::endl ;
+
+    // Typed, one system at a time
+    std::vector<State> states( systems, State( 1_m, 0_mps ) ) ;
+    double seconds = bench::measure( [&]() {
+        for( int k = 0; k < steps; ++k ) {
+            for( auto& s : states ) {
+                s = rk4Step( f, Time(), s, dt ) ;
+            }
+        }
+        bench::doNotOptimize( states ) ;
+    } ) ;
+    bench::report( "typed rk4Step (AoS)", seconds, double( systems ) * steps ) ;
+
+    // Typed, structure of arrays
+    BatchIntegrator<State> batch( systems ) ;
+    for( std::size_t i = 0; i < systems; ++i ) {
+        batch.set( i, State( 1_m, 0_mps ) ) ;
+    }
+    seconds = bench::measure( [&]() {
+        for( int k = 0; k < steps; ++k ) {
+            batch.stepRK4( f, Time(), dt ) ;
+        }
+        bench::doNotOptimize( batch ) ;
+    } ) ;
+    bench::report( "typed BatchIntegrator::stepRK4 (SoA)", seconds, double( systems ) * steps ) ;
+
+    // Untyped, structure of arrays
+    std::vector<double> x( systems, 1.0 ), v( systems, 0.0 ) ;
+    const double h = dt.getValue() ;
+    const double w2 = omega.getValue() * omega.getValue() ;
+    seconds = bench::measure( [&]() {
+        for( int k = 0; k < steps; ++k ) {
+            for( std::size_t i = 0; i < systems; ++i ) {
+                const double x0 = x[i], v0 = v[i] ;
+                const double k1x = v0, k1v = -w2 * x0 ;
+                const double k2x = v0 + 0.5 * h * k1v, k2v = -w2 * ( x0 + 0.5 * h * k1x ) ;
+                const double k3x = v0 + 0.5 * h * k2v, k3v = -w2 * ( x0 + 0.5 * h * k2x ) ;
+                const double k4x = v0 + h * k3v, k4v = -w2 * ( x0 + h * k3x ) ;
+                x[i] = x0 + h / 6.0 * ( k1x + 2 * k2x + 2 * k3x + k4x ) ;
+                v[i] = v0 + h / 6.0 * ( k1v + 2 * k2v + 2 * k3v + k4v ) ;
+            }
+        }
+        bench::doNotOptimize( x ) ;
+    } ) ;
+    bench::report( "untyped RK4 (SoA)", seconds, double( systems ) * steps ) ;
+
+    std::cout << "  check: typed " << states[0].get<0>() << ", batch " << batch.get( 0 ).get<0>()
+              << ", untyped " << x[0] << " m" << std::endl ;
+    return 0 ;
+}
@@ -0,0 +1,71 @@
+/**
+ * \file Cost of guaranteed bounds: plain quantities compared with scalar
+ * Interval<> arithmetic and with the SIMD kernels of IntervalArray<>.
+ */
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Interval.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : std::size_t( 1 ) << 20 ;
+    std::mt19937 rng( 5 ) ;
+    std::uniform_real_distribution<double> u( 1.0, 2.0 ) ;
+
+    std::vector<Force> forces( n ) ;
+    std::vector<Area> areas( n ) ;
+    std::vector<Interval<Force>> forceIntervals( n ) ;
+    std::vector<Interval<Area>> areaIntervals( n ) ;
+    IntervalArray<Force> forceArray( n ) ;
+    IntervalArray<Area> areaArray( n ) ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        forces[i] = Force( u( rng ) ) ;
+        areas[i] = Area( u( rng ) ) ;
+        forceIntervals[i] = Interval<Force>( forces[i] * 0.99, forces[i] * 1.01 ) ;
+        areaIntervals[i] = Interval<Area>( areas[i] * 0.999, areas[i] * 1.001 ) ;
+        forceArray.set( i, forceIntervals[i] ) ;
+        areaArray.set( i, areaIntervals[i] ) ;
+    }
+    std::cout << "Pressure = force / area, " << n << " elements" << std::endl ;
+
+    std::vector<Pressure> pressures( n ) ;
+    const double plain = bench::measure( [&]() {
+        for( std::size_t i = 0; i < n; ++i ) {
+            pressures[i] = forces[i] / areas[i] ;
+        }
+        bench::doNotOptimize( pressures ) ;
+    } ) ;
+    bench::report( "Quantity quotient", plain, double( n ) ) ;
+
+    std::vector<Interval<Pressure>> pressureIntervals( n ) ;
+    const double scalar = bench::measure( [&]() {
+        for( std::size_t i = 0; i < n; ++i ) {
+            pressureIntervals[i] = forceIntervals[i] / areaIntervals[i] ;
+        }
+        bench::doNotOptimize( pressureIntervals ) ;
+    } ) ;
+    bench::report( "Interval quotient", scalar, double( n ) ) ;
+    std::cout << "    " << scalar / plain << "x the plain quotient" << std::endl ;
+
+    IntervalArray<Pressure> pressureArray( n ) ;
+    const double soa = bench::measure( [&]() {
+        divide( forceArray, areaArray, pressureArray ) ;
+        bench::doNotOptimize( pressureArray ) ;
+    } ) ;
+    bench::report( "IntervalArray quotient", soa, double( n ) ) ;
+    std::cout << "    " << soa / plain << "x the plain quotient, " << scalar / soa << "x faster than scalar" << std::endl ;
+
+    // The kernels and the scalar operators agree bit for bit
+    std::size_t mismatches = 0 ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        mismatches += pressureArray.lowers()[i] != pressureIntervals[i].lower().getValue()
+                      || pressureArray.uppers()[i] != pressureIntervals[i].upper().getValue() ;
+    }
+    std::cout << "  " << mismatches << " bounds differ from the scalar operators" << std::endl ;
+    return 0 ;
+}
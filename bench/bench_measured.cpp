@@ -0,0 +1,88 @@
+/**
+ * \file Cost of first-order uncertainty propagation compared with plain
+ * quantities and with Monte-Carlo propagation.
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Measured.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : std::size_t( 1 ) << 20 ;
+    const int samples = 1000 ;
+    std::mt19937 rng( 3 ) ;
+    std::uniform_real_distribution<double> u( 1.0, 2.0 ) ;
+
+    std::vector<Length> arms( n ) ;
+    std::vector<Force> forces( n ) ;
+    std::vector<Measured<Length>> measuredArms( n ) ;
+    std::vector<Measured<Force>> measuredForces( n ) ;
+    MeasuredArray<Length> armArray( n ) ;
+    MeasuredArray<Force> forceArray( n ) ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        arms[i] = Length( u( rng ) ) ;
+        forces[i] = Force( u( rng ) ) ;
+        measuredArms[i] = Measured<Length>( arms[i], arms[i] * 0.01 ) ;
+        measuredForces[i] = Measured<Force>( forces[i], forces[i] * 0.02 ) ;
+        armArray.set( i, measuredArms[i] ) ;
+        forceArray.set( i, measuredForces[i] ) ;
+    }
+    std::cout << "Torque = arm * force, " << n << " elements" << std::endl ;
+
+    std::vector<MomentOfForce> torques( n ) ;
+    const double plain = bench::measure( [&]() {
+        for( std::size_t i = 0; i < n; ++i ) {
+            torques[i] = arms[i] * forces[i] ;
+        }
+        bench::doNotOptimize( torques ) ;
+    } ) ;
+    bench::report( "Quantity product", plain, double( n ) ) ;
+
+    std::vector<Measured<MomentOfForce>> measuredTorques( n ) ;
+    double seconds = bench::measure( [&]() {
+        for( std::size_t i = 0; i < n; ++i ) {
+            measuredTorques[i] = measuredArms[i] * measuredForces[i] ;
+        }
+        bench::doNotOptimize( measuredTorques ) ;
+    } ) ;
+    bench::report( "Measured product", seconds, double( n ) ) ;
+    std::cout << "    " << seconds / plain << "x the plain product" << std::endl ;
+
+    MeasuredArray<MomentOfForce> torqueArray( n ) ;
+    const double soa = bench::measure( [&]() {
+        multiply( armArray, forceArray, torqueArray ) ;
+        bench::doNotOptimize( torqueArray ) ;
+    } ) ;
+    bench::report( "MeasuredArray product", soa, double( n ) ) ;
+    std::cout << "    " << soa / plain << "x the plain product" << std::endl ;
+
+    // Monte-Carlo on a subset: draw the inputs and take the spread of the
+    // products
+    const std::size_t m = std::max<std::size_t>( 1, n / 1000 ) ;
+    std::normal_distribution<double> normal ;
+    std::vector<double> spread( m ) ;
+    const double mc = bench::measure( [&]() {
+        for( std::size_t i = 0; i < m; ++i ) {
+            double sum = 0, sum2 = 0 ;
+            for( int k = 0; k < samples; ++k ) {
+                const double a = armArray.values()[i] + armArray.sigmas()[i] * normal( rng ) ;
+                const double f = forceArray.values()[i] + forceArray.sigmas()[i] * normal( rng ) ;
+                sum += a * f ;
+                sum2 += a * f * a * f ;
+            }
+            spread[i] = std::sqrt( ( sum2 - sum * sum / samples ) / ( samples - 1 ) ) ;
+        }
+        bench::doNotOptimize( spread ) ;
+    }, 1 ) ;
+    bench::report( "Monte-Carlo, " + std::to_string( samples ) + " samples", mc, double( m ) ) ;
+    std::cout << "    " << ( mc / m ) / ( soa / n ) << "x the MeasuredArray product per element" << std::endl ;
+    std::cout << "  sigma of element 0: first order " << torqueArray[0].sigma() << ", Monte-Carlo "
+              << spread[0] << " N m" << std::endl ;
+    return 0 ;
+}
@@ -0,0 +1,78 @@
+/**
+ * \file Scaling of the parallel algorithms with the number of threads,
+ * compared with a plain loop on one thread.
+ */
+#include <thread>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Parallel.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : std::size_t( 1 ) << 24 ;
+    const unsigned cores = std::max( 1u, std::thread::hardware_concurrency() ) ;
+    std::cout << n << " elements, " << cores << " hardware threads" << std::endl ;
+
+    std::vector<Speed> speeds( n ) ;
+    std::vector<Time> deltas( n ) ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        speeds[i] = Speed( 1.0 + i % 7 ) ;
+        deltas[i] = Time( 1e-3 * ( 1 + i % 3 ) ) ;
+    }
+    std::vector<Length> lengths( n ) ;
+    std::vector<Time> stamps( n ) ;
+    const Time dt = 0.1_s ;
+
+    double seconds = bench::measure( [&]() {
+        for( std::size_t i = 0; i < n; ++i ) {
+            lengths[i] = speeds[i] * dt ;
+        }
+        bench::doNotOptimize( lengths ) ;
+    } ) ;
+    bench::report( "transform, plain loop", seconds, double( n ) ) ;
+    seconds = bench::measure( [&]() {
+        Length sum ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            sum = sum + lengths[i] ;
+        }
+        bench::doNotOptimize( sum ) ;
+    } ) ;
+    bench::report( "reduce, plain loop", seconds, double( n ) ) ;
+    seconds = bench::measure( [&]() {
+        Time t ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            t = t + deltas[i] ;
+            stamps[i] = t ;
+        }
+        bench::doNotOptimize( stamps ) ;
+    } ) ;
+    bench::report( "inclusive_scan, plain loop", seconds, double( n ) ) ;
+
+    for( unsigned threads = 1; ; threads = std::min( 2 * threads, cores ) ) {
+        parallel::ThreadPool pool( threads ) ;
+        const std::string suffix = ", " + std::to_string( threads ) + " threads" ;
+        seconds = bench::measure( [&]() {
+            parallel::transform( speeds.data(), speeds.data() + n, lengths.data(),
+                                 [dt]( const Speed& v ) { return v * dt; }, parallel::DEFAULT_GRAIN, pool ) ;
+            bench::doNotOptimize( lengths ) ;
+        } ) ;
+        bench::report( "transform" + suffix, seconds, double( n ) ) ;
+        seconds = bench::measure( [&]() {
+            bench::doNotOptimize( parallel::reduce( lengths.data(), lengths.data() + n, parallel::DEFAULT_GRAIN, pool ) ) ;
+        } ) ;
+        bench::report( "reduce" + suffix, seconds, double( n ) ) ;
+        seconds = bench::measure( [&]() {
+            parallel::inclusive_scan( deltas.data(), deltas.data() + n, stamps.data(), parallel::DEFAULT_GRAIN, pool ) ;
+            bench::doNotOptimize( stamps ) ;
+        } ) ;
+        bench::report( "inclusive_scan" + suffix, seconds, double( n ) ) ;
+        if( threads == cores ) {
+            break;
+        }
+    }
+    return 0 ;
+}
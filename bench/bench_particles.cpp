@@ -0,0 +1,51 @@
+/**
+ * \file Gravitational force kernels of ParticleSystem: direct O(N^2) sum on
+ * one and on all hardware threads, and the Barnes-Hut octree.
+ */
+#include <random>
+#include <thread>
+
+#include "ScientificQuantities.hpp"
+#include "ParticleSystem.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : 4096 ;
+
+    // Uniform ball of equal masses
+    std::mt19937 rng( 42 ) ;
+    std::uniform_real_distribution<double> u( -1.0, 1.0 ) ;
+    ParticleSystem system( 1e-3_m ) ;
+    system.reserve( n ) ;
+    while( system.size() < n ) {
+        const double px = u( rng ), py = u( rng ), pz = u( rng ) ;
+        if( px * px + py * py + pz * pz <= 1 ) {
+            system.add( Vec3<Length>( Length( px ), Length( py ), Length( pz ) ), Vec3<Speed>(), 1_kg ) ;
+        }
+    }
+
+    const unsigned cores = std::max( 1u, std::thread::hardware_concurrency() ) ;
+    std::cout << "Gravity, " << n << " particles, " << cores << " hardware threads" << std::endl ;
+
+    parallel::ThreadPool single( 1 ) ;
+    system.setPool( single ) ;
+    double seconds = bench::measure( [&]() { system.computeAccelerations(); }, 3 ) ;
+    bench::report( "direct, 1 thread (interactions)", seconds, double( n ) * n ) ;
+    const Vec3<Acceleration> exact = system.acceleration( 0 ) ;
+
+    system.setPool( parallel::ThreadPool::global() ) ;
+    seconds = bench::measure( [&]() { system.computeAccelerations(); }, 3 ) ;
+    bench::report( "direct, all threads (interactions)", seconds, double( n ) * n ) ;
+
+    for( double theta : { 0.3, 0.5, 0.8 } ) {
+        system.setMethod( GravityMethod::BarnesHut, theta ) ;
+        seconds = bench::measure( [&]() { system.computeAccelerations(); }, 3 ) ;
+        const Vec3<Acceleration> approx = system.acceleration( 0 ) ;
+        bench::report( "Barnes-Hut, theta " + std::to_string( theta ).substr( 0, 3 ) + " (particles)", seconds, double( n ) ) ;
+        std::cout << "    relative error of particle 0: " << norm( approx - exact ).getValue() / norm( exact ).getValue() << std::endl ;
+    }
+    return 0 ;
+}
@@ -0,0 +1,85 @@
+/**
+ * \file Memory, quantize/dequantize throughput and reductions of
+ * QuantizedArray against a std::vector<Voltage> of the same samples.
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "QuantizedArray.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+template<typename IntT>
+void run( const std::string& name, const std::vector<Voltage>& samples )
+{
+    const std::size_t n = samples.size() ;
+    QuantizedArray<Voltage, IntT> trace = QuantizedArray<Voltage, IntT>::fit( samples ) ;
+    const double quantizing = bench::measure( [&]() {
+        trace.assign( samples ) ;
+        bench::doNotOptimize( trace ) ;
+    } ) ;
+
+    std::vector<Voltage> restored( n ) ;
+    const double dequantizing = bench::measure( [&]() {
+        trace.dequantize( restored.data() ) ;
+        bench::doNotOptimize( restored ) ;
+    } ) ;
+
+    // Reference: the same conversions one sample at a time
+    std::vector<IntT> codes( n ) ;
+    const double scale = trace.scale().getValue(), offset = trace.offset().getValue() ;
+    const double scalarQuantizing = bench::measure( [&]() {
+        for( std::size_t i = 0; i < n; ++i ) {
+            codes[i] = detail::quantizeOne<IntT>( samples[i].getValue(), offset, 1.0 / scale ) ;
+        }
+        bench::doNotOptimize( codes ) ;
+    } ) ;
+
+    Voltage mean ;
+    const double reducing = bench::measure( [&]() {
+        mean = trace.mean() ;
+        bench::doNotOptimize( mean ) ;
+    } ) ;
+
+    double worst = 0 ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        worst = std::max( worst, std::fabs( restored[i].getValue() - samples[i].getValue() ) ) ;
+    }
+    std::cout << name << ": " << double( n * sizeof(Voltage) ) / double( trace.bytes() ) << "x smaller, resolution "
+              << trace.scale() << ", worst error " << Voltage( worst ) << ", mean " << mean << std::endl ;
+    bench::report( "  quantize", quantizing, double( n ) ) ;
+    bench::report( "  quantize, one at a time", scalarQuantizing, double( n ) ) ;
+    bench::report( "  dequantize", dequantizing, double( n ) ) ;
+    bench::report( "  mean of the codes", reducing, double( n ) ) ;
+}
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : 10000000 ;
+    std::mt19937_64 rng( 3 ) ;
+    std::normal_distribution<double> noise( 0.0, 0.05 ) ;
+    std::vector<Voltage> samples( n ) ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        samples[i] = Voltage( 12.0 + 0.5 * std::sin( double( i ) * 1e-3 ) + noise( rng ) ) ;
+    }
+    std::cout << n << " samples" << std::endl ;
+
+    double total = 0 ;
+    const double summing = bench::measure( [&]() {
+        total = 0 ;
+        for( const Voltage& v : samples ) {
+            total += v.getValue() ;
+        }
+        bench::doNotOptimize( total ) ;
+    } ) ;
+    std::cout << "std::vector<Voltage>: mean " << Voltage( total / double( n ) ) << std::endl ;
+    bench::report( "  mean of the doubles", summing, double( n ) ) ;
+
+    run<std::int8_t>( "int8_t codes", samples ) ;
+    run<std::int16_t>( "int16_t codes", samples ) ;
+    run<std::int32_t>( "int32_t codes", samples ) ;
+    return 0;
+}
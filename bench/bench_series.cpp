@@ -0,0 +1,80 @@
+/**
+ * \file Compression ratio and encode/decode throughput of SeriesEncoder and
+ * SeriesDecoder on a logged sensor series, with and without time stamps,
+ * and on full precision noise as the worst case.
+ */
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "SeriesCodec.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+template<typename Q>
+void run( const std::string& name, const std::vector<TimePoint>& times, const std::vector<Q>& values, bool stamped )
+{
+    const std::size_t n = values.size() ;
+    std::vector<unsigned char> block ;
+    const double encoding = bench::measure( [&]() {
+        block = stamped ? encodeSeries( times, values ) : encodeSeries( values ) ;
+        bench::doNotOptimize( block ) ;
+    } ) ;
+    const double raw = double( n * ( stamped ? 16 : 8 ) ) ;
+
+    std::vector<Q> decoded( n ) ;
+    std::vector<TimePoint> decodedTimes( stamped ? n : 0 ) ;
+    const double decoding = bench::measure( [&]() {
+        SeriesDecoder<Q> decoder( block ) ;
+        decoder.read( decoded.data(), n, stamped ? decodedTimes.data() : nullptr ) ;
+        bench::doNotOptimize( decoded ) ;
+    } ) ;
+
+    bool exact = decoded.size() == n ;
+    for( std::size_t i = 0; i < n && exact; ++i ) {
+        exact = detail::bitsOf( decoded[i].getValue() ) == detail::bitsOf( values[i].getValue() ) &&
+                ( !stamped || decodedTimes[i].nanoseconds() == times[i].nanoseconds() ) ;
+    }
+
+    std::cout << name << ": " << double( block.size() ) / double( n ) << " bytes per sample, ratio "
+              << raw / double( block.size() ) << ( exact ? ", lossless" : ", MISMATCH" ) << std::endl ;
+    bench::report( "  encode", encoding, double( n ) ) ;
+    bench::report( "  decode", decoding, double( n ) ) ;
+    std::cout << "    decode " << raw / decoding / 1e9 << " GB/s of samples" << std::endl ;
+}
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : 10000000 ;
+    std::mt19937_64 rng( 5 ) ;
+
+    // A sensor with 1/64 K resolution logged once a second; the reading
+    // drifts now and then and the logger clock jitters by a few microseconds
+    std::uniform_int_distribution<int> step( -1, 1 ) ;
+    std::bernoulli_distribution drift( 0.1 ) ;
+    std::uniform_int_distribution<std::int64_t> jitter( -2000, 2000 ) ;
+    std::vector<Temperature> readings( n ) ;
+    std::vector<TimePoint> times( n ) ;
+    long code = 293 * 64 ;
+    for( std::size_t i = 0; i < n; ++i ) {
+        if( drift( rng ) ) {
+            code += step( rng ) ;
+        }
+        readings[i] = Temperature( double( code ) / 64.0 ) ;
+        times[i] = TimePoint::fromNanoseconds( 1700000000000000000ll + std::int64_t( i ) * 1000000000ll + jitter( rng ) ) ;
+    }
+    std::cout << n << " samples" << std::endl ;
+    run( "sensor values", times, readings, false ) ;
+    run( "sensor values with time stamps", times, readings, true ) ;
+
+    // Full precision noise does not compress
+    std::normal_distribution<double> noise( 0.0, 1.0 ) ;
+    std::vector<Voltage> hiss( n ) ;
+    for( auto& v : hiss ) {
+        v = Voltage( noise( rng ) ) ;
+    }
+    run( "full precision noise", times, hiss, false ) ;
+    return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * \file Insert throughput, memory and accuracy of QuantileSketch on many
+ * streams of latencies, merged into one sketch.
+ */
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "QuantileSketch.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t streams = argc > 1 ? std::stoul( argv[1] ) : 1000 ;
+    const std::size_t samples = argc > 2 ? std::stoul( argv[2] ) : 10000 ;
+    const std::size_t n = streams * samples ;
+    std::mt19937_64 rng( 11 ) ;
+    std::lognormal_distribution<double> lognormal( -7.0, 0.8 ) ;
+    std::vector<Time> latencies( n ) ;
+    for( auto& t : latencies ) {
+        t = Time( lognormal( rng ) ) ;
+    }
+    std::cout << streams << " streams of " << samples << " latencies" << std::endl ;
+
+    std::vector<QuantileSketch<Time>> sketches ;
+    const double seconds = bench::measure( [&]() {
+        sketches.assign( streams, QuantileSketch<Time>() ) ;
+        for( std::size_t s = 0; s < streams; ++s ) {
+            sketches[s].add( latencies.data() + s * samples, samples ) ;
+        }
+        bench::doNotOptimize( sketches ) ;
+    } ) ;
+    bench::report( "QuantileSketch::add", seconds, double( n ) ) ;
+    std::cout << "    " << seconds / double( n ) * 1e9 << " ns per sample" << std::endl ;
+
+    std::size_t memory = 0, serialized = 0 ;
+    for( const auto& s : sketches ) {
+        memory += s.bytes() ;
+        serialized += s.serialize().size() ;
+    }
+    std::cout << "    " << memory / streams << " bytes per sketch in memory, "
+              << serialized / streams << " bytes serialized, " << sketches[0].size() << " centroids" << std::endl ;
+
+    QuantileSketch<Time> merged ;
+    const double merging = bench::measure( [&]() {
+        merged = QuantileSketch<Time>() ;
+        for( const auto& s : sketches ) {
+            merged += QuantileSketch<Time>::deserialize( s.serialize() ) ;
+        }
+    }, 1 ) ;
+    bench::report( "serialize, deserialize and merge", merging, double( streams ) ) ;
+
+    std::sort( latencies.begin(), latencies.end() ) ;
+    for( double q : { 0.5, 0.99, 0.999 } ) {
+        const Time exact = latencies[std::size_t( q * double( n ) )] ;
+        const Time estimate = merged.quantile( q ) ;
+        const double rank = double( std::lower_bound( latencies.begin(), latencies.end(), estimate ) - latencies.begin() ) / double( n ) ;
+        std::cout << "    p" << q * 100 << ": " << estimate << ", exact " << exact
+                  << ", rank error " << rank - q << std::endl ;
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * \file Radix sort of Time stamps against std::sort, and lower_bound and
+ * EytzingerIndex against std::lower_bound.
+ */
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Sort.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : std::size_t( 1 ) << 22 ;
+    const std::size_t queries = std::size_t( 1 ) << 20 ;
+    std::mt19937_64 rng( 5 ) ;
+    std::uniform_real_distribution<double> u( 0.0, 86400.0 ) ;
+
+    std::vector<Time> stamps( n ) ;
+    for( auto& t : stamps ) {
+        t = Time( 1.7e9 + u( rng ) ) ;
+    }
+    std::cout << "Sort " << n << " time stamps, " << parallel::ThreadPool::global().size() << " threads" << std::endl ;
+
+    std::vector<Time> expected( stamps ) ;
+    std::vector<Time> work ;
+    const double stdSort = bench::measure( [&]() {
+        work = stamps ;
+        std::sort( work.begin(), work.end() ) ;
+    } ) ;
+    expected = work ;
+    bench::report( "std::sort", stdSort, double( n ) ) ;
+
+    parallel::ThreadPool single( 1 ) ;
+    double seconds = bench::measure( [&]() {
+        work = stamps ;
+        SciQ::sort( work, single ) ;
+    } ) ;
+    bench::report( "SciQ::sort, 1 thread", seconds, double( n ) ) ;
+    std::cout << "    " << stdSort / seconds << "x std::sort, "
+              << ( work == expected ? "same order" : "DIFFERENT ORDER" ) << std::endl ;
+
+    seconds = bench::measure( [&]() {
+        work = stamps ;
+        SciQ::sort( work ) ;
+    } ) ;
+    bench::report( "SciQ::sort, thread pool", seconds, double( n ) ) ;
+    std::cout << "    " << stdSort / seconds << "x std::sort, "
+              << ( work == expected ? "same order" : "DIFFERENT ORDER" ) << std::endl ;
+
+    std::vector<Time> keys( queries ) ;
+    for( auto& t : keys ) {
+        t = Time( 1.7e9 + u( rng ) ) ;
+    }
+    const Time * data = expected.data() ;
+    std::vector<std::size_t> found( queries ), reference( queries ) ;
+    std::cout << "Search " << queries << " keys" << std::endl ;
+
+    const double stdSearch = bench::measure( [&]() {
+        for( std::size_t i = 0; i < queries; ++i ) {
+            reference[i] = std::size_t( std::lower_bound( data, data + n, keys[i] ) - data ) ;
+        }
+        bench::doNotOptimize( reference ) ;
+    } ) ;
+    bench::report( "std::lower_bound", stdSearch, double( queries ) ) ;
+
+    seconds = bench::measure( [&]() {
+        for( std::size_t i = 0; i < queries; ++i ) {
+            found[i] = SciQ::lower_bound( expected, keys[i] ) ;
+        }
+        bench::doNotOptimize( found ) ;
+    } ) ;
+    bench::report( "SciQ::lower_bound", seconds, double( queries ) ) ;
+    std::cout << "    " << stdSearch / seconds << "x std::lower_bound, "
+              << ( found == reference ? "same positions" : "DIFFERENT POSITIONS" ) << std::endl ;
+
+    EytzingerIndex<Time> index( expected ) ;
+    seconds = bench::measure( [&]() {
+        for( std::size_t i = 0; i < queries; ++i ) {
+            found[i] = index.lower_bound( keys[i] ) ;
+        }
+        bench::doNotOptimize( found ) ;
+    } ) ;
+    bench::report( "EytzingerIndex::lower_bound", seconds, double( queries ) ) ;
+    std::cout << "    " << stdSearch / seconds << "x std::lower_bound, "
+              << ( found == reference ? "same positions" : "DIFFERENT POSITIONS" ) << std::endl ;
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * \file Overhead of one measurement with Stopwatch, ScopedTimer and
+ * std::chrono::steady_clock, timing an empty section.
+ */
+#include <chrono>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Stopwatch.hpp"
+#include "bench.hpp"
+
+using namespace SciQ ;
+
+int main( int argc, char ** argv )
+{
+    const std::size_t n = argc > 1 ? std::stoul( argv[1] ) : std::size_t( 1 ) << 22 ;
+    std::cout << "Empty section timed " << n << " times, ticks from "
+              << ( TickClock::usesTsc() ? "the TSC at " : "steady_clock at " )
+              << TickClock::frequency().getValue() * 1e-9 << " GHz" << std::endl ;
+
+    double seconds = bench::measure( [&]() {
+        std::chrono::steady_clock::duration sum( 0 ) ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            const auto start = std::chrono::steady_clock::now() ;
+            sum += std::chrono::steady_clock::now() - start ;
+        }
+        bench::doNotOptimize( sum ) ;
+    } ) ;
+    bench::report( "steady_clock pair", seconds, double( n ) ) ;
+    std::cout << "    " << seconds / double( n ) * 1e9 << " ns per measurement" << std::endl ;
+
+    seconds = bench::measure( [&]() {
+        Stopwatch watch ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            watch.start() ;
+            watch.stop() ;
+        }
+        bench::doNotOptimize( watch ) ;
+    } ) ;
+    bench::report( "Stopwatch start/stop", seconds, double( n ) ) ;
+    std::cout << "    " << seconds / double( n ) * 1e9 << " ns per measurement" << std::endl ;
+
+    TimerSite site( "empty section" ) ;
+    seconds = bench::measure( [&]() {
+        for( std::size_t i = 0; i < n; ++i ) {
+            ScopedTimer timer( site ) ;
+        }
+    } ) ;
+    bench::report( "ScopedTimer into a TimerSite", seconds, double( n ) ) ;
+    std::cout << "    " << seconds / double( n ) * 1e9 << " ns per measurement" << std::endl ;
+
+    Time sum = 0_s ;
+    seconds = bench::measure( [&]() {
+        for( std::size_t i = 0; i < n; ++i ) {
+            ScopedTimer timer( sum ) ;
+        }
+        bench::doNotOptimize( sum ) ;
+    } ) ;
+    bench::report( "ScopedTimer into a Time", seconds, double( n ) ) ;
+    std::cout << "    " << seconds / double( n ) * 1e9 << " ns per measurement\n" << std::endl ;
+
+    TimerSite::report( std::cout ) ;
+    return 0;
+}
@@ -0,0 +1,439 @@
+/*
+ * BinaryIO.hpp
+ *
+ *      Compact binary storage of Quantity<> arrays. An array is written as a
+ *      fixed size, self-describing header (element type, dimension, scale and
+ *      number of elements) followed by the raw little-endian payload. Arrays
+ *      stored as double in the fundamental SI unit can be used in place, e.g.
+ *      from a memory-mapped file, without any parsing.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef BINARYIO_HPP_
+#define BINARYIO_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "DynamicQuantity.hpp"
+
+namespace SciQ {
+
+    /**
+     * Size of the header in bytes. The payload starts right after the header
+     * and is therefore aligned for any of the element types.
+     */
+    constexpr std::size_t BINARY_HEADER_SIZE = 64 ;
+
+    /**
+     * Magic bytes at the start of every binary array.
+     */
+    constexpr char BINARY_MAGIC[4] = { 'S', 'c', 'i', 'Q' } ;
+
+    /**
+     * Version of the binary format.
+     */
+    constexpr std::uint16_t BINARY_VERSION = 1 ;
+
+    /**
+     * Representation of the elements of a binary array.
+     */
+    enum class ElementType : std::uint8_t {
+        Float64 = 1,
+        Float32 = 2,
+        Int8 = 3,
+        Int16 = 4,
+        Int32 = 5,
+        Int64 = 6
+    } ;
+
+    /**
+     * Maps a C++ type to its ElementType.
+     */
+    template<typename T>
+    struct ElementTypeOf
+    {} ;
+
+    template<> struct ElementTypeOf<double>       { static constexpr ElementType value = ElementType::Float64 ; } ;
+    template<> struct ElementTypeOf<float>        { static constexpr ElementType value = ElementType::Float32 ; } ;
+    template<> struct ElementTypeOf<std::int8_t>  { static constexpr ElementType value = ElementType::Int8 ; } ;
+    template<> struct ElementTypeOf<std::int16_t> { static constexpr ElementType value = ElementType::Int16 ; } ;
+    template<> struct ElementTypeOf<std::int32_t> { static constexpr ElementType value = ElementType::Int32 ; } ;
+    template<> struct ElementTypeOf<std::int64_t> { static constexpr ElementType value = ElementType::Int64 ; } ;
+
+    /**
+     * Size in bytes of one element of the specified type, or 0 if the type
+     * is unknown.
+     */
+    constexpr std::size_t elementSize( ElementType type ) {
+        return type == ElementType::Float64 ? 8 :
+               type == ElementType::Float32 ? 4 :
+               type == ElementType::Int8    ? 1 :
+               type == ElementType::Int16   ? 2 :
+               type == ElementType::Int32   ? 4 :
+               type == ElementType::Int64   ? 8 : 0 ;
+    }
+
+    namespace detail {
+        /**
+         * True if the host stores numbers in little-endian byte order, which
+         * allows the payload to be used without conversion.
+         */
+        inline bool hostIsLittleEndian() {
+            const std::uint16_t probe = 1 ;
+            unsigned char first ;
+            std::memcpy( &first, &probe, 1 ) ;
+            return first == 1;
+        }
+
+        template<typename T>
+        void storeLE( unsigned char * out, T v ) {
+            static_assert( std::is_trivially_copyable<T>::value, "Only plain values can be stored" );
+            unsigned char bytes[sizeof(T)] ;
+            std::memcpy( bytes, &v, sizeof(T) ) ;
+            for( std::size_t i = 0; i < sizeof(T); ++i ) {
+                out[i] = hostIsLittleEndian() ? bytes[i] : bytes[sizeof(T) - 1 - i] ;
+            }
+        }
+
+        template<typename T>
+        T loadLE( const unsigned char * in ) {
+            static_assert( std::is_trivially_copyable<T>::value, "Only plain values can be loaded" );
+            unsigned char bytes[sizeof(T)] ;
+            for( std::size_t i = 0; i < sizeof(T); ++i ) {
+                bytes[i] = hostIsLittleEndian() ? in[i] : in[sizeof(T) - 1 - i] ;
+            }
+            T v ;
+            std::memcpy( &v, bytes, sizeof(T) ) ;
+            return v;
+        }
+
+        template<typename Stored>
+        Stored toStored( double v, std::false_type ) {
+            return static_cast<Stored>( v );
+        }
+
+        /**
+         * Round to the nearest integer, saturating at the limits of Stored.
+         * The caller rules out NaN.
+         */
+        template<typename Stored>
+        Stored toStored( double v, std::true_type ) {
+            using Limits = std::numeric_limits<Stored> ;
+            if( v <= static_cast<double>( Limits::min() ) ) {
+                return Limits::min();
+            }
+            // The limit rounds up to 2^63 for 64-bit integers, which is
+            // out of range as well
+            if( v >= static_cast<double>( Limits::max() ) ) {
+                return Limits::max();
+            }
+            return static_cast<Stored>( std::llround( v ) );
+        }
+
+        template<typename Stored>
+        Stored toStored( double v ) {
+            return toStored<Stored>( v, std::is_integral<Stored>() );
+        }
+    }
+
+    /**
+     * Header of a binary quantity array.
+     *
+     * Layout (all fields little-endian):
+     *
+     * | Offset | Size | Field                                             |
+     * |--------|------|---------------------------------------------------|
+     * | 0      | 4    | magic "SciQ"                                      |
+     * | 4      | 2    | format version                                    |
+     * | 6      | 1    | element type (ElementType)                        |
+     * | 7      | 1    | reserved (0)                                      |
+     * | 8      | 8    | packed Dimension                                  |
+     * | 16     | 8    | scale: SI value = stored value * scale + offset   |
+     * | 24     | 8    | offset                                            |
+     * | 32     | 8    | number of elements                                |
+     * | 40     | 24   | reserved (0)                                      |
+     */
+    struct BinaryHeader {
+        ElementType type = ElementType::Float64 ;
+        Dimension dimension ;
+        double scale = 1.0 ;
+        double offset = 0.0 ;
+        std::uint64_t count = 0 ;
+
+        /**
+         * True if the payload can be used in place as an array of Quantity<>
+         * values, i.e. it holds doubles in the fundamental SI unit and the
+         * host is little-endian.
+         */
+        bool isZeroCopy() const {
+            return type == ElementType::Float64 && scale == 1.0 && offset == 0.0 &&
+                   detail::hostIsLittleEndian();
+        }
+
+        /**
+         * Size of the payload in bytes. Only meaningful once fitsIn() has
+         * ruled out an overflow for a count read from a file.
+         */
+        std::uint64_t payloadSize() const {
+            return count * elementSize( type );
+        }
+
+        /**
+         * True if a payload of \c count elements fits into \c bytes bytes.
+         * Unlike comparing with payloadSize() this cannot overflow for a
+         * corrupt count.
+         */
+        bool fitsIn( std::uint64_t bytes ) const {
+            return count <= bytes / elementSize( type );
+        }
+
+        /**
+         * Write the header into the buffer \c out of BINARY_HEADER_SIZE bytes.
+         */
+        void encode( unsigned char * out ) const {
+            std::memset( out, 0, BINARY_HEADER_SIZE ) ;
+            std::memcpy( out, BINARY_MAGIC, sizeof(BINARY_MAGIC) ) ;
+            detail::storeLE( out + 4, BINARY_VERSION ) ;
+            out[6] = static_cast<unsigned char>( type ) ;
+            detail::storeLE( out + 8, dimension.getPacked() ) ;
+            detail::storeLE( out + 16, scale ) ;
+            detail::storeLE( out + 24, offset ) ;
+            detail::storeLE( out + 32, count ) ;
+        }
+
+        /**
+         * Read the header from the buffer \c in of \c size bytes.
+         * @return False if the buffer does not contain a valid header
+         */
+        bool decode( const unsigned char * in, std::size_t size ) {
+            if( size < BINARY_HEADER_SIZE || std::memcmp( in, BINARY_MAGIC, sizeof(BINARY_MAGIC) ) != 0 ) {
+                return false;
+            }
+            if( detail::loadLE<std::uint16_t>( in + 4 ) != BINARY_VERSION ) {
+                return false;
+            }
+            type = static_cast<ElementType>( in[6] ) ;
+            if( elementSize( type ) == 0 ) {
+                return false;
+            }
+            dimension = Dimension( detail::loadLE<std::uint64_t>( in + 8 ) ) ;
+            scale = detail::loadLE<double>( in + 16 ) ;
+            offset = detail::loadLE<double>( in + 24 ) ;
+            count = detail::loadLE<std::uint64_t>( in + 32 ) ;
+            return true;
+        }
+    } ;
+
+    /**
+     * Write \c n quantities as a binary array. The values are stored as
+     * elements of type \c Stored in units of \c unit, i.e. the stored value is
+     * data[i].in(unit). Integer element types are rounded to the nearest
+     * integer and saturate at the limits of the type; NaN cannot be stored
+     * as an integer and throws std::domain_error before anything is
+     * written. With the defaults (double in the fundamental unit) the
+     * payload is written straight from memory.
+     *
+     * \code
+     * std::vector<Pressure> p = ... ;
+     * std::ofstream file( "p.sciq", std::ios::binary ) ;
+     * write_binary( file, p.data(), p.size() ) ;
+     * \endcode
+     */
+    template<typename Stored=double, class L, class M, class T, class EC, class TT, class AS, class LI>
+    void write_binary( std::ostream& os, const Quantity<L, M, T, EC, TT, AS, LI> * data, std::size_t n,
+                       const Quantity<L, M, T, EC, TT, AS, LI>& unit = Quantity<L, M, T, EC, TT, AS, LI>( 1.0 ) ) {
+        using QuantityType = Quantity<L, M, T, EC, TT, AS, LI> ;
+        BinaryHeader header ;
+        header.type = ElementTypeOf<Stored>::value ;
+        header.dimension = dimensionOf<QuantityType>() ;
+        header.scale = unit.getValue() ;
+        header.count = n ;
+
+        // Reject NaN before anything is written
+        if( std::is_integral<Stored>::value ) {
+            for( std::size_t i = 0; i < n; ++i ) {
+                if( std::isnan( data[i].getValue() ) ) {
+                    throw std::domain_error( "write_binary: NaN cannot be stored as an integer" );
+                }
+            }
+        }
+
+        unsigned char head[BINARY_HEADER_SIZE] ;
+        header.encode( head ) ;
+        os.write( reinterpret_cast<const char*>( head ), BINARY_HEADER_SIZE ) ;
+
+        if( header.isZeroCopy() ) {
+            static_assert( sizeof(QuantityType) == sizeof(double), "Quantity must be layout compatible with double" );
+            os.write( reinterpret_cast<const char*>( data ), n * sizeof(double) ) ;
+            return;
+        }
+
+        // Convert in chunks to keep the memory footprint small
+        constexpr std::size_t CHUNK = 4096 ;
+        unsigned char buffer[CHUNK * sizeof(Stored)] ;
+        for( std::size_t first = 0; first < n; first += CHUNK ) {
+            const std::size_t count = std::min( CHUNK, n - first ) ;
+            for( std::size_t i = 0; i < count; ++i ) {
+                detail::storeLE( buffer + i * sizeof(Stored), detail::toStored<Stored>( data[first + i].in( unit ) ) ) ;
+            }
+            os.write( reinterpret_cast<const char*>( buffer ), count * sizeof(Stored) ) ;
+        }
+    }
+
+    template<typename Stored=double, class L, class M, class T, class EC, class TT, class AS, class LI>
+    void write_binary( std::ostream& os, const std::vector<Quantity<L, M, T, EC, TT, AS, LI>>& data ) {
+        write_binary<Stored>( os, data.data(), data.size() ) ;
+    }
+
+    namespace detail {
+        template<typename Stored>
+        double loadElement( const unsigned char * in ) {
+            return static_cast<double>( loadLE<Stored>( in ) );
+        }
+
+        inline double loadElement( ElementType type, const unsigned char * in ) {
+            switch( type ) {
+                case ElementType::Float64: return loadElement<double>( in );
+                case ElementType::Float32: return loadElement<float>( in );
+                case ElementType::Int8:    return loadElement<std::int8_t>( in );
+                case ElementType::Int16:   return loadElement<std::int16_t>( in );
+                case ElementType::Int32:   return loadElement<std::int32_t>( in );
+                case ElementType::Int64:   return loadElement<std::int64_t>( in );
+            }
+            return 0;
+        }
+
+        template<typename Q>
+        void requireDimension( const BinaryHeader& header ) {
+            if( header.dimension != dimensionOf<Q>() ) {
+                throw std::invalid_argument( "Binary array: dimension does not match the requested quantity" );
+            }
+        }
+    }
+
+    /**
+     * Read a binary array written by write_binary() into quantities of type
+     * Q. Any element type and scale is accepted and converted into the
+     * fundamental SI unit. Throws std::runtime_error if the stream does not
+     * contain a valid array and std::invalid_argument if the stored
+     * dimension is not the one of Q.
+     */
+    template<typename Q>
+    std::vector<Q> read_binary( std::istream& is ) {
+        unsigned char head[BINARY_HEADER_SIZE] ;
+        BinaryHeader header ;
+        if( !is.read( reinterpret_cast<char*>( head ), BINARY_HEADER_SIZE ) ||
+            !header.decode( head, BINARY_HEADER_SIZE ) ) {
+            throw std::runtime_error( "Binary array: invalid header" );
+        }
+        detail::requireDimension<Q>( header ) ;
+
+        // The count is not trusted: the result grows with the data that
+        // is actually read, so a corrupt header fails as a truncated
+        // payload instead of allocating memory for elements that are not there
+        std::vector<Q> result ;
+        const std::size_t size = elementSize( header.type ) ;
+        constexpr std::size_t CHUNK = 4096 ;
+        unsigned char buffer[CHUNK * 8] ;
+        for( std::uint64_t first = 0; first < header.count && is; first += CHUNK ) {
+            const std::size_t count = static_cast<std::size_t>( std::min<std::uint64_t>( CHUNK, header.count - first ) ) ;
+            if( header.isZeroCopy() ) {
+                static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+                result.resize( result.size() + count ) ;
+                is.read( reinterpret_cast<char*>( result.data() + first ), count * sizeof(double) ) ;
+            } else {
+                is.read( reinterpret_cast<char*>( buffer ), count * size ) ;
+                for( std::size_t i = 0; i < count && is; ++i ) {
+                    result.push_back( Q( detail::loadElement( header.type, buffer + i * size ) * header.scale + header.offset ) ) ;
+                }
+            }
+        }
+        if( !is ) {
+            throw std::runtime_error( "Binary array: truncated payload" );
+        }
+        return result;
+    }
+
+    /**
+     * Read-only view of a binary array that is already in memory, e.g. a
+     * memory-mapped file. No data is copied or parsed: the view points
+     * straight into the buffer. The header is validated on construction and
+     * the stored dimension is checked against Q.
+     *
+     * Only arrays that are stored as double in the fundamental SI unit (the
+     * default of write_binary()) can be viewed; use read_binary() for the
+     * others.
+     */
+    template<typename Q>
+    class BinaryArrayView {
+    public:
+        using value_type = Q ;
+        using const_iterator = const Q* ;
+
+        /**
+         * Creates a view of the binary array in \c buffer of \c size bytes.
+         * The buffer must be 8-byte aligned and outlive the view.
+         */
+        BinaryArrayView( const void * buffer, std::size_t size ) {
+            static_assert( sizeof(Q) == sizeof(double) && std::is_trivially_copyable<Q>::value,
+                           "Quantity must be layout compatible with double" );
+            const unsigned char * bytes = static_cast<const unsigned char*>( buffer ) ;
+            if( !header.decode( bytes, size ) ) {
+                throw std::runtime_error( "Binary array: invalid header" );
+            }
+            detail::requireDimension<Q>( header ) ;
+            if( !header.isZeroCopy() ) {
+                throw std::runtime_error( "Binary array: payload cannot be viewed in place" );
+            }
+            if( reinterpret_cast<std::uintptr_t>( bytes ) % alignof(double) != 0 ) {
+                throw std::runtime_error( "Binary array: buffer is not aligned" );
+            }
+            if( !header.fitsIn( size - BINARY_HEADER_SIZE ) ) {
+                throw std::runtime_error( "Binary array: truncated payload" );
+            }
+            values = reinterpret_cast<const Q*>( bytes + BINARY_HEADER_SIZE ) ;
+        }
+
+        const BinaryHeader& getHeader() const {
+            return header;
+        }
+
+        std::size_t size() const {
+            return header.count;
+        }
+
+        const Q * data() const {
+            return values;
+        }
+
+        const Q& operator[]( std::size_t i ) const {
+            return values[i];
+        }
+
+        const_iterator begin() const {
+            return values;
+        }
+
+        const_iterator end() const {
+            return values + header.count;
+        }
+
+    private:
+        BinaryHeader header ;
+        const Q * values = nullptr ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* BINARYIO_HPP_ */
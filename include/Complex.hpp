@@ -0,0 +1,455 @@
+/*
+ * Complex.hpp
+ *
+ *      Complex-valued quantities for AC circuits and phasors. The product
+ *      and quotient of two complex quantities have the dimension of the
+ *      product and quotient of their parts, so a complex Voltage divided by
+ *      a complex Current is an Impedance, i.e. a complex Resistance.
+ *      ComplexArray<> stores the real and imaginary parts in separate
+ *      arrays so that bulk arithmetic runs as plain vectorizable loops.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef COMPLEX_HPP_
+#define COMPLEX_HPP_
+
+#include <cmath>
+#include <complex>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * A complex value re + j im of the quantity Q.
+     *
+     * The products and quotients use the textbook formulas, like
+     * std::complex with -fcx-limited-range: they skip the recovery of
+     * infinite results from NaN parts and the scaling that avoids overflow
+     * for parts beyond about 1e154 in SI units. In exchange they compile to
+     * a few multiplications and vectorize.
+     *
+     * \code
+     * Impedance z( 10_Ohm, 2 * M_PI * 50_Hz * 0.1_H ) ;
+     * Complex<Current> i = Complex<Voltage>( 230_V ) / z ;
+     * std::cout << abs( i ) << " at " << arg( i ).in( degree ) << " deg" << std::endl ;
+     * \endcode
+     */
+    template<typename Q>
+    class Complex {
+    public:
+        /**
+         * Type of the squared magnitude.
+         */
+        using SquareType = decltype( Q() * Q() ) ;
+
+        constexpr Complex()
+        : re( 0 ), im( 0 ) {
+        }
+
+        constexpr Complex( const Q& real, const Q& imag = Q() )
+        : re( real.getValue() ), im( imag.getValue() ) {
+        }
+
+        /**
+         * A complex quantity from its value in the fundamental SI unit.
+         */
+        constexpr explicit Complex( const std::complex<double>& value )
+        : re( value.real() ), im( value.imag() ) {
+        }
+
+        /**
+         * The complex quantity with the given magnitude and phase.
+         */
+        static Complex polar( const Q& magnitude, const Angle& phase ) {
+            return Complex( std::complex<double>( magnitude.getValue() * std::cos( phase.getValue() ),
+                                                  magnitude.getValue() * std::sin( phase.getValue() ) ) );
+        }
+
+        constexpr Q real() const {
+            return Q( re );
+        }
+
+        constexpr Q imag() const {
+            return Q( im );
+        }
+
+        /**
+         * The value in the fundamental SI unit.
+         */
+        constexpr std::complex<double> getValue() const {
+            return std::complex<double>( re, im );
+        }
+
+        Complex& operator+=( const Complex& rhs ) {
+            re += rhs.re ;
+            im += rhs.im ;
+            return *this;
+        }
+
+        Complex& operator-=( const Complex& rhs ) {
+            re -= rhs.re ;
+            im -= rhs.im ;
+            return *this;
+        }
+
+        Complex& operator*=( double rhs ) {
+            re *= rhs ;
+            im *= rhs ;
+            return *this;
+        }
+
+        Complex& operator/=( double rhs ) {
+            re /= rhs ;
+            im /= rhs ;
+            return *this;
+        }
+
+        /**
+         * Rotate and scale by a dimensionless complex factor, e.g. by j.
+         */
+        Complex& operator*=( const std::complex<double>& rhs ) {
+            const double r = re * rhs.real() - im * rhs.imag() ;
+            im = re * rhs.imag() + im * rhs.real() ;
+            re = r ;
+            return *this;
+        }
+
+    private:
+        double re ;
+        double im ;
+    } ;
+
+    using Impedance = Complex<Resistance> ;
+    using Admittance = Complex<Conductance> ;
+
+    namespace detail {
+        inline void complexMultiply( double a, double b, double c, double d, double& re, double& im ) {
+            re = a * c - b * d ;
+            im = a * d + b * c ;
+        }
+
+        inline void complexDivide( double a, double b, double c, double d, double& re, double& im ) {
+            const double inv = 1.0 / ( c * c + d * d ) ;
+            re = ( a * c + b * d ) * inv ;
+            im = ( b * c - a * d ) * inv ;
+        }
+    }
+
+    //
+    // Arithmetic operators for Complex<> instances
+    //
+    template<typename Q>
+    Complex<Q> operator+( Complex<Q> lhs, const Complex<Q>& rhs ) {
+        return lhs += rhs;
+    }
+
+    template<typename Q>
+    Complex<Q> operator-( Complex<Q> lhs, const Complex<Q>& rhs ) {
+        return lhs -= rhs;
+    }
+
+    template<typename Q>
+    Complex<Q> operator-( const Complex<Q>& rhs ) {
+        return Complex<Q>( -rhs.getValue() );
+    }
+
+    template<typename Q1, typename Q2>
+    Complex<decltype( Q1() * Q2() )> operator*( const Complex<Q1>& lhs, const Complex<Q2>& rhs ) {
+        double re, im ;
+        detail::complexMultiply( lhs.real().getValue(), lhs.imag().getValue(),
+                                 rhs.real().getValue(), rhs.imag().getValue(), re, im ) ;
+        return Complex<decltype( Q1() * Q2() )>( std::complex<double>( re, im ) );
+    }
+
+    template<typename Q1, typename Q2>
+    Complex<decltype( Q1() / Q2() )> operator/( const Complex<Q1>& lhs, const Complex<Q2>& rhs ) {
+        double re, im ;
+        detail::complexDivide( lhs.real().getValue(), lhs.imag().getValue(),
+                               rhs.real().getValue(), rhs.imag().getValue(), re, im ) ;
+        return Complex<decltype( Q1() / Q2() )>( std::complex<double>( re, im ) );
+    }
+
+    template<typename Q>
+    Complex<Q> operator*( Complex<Q> lhs, double rhs ) {
+        return lhs *= rhs;
+    }
+
+    template<typename Q>
+    Complex<Q> operator*( double lhs, Complex<Q> rhs ) {
+        return rhs *= lhs;
+    }
+
+    template<typename Q>
+    Complex<Q> operator/( Complex<Q> lhs, double rhs ) {
+        return lhs /= rhs;
+    }
+
+    template<typename Q>
+    Complex<Q> operator*( Complex<Q> lhs, const std::complex<double>& rhs ) {
+        return lhs *= rhs;
+    }
+
+    template<typename Q>
+    Complex<Q> operator*( const std::complex<double>& lhs, Complex<Q> rhs ) {
+        return rhs *= lhs;
+    }
+
+    /**
+     * Scale a complex quantity by a real quantity.
+     */
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Complex<decltype( Q() * Quantity<L, M, T, EC, TT, AS, LI>() )>
+    operator*( const Complex<Q>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return Complex<decltype( Q() * rhs )>( lhs.getValue() * rhs.getValue() );
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Complex<decltype( Quantity<L, M, T, EC, TT, AS, LI>() * Q() )>
+    operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Complex<Q>& rhs ) {
+        return rhs * lhs;
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Complex<decltype( Q() / Quantity<L, M, T, EC, TT, AS, LI>() )>
+    operator/( const Complex<Q>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return Complex<decltype( Q() / rhs )>( lhs.getValue() / rhs.getValue() );
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Complex<decltype( Quantity<L, M, T, EC, TT, AS, LI>() / Q() )>
+    operator/( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Complex<Q>& rhs ) {
+        return Complex<Quantity<L, M, T, EC, TT, AS, LI>>( lhs ) / rhs;
+    }
+
+    template<typename Q>
+    constexpr bool operator==( const Complex<Q>& lhs, const Complex<Q>& rhs ) {
+        return lhs.getValue() == rhs.getValue();
+    }
+
+    template<typename Q>
+    constexpr bool operator!=( const Complex<Q>& lhs, const Complex<Q>& rhs ) {
+        return !( lhs == rhs );
+    }
+
+    template<typename Q>
+    Complex<Q> conj( const Complex<Q>& x ) {
+        return Complex<Q>( x.real(), Q( -x.imag().getValue() ) );
+    }
+
+    /**
+     * Magnitude, computed without intermediate overflow.
+     */
+    template<typename Q>
+    Q abs( const Complex<Q>& x ) {
+        return Q( std::hypot( x.real().getValue(), x.imag().getValue() ) );
+    }
+
+    /**
+     * Phase angle in (-pi, pi].
+     */
+    template<typename Q>
+    Angle arg( const Complex<Q>& x ) {
+        return Angle( std::atan2( x.imag().getValue(), x.real().getValue() ) );
+    }
+
+    /**
+     * Squared magnitude.
+     */
+    template<typename Q>
+    typename Complex<Q>::SquareType norm( const Complex<Q>& x ) {
+        const double re = x.real().getValue(), im = x.imag().getValue() ;
+        return typename Complex<Q>::SquareType( re * re + im * im );
+    }
+
+    template<typename Q>
+    std::ostream& operator<<( std::ostream& os, const Complex<Q>& x )
+    {
+        os << "(" << x.real() << ", " << x.imag() << ")" ;
+        return os ;
+    }
+
+    /**
+     * Many complex values of the quantity Q, stored as one array of real
+     * and one array of imaginary parts. The element-wise operations below
+     * use the same formulas as those of Complex<> and vectorize, two to
+     * eight elements per instruction depending on the instruction set.
+     */
+    template<typename Q>
+    class ComplexArray {
+    public:
+        ComplexArray() = default ;
+
+        explicit ComplexArray( std::size_t n )
+        : re( n ), im( n ) {
+        }
+
+        std::size_t size() const {
+            return re.size();
+        }
+
+        void reserve( std::size_t n ) {
+            re.reserve( n ) ;
+            im.reserve( n ) ;
+        }
+
+        void push_back( const Complex<Q>& x ) {
+            re.push_back( x.real().getValue() ) ;
+            im.push_back( x.imag().getValue() ) ;
+        }
+
+        Complex<Q> operator[]( std::size_t i ) const {
+            return Complex<Q>( Q( re[i] ), Q( im[i] ) );
+        }
+
+        void set( std::size_t i, const Complex<Q>& x ) {
+            re[i] = x.real().getValue() ;
+            im[i] = x.imag().getValue() ;
+        }
+
+        /**
+         * The real parts in the fundamental SI unit.
+         */
+        double * reals() {
+            return re.data();
+        }
+
+        const double * reals() const {
+            return re.data();
+        }
+
+        /**
+         * The imaginary parts in the fundamental SI unit.
+         */
+        double * imags() {
+            return im.data();
+        }
+
+        const double * imags() const {
+            return im.data();
+        }
+
+    private:
+        std::vector<double> re ;
+        std::vector<double> im ;
+    } ;
+
+    namespace detail {
+        template<typename R, typename Q1, typename Q2, typename Op>
+        void combine( const ComplexArray<Q1>& lhs, const ComplexArray<Q2>& rhs, ComplexArray<R>& result, Op op ) {
+            if( lhs.size() != rhs.size() ) {
+                throw std::invalid_argument( "ComplexArray: arrays differ in size" );
+            }
+            if( result.size() != lhs.size() ) {
+                result = ComplexArray<R>( lhs.size() ) ;
+            }
+            const double * a = lhs.reals(), * b = lhs.imags() ;
+            const double * c = rhs.reals(), * d = rhs.imags() ;
+            double * re = result.reals(), * im = result.imags() ;
+            for( std::size_t i = 0; i < lhs.size(); ++i ) {
+                op( a[i], b[i], c[i], d[i], re[i], im[i] ) ;
+            }
+        }
+    }
+
+    //
+    // Element-wise operations on ComplexArray<> instances. The functions
+    // write to an existing array, which is resized if needed, so repeated
+    // calls do not allocate; the operators return a new array. Both throw
+    // std::invalid_argument if the operands differ in size.
+    //
+    template<typename Q>
+    void add( const ComplexArray<Q>& lhs, const ComplexArray<Q>& rhs, ComplexArray<Q>& result ) {
+        detail::combine( lhs, rhs, result, []( double a, double b, double c, double d, double& re, double& im ) {
+            re = a + c ;
+            im = b + d ;
+        } ) ;
+    }
+
+    template<typename Q>
+    void subtract( const ComplexArray<Q>& lhs, const ComplexArray<Q>& rhs, ComplexArray<Q>& result ) {
+        detail::combine( lhs, rhs, result, []( double a, double b, double c, double d, double& re, double& im ) {
+            re = a - c ;
+            im = b - d ;
+        } ) ;
+    }
+
+    template<typename Q1, typename Q2>
+    void multiply( const ComplexArray<Q1>& lhs, const ComplexArray<Q2>& rhs, ComplexArray<decltype( Q1() * Q2() )>& result ) {
+        detail::combine( lhs, rhs, result, []( double a, double b, double c, double d, double& re, double& im ) {
+            detail::complexMultiply( a, b, c, d, re, im ) ;
+        } ) ;
+    }
+
+    template<typename Q1, typename Q2>
+    void divide( const ComplexArray<Q1>& lhs, const ComplexArray<Q2>& rhs, ComplexArray<decltype( Q1() / Q2() )>& result ) {
+        detail::combine( lhs, rhs, result, []( double a, double b, double c, double d, double& re, double& im ) {
+            detail::complexDivide( a, b, c, d, re, im ) ;
+        } ) ;
+    }
+
+    template<typename Q>
+    ComplexArray<Q> operator+( const ComplexArray<Q>& lhs, const ComplexArray<Q>& rhs ) {
+        ComplexArray<Q> result ;
+        add( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q>
+    ComplexArray<Q> operator-( const ComplexArray<Q>& lhs, const ComplexArray<Q>& rhs ) {
+        ComplexArray<Q> result ;
+        subtract( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q1, typename Q2>
+    ComplexArray<decltype( Q1() * Q2() )> operator*( const ComplexArray<Q1>& lhs, const ComplexArray<Q2>& rhs ) {
+        ComplexArray<decltype( Q1() * Q2() )> result ;
+        multiply( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q1, typename Q2>
+    ComplexArray<decltype( Q1() / Q2() )> operator/( const ComplexArray<Q1>& lhs, const ComplexArray<Q2>& rhs ) {
+        ComplexArray<decltype( Q1() / Q2() )> result ;
+        divide( lhs, rhs, result ) ;
+        return result;
+    }
+
+    /**
+     * Magnitudes of all elements. Computed as sqrt( re^2 + im^2 ), which
+     * vectorizes when sqrt() need not set errno (-fno-math-errno) but
+     * overflows for parts beyond about 1e154.
+     */
+    template<typename Q>
+    std::vector<Q> abs( const ComplexArray<Q>& x ) {
+        std::vector<Q> out( x.size() ) ;
+        static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+        double * r = reinterpret_cast<double*>( out.data() ) ;
+        const double * re = x.reals(), * im = x.imags() ;
+        for( std::size_t i = 0; i < x.size(); ++i ) {
+            r[i] = std::sqrt( re[i] * re[i] + im[i] * im[i] ) ;
+        }
+        return out;
+    }
+
+    /**
+     * Phase angles of all elements.
+     */
+    template<typename Q>
+    std::vector<Angle> arg( const ComplexArray<Q>& x ) {
+        std::vector<Angle> out( x.size() ) ;
+        for( std::size_t i = 0; i < x.size(); ++i ) {
+            out[i] = Angle( std::atan2( x.imags()[i], x.reals()[i] ) ) ;
+        }
+        return out;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* COMPLEX_HPP_ */
@@ -0,0 +1,255 @@
+/*
+ * Cumulative.hpp
+ *
+ *      Cumulative sums and cumulative trapezoidal integrals of sampled
+ *      signals. The result has the dimension of the integral: the
+ *      cumulative integral of Power samples over a Time axis is an Energy
+ *      series, that of Speed samples a Length series.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef CUMULATIVE_HPP_
+#define CUMULATIVE_HPP_
+
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "ScientificQuantities.hpp"
+#include "Parallel.hpp"
+
+namespace SciQ {
+
+    /**
+     * Series of at least this many elements are scanned in blocks on the
+     * thread pool.
+     */
+    constexpr std::size_t PARALLEL_SCAN_SIZE = std::size_t( 1 ) << 18 ;
+
+    namespace detail {
+        /**
+         * Store carry + x[0] + ... + x[i] in out[i] and return the last
+         * value. \c out may be \c x. The running sum is kept in a vector
+         * register: each group of elements is first summed in the register
+         * and the carry is then added to all of them at once, so the
+         * loop-carried dependency is one addition per group instead of one
+         * per element. The sums are associated differently than in a plain
+         * loop, which changes the rounding but not the size of the error.
+         */
+        inline double scanKernel( const double * x, double * out, std::size_t n, double carry ) {
+            std::size_t i = 0 ;
+#if defined(__AVX2__)
+            const __m256d zero = _mm256_setzero_pd() ;
+            __m256d c = _mm256_set1_pd( carry ) ;
+            for( ; i + 4 <= n; i += 4 ) {
+                __m256d v = _mm256_loadu_pd( x + i ) ;
+                // [a, b, c, d] + [0, a, b, c] + [0, 0, a, a + b]
+                v = _mm256_add_pd( v, _mm256_blend_pd( _mm256_permute4x64_pd( v, _MM_SHUFFLE( 2, 1, 0, 0 ) ), zero, 0x1 ) ) ;
+                v = _mm256_add_pd( v, _mm256_permute2f128_pd( v, v, 0x08 ) ) ;
+                v = _mm256_add_pd( v, c ) ;
+                _mm256_storeu_pd( out + i, v ) ;
+                c = _mm256_permute4x64_pd( v, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ;
+            }
+            carry = _mm256_cvtsd_f64( c ) ;
+#elif defined(__SSE2__)
+            const __m128d zero = _mm_setzero_pd() ;
+            __m128d c = _mm_set1_pd( carry ) ;
+            for( ; i + 4 <= n; i += 4 ) {
+                __m128d v0 = _mm_loadu_pd( x + i ) ;
+                __m128d v1 = _mm_loadu_pd( x + i + 2 ) ;
+                // [a, b] + [0, a]
+                v0 = _mm_add_pd( v0, _mm_unpacklo_pd( zero, v0 ) ) ;
+                v1 = _mm_add_pd( v1, _mm_unpacklo_pd( zero, v1 ) ) ;
+                v1 = _mm_add_pd( v1, _mm_unpackhi_pd( v0, v0 ) ) ;
+                v0 = _mm_add_pd( v0, c ) ;
+                v1 = _mm_add_pd( v1, c ) ;
+                _mm_storeu_pd( out + i, v0 ) ;
+                _mm_storeu_pd( out + i + 2, v1 ) ;
+                c = _mm_unpackhi_pd( v1, v1 ) ;
+            }
+            carry = _mm_cvtsd_f64( c ) ;
+#endif
+            for( ; i < n; ++i ) {
+                carry += x[i] ;
+                out[i] = carry ;
+            }
+            return carry;
+        }
+
+        /**
+         * Number of increments generated at once by the cumulative
+         * integrals; small enough to stay in the L1 cache.
+         */
+        constexpr std::size_t SCAN_BUFFER = 512 ;
+
+        /**
+         * Inclusive scan of \c n values into \c out, starting from \c init.
+         * scanRange( first, last, carry ) must write the scan of the values
+         * in [first, last) starting from \c carry to out[first, last) and
+         * return the last sum. Long series are split into blocks that are
+         * scanned in parallel; the block totals are then accumulated in
+         * order and added to the following blocks, again in parallel.
+         */
+        template<typename ScanRange>
+        void scanBlocks( double * out, std::size_t n, double init, parallel::ThreadPool& pool, ScanRange scanRange ) {
+            if( n < PARALLEL_SCAN_SIZE || pool.size() == 1 ) {
+                scanRange( 0, n, init ) ;
+                return;
+            }
+            const std::size_t blocks = 4 * pool.size() ;
+            const std::size_t block = ( ( n + blocks - 1 ) / blocks + 3 ) / 4 * 4 ;
+            std::vector<double> carry( blocks, 0.0 ) ;
+            pool.parallelFor( 0, blocks, 1, [&]( std::size_t b, std::size_t e ) {
+                for( std::size_t k = b; k < e; ++k ) {
+                    const std::size_t first = std::min( n, k * block ) ;
+                    carry[k] = scanRange( first, std::min( n, first + block ), k == 0 ? init : 0.0 ) ;
+                }
+            } ) ;
+            double sum = 0 ;
+            for( double& c : carry ) {
+                const double total = c ;
+                c = sum ;
+                sum += total ;
+            }
+            pool.parallelFor( 1, blocks, 1, [&]( std::size_t b, std::size_t e ) {
+                for( std::size_t k = b; k < e; ++k ) {
+                    const std::size_t first = std::min( n, k * block ) ;
+                    const std::size_t last = std::min( n, first + block ) ;
+                    const double offset = carry[k] ;
+                    for( std::size_t i = first; i < last; ++i ) {
+                        out[i] += offset ;
+                    }
+                }
+            } ) ;
+        }
+
+        /**
+         * Scan of increments that are generated on the fly:
+         * increments( first, count, buffer ) stores the increments of
+         * [first, first + count) in \c buffer.
+         */
+        template<typename Increments>
+        void scanIncrements( double * out, std::size_t n, parallel::ThreadPool& pool, Increments increments ) {
+            scanBlocks( out, n, 0.0, pool, [&]( std::size_t first, std::size_t last, double carry ) {
+                double buffer[SCAN_BUFFER] ;
+                for( std::size_t i = first; i < last; i += SCAN_BUFFER ) {
+                    const std::size_t count = std::min( last - i, SCAN_BUFFER ) ;
+                    increments( i, count, buffer ) ;
+                    carry = scanKernel( buffer, out + i, count, carry ) ;
+                }
+                return carry;
+            } ) ;
+        }
+
+        template<typename Q>
+        double * values( Q * q ) {
+            static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+            return reinterpret_cast<double*>( q );
+        }
+
+        template<typename Q>
+        const double * values( const Q * q ) {
+            static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+            return reinterpret_cast<const double*>( q );
+        }
+    }
+
+    /**
+     * Store the running sums x[0], x[0] + x[1], ... of the \c n values of
+     * \c x in \c out, which may be \c x itself.
+     */
+    template<typename Q>
+    void cumsum( const Q * x, std::size_t n, Q * out, parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+        const double * v = detail::values( x ) ;
+        double * r = detail::values( out ) ;
+        detail::scanBlocks( r, n, 0.0, pool, [v, r]( std::size_t first, std::size_t last, double carry ) {
+            return detail::scanKernel( v + first, r + first, last - first, carry );
+        } ) ;
+    }
+
+    template<typename Q>
+    std::vector<Q> cumsum( const std::vector<Q>& x, parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+        std::vector<Q> out( x.size() ) ;
+        cumsum( x.data(), x.size(), out.data(), pool ) ;
+        return out;
+    }
+
+    /**
+     * Cumulative trapezoidal integral of \c n samples \c y taken at the
+     * constant spacing \c dx. out[0] is zero and out[i] is the integral from
+     * the first to the i-th sample. \c out must not overlap \c y.
+     */
+    template<typename Y, typename X>
+    void cumtrapz( const Y * y, std::size_t n, const X& dx, decltype( Y() * X() ) * out,
+                   parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+        if( n == 0 ) {
+            return;
+        }
+        const double * v = detail::values( y ) ;
+        double * r = detail::values( out ) ;
+        const double h = 0.5 * dx.getValue() ;
+        detail::scanIncrements( r, n, pool, [v, h]( std::size_t first, std::size_t count, double * d ) {
+            const double * p = v + first ;
+            const std::size_t start = first == 0 ? 1 : 0 ;
+            d[0] = 0 ;
+            for( std::size_t i = start; i < count; ++i ) {
+                d[i] = h * ( p[i - 1] + p[i] ) ;
+            }
+        } ) ;
+    }
+
+    template<typename Y, typename X>
+    std::vector<decltype( Y() * X() )> cumtrapz( const std::vector<Y>& y, const X& dx,
+                                                 parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+        std::vector<decltype( Y() * X() )> out( y.size() ) ;
+        cumtrapz( y.data(), y.size(), dx, out.data(), pool ) ;
+        return out;
+    }
+
+    /**
+     * Cumulative trapezoidal integral of \c n samples \c y taken at the
+     * increasing positions \c x, e.g. timestamps. \c out must not overlap
+     * \c y or \c x.
+     */
+    template<typename Y, typename X>
+    void cumtrapz( const Y * y, const X * x, std::size_t n, decltype( Y() * X() ) * out,
+                   parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+        if( n == 0 ) {
+            return;
+        }
+        const double * v = detail::values( y ) ;
+        const double * t = detail::values( x ) ;
+        double * r = detail::values( out ) ;
+        detail::scanIncrements( r, n, pool, [v, t]( std::size_t first, std::size_t count, double * d ) {
+            const double * p = v + first ;
+            const double * q = t + first ;
+            const std::size_t start = first == 0 ? 1 : 0 ;
+            d[0] = 0 ;
+            for( std::size_t i = start; i < count; ++i ) {
+                d[i] = 0.5 * ( p[i - 1] + p[i] ) * ( q[i] - q[i - 1] ) ;
+            }
+        } ) ;
+    }
+
+    /**
+     * Throws std::invalid_argument if \c y and \c x differ in size.
+     */
+    template<typename Y, typename X>
+    std::vector<decltype( Y() * X() )> cumtrapz( const std::vector<Y>& y, const std::vector<X>& x,
+                                                 parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+        if( y.size() != x.size() ) {
+            throw std::invalid_argument( "cumtrapz: samples and positions differ in size" );
+        }
+        std::vector<decltype( Y() * X() )> out( y.size() ) ;
+        cumtrapz( y.data(), x.data(), y.size(), out.data(), pool ) ;
+        return out;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* CUMULATIVE_HPP_ */
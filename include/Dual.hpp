@@ -0,0 +1,474 @@
+/*
+ * Dual.hpp
+ *
+ *      Forward mode automatic differentiation with dimensioned dual numbers.
+ *      A Dual<Q, X> is a value of quantity Q together with its derivative
+ *      with respect to a variable of quantity X, which has the quantity
+ *      Q / X: differentiating a Power with respect to a Voltage gives a
+ *      Current. MultiDual<Q, X1, X2, ...> carries the partial derivatives
+ *      with respect to several variables at once.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef DUAL_HPP_
+#define DUAL_HPP_
+
+#include <cmath>
+#include <tuple>
+#include <type_traits>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * Value of quantity Q and its derivative with respect to a variable of
+     * quantity X.
+     *
+     * \code
+     * auto u = Dual<Voltage, Voltage>::variable( 12_V ) ;
+     * Dual<Power, Voltage> p = u * u / 6_Ohm ;
+     * Current dp_du = p.derivative() ;   // 2 u / R = 4 A
+     * \endcode
+     */
+    template<typename Q, typename X>
+    class Dual {
+    public:
+        using ValueType = Q ;
+
+        /**
+         * Type of the derivative dQ/dX.
+         */
+        using DerivativeType = decltype( Q() / X() ) ;
+
+        constexpr Dual()
+        : v( 0 ), d( 0 ) {
+        }
+
+        /**
+         * A value with the given derivative. Without a derivative the value
+         * is a constant.
+         */
+        constexpr Dual( const Q& value, const DerivativeType& derivative = DerivativeType() )
+        : v( value.getValue() ), d( derivative.getValue() ) {
+        }
+
+        /**
+         * The independent variable itself, whose derivative is one.
+         */
+        template<typename Y = Q, typename std::enable_if<std::is_same<Y, X>::value>::type* = nullptr>
+        static constexpr Dual variable( const Q& x ) {
+            return Dual( x, DerivativeType( 1.0 ) );
+        }
+
+        constexpr Q value() const {
+            return Q( v );
+        }
+
+        constexpr DerivativeType derivative() const {
+            return DerivativeType( d );
+        }
+
+        Dual& operator+=( const Dual& rhs ) {
+            v += rhs.v ;
+            d += rhs.d ;
+            return *this;
+        }
+
+        Dual& operator-=( const Dual& rhs ) {
+            v -= rhs.v ;
+            d -= rhs.d ;
+            return *this;
+        }
+
+        Dual& operator*=( double rhs ) {
+            v *= rhs ;
+            d *= rhs ;
+            return *this;
+        }
+
+        Dual& operator/=( double rhs ) {
+            return *this *= 1.0 / rhs;
+        }
+
+    private:
+        double v ;
+        double d ;
+    } ;
+
+    //
+    // Arithmetic operators for Dual<> instances.
+    //
+    template<typename Q, typename X>
+    Dual<Q, X> operator+( Dual<Q, X> lhs, const Dual<Q, X>& rhs ) {
+        return lhs += rhs;
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator-( Dual<Q, X> lhs, const Dual<Q, X>& rhs ) {
+        return lhs -= rhs;
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator-( Dual<Q, X> rhs ) {
+        return rhs *= -1.0;
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator+( Dual<Q, X> lhs, const Q& rhs ) {
+        return lhs += Dual<Q, X>( rhs );
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator+( const Q& lhs, Dual<Q, X> rhs ) {
+        return rhs += Dual<Q, X>( lhs );
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator-( Dual<Q, X> lhs, const Q& rhs ) {
+        return lhs -= Dual<Q, X>( rhs );
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator-( const Q& lhs, const Dual<Q, X>& rhs ) {
+        return Dual<Q, X>( lhs ) -= rhs;
+    }
+
+    template<typename Q1, typename Q2, typename X>
+    Dual<decltype( Q1() * Q2() ), X> operator*( const Dual<Q1, X>& lhs, const Dual<Q2, X>& rhs ) {
+        using R = Dual<decltype( Q1() * Q2() ), X> ;
+        const double a = lhs.value().getValue(), b = rhs.value().getValue() ;
+        return R( typename R::ValueType( a * b ),
+                  typename R::DerivativeType( lhs.derivative().getValue() * b + a * rhs.derivative().getValue() ) );
+    }
+
+    template<typename Q1, typename Q2, typename X>
+    Dual<decltype( Q1() / Q2() ), X> operator/( const Dual<Q1, X>& lhs, const Dual<Q2, X>& rhs ) {
+        using R = Dual<decltype( Q1() / Q2() ), X> ;
+        const double inv = 1.0 / rhs.value().getValue() ;
+        const double q = lhs.value().getValue() * inv ;
+        return R( typename R::ValueType( q ),
+                  typename R::DerivativeType( ( lhs.derivative().getValue() - q * rhs.derivative().getValue() ) * inv ) );
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator*( Dual<Q, X> lhs, double rhs ) {
+        return lhs *= rhs;
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator*( double lhs, Dual<Q, X> rhs ) {
+        return rhs *= lhs;
+    }
+
+    template<typename Q, typename X>
+    Dual<Q, X> operator/( Dual<Q, X> lhs, double rhs ) {
+        return lhs /= rhs;
+    }
+
+    /**
+     * Products and quotients with constant quantities.
+     */
+    template<typename Q, typename X, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Dual<decltype( Q() * Quantity<L, M, T, EC, TT, AS, LI>() ), X>
+    operator*( const Dual<Q, X>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return lhs * Dual<Quantity<L, M, T, EC, TT, AS, LI>, X>( rhs );
+    }
+
+    template<typename Q, typename X, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Dual<decltype( Quantity<L, M, T, EC, TT, AS, LI>() * Q() ), X>
+    operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Dual<Q, X>& rhs ) {
+        return Dual<Quantity<L, M, T, EC, TT, AS, LI>, X>( lhs ) * rhs;
+    }
+
+    template<typename Q, typename X, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Dual<decltype( Q() / Quantity<L, M, T, EC, TT, AS, LI>() ), X>
+    operator/( const Dual<Q, X>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return lhs / Dual<Quantity<L, M, T, EC, TT, AS, LI>, X>( rhs );
+    }
+
+    template<typename Q, typename X, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Dual<decltype( Quantity<L, M, T, EC, TT, AS, LI>() / Q() ), X>
+    operator/( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Dual<Q, X>& rhs ) {
+        return Dual<Quantity<L, M, T, EC, TT, AS, LI>, X>( lhs ) / rhs;
+    }
+
+    //
+    // Comparisons use the values only.
+    //
+    template<typename Q, typename X>
+    bool operator<( const Dual<Q, X>& lhs, const Dual<Q, X>& rhs ) {
+        return lhs.value() < rhs.value();
+    }
+
+    template<typename Q, typename X>
+    bool operator>( const Dual<Q, X>& lhs, const Dual<Q, X>& rhs ) {
+        return lhs.value() > rhs.value();
+    }
+
+    template<typename Q, typename X>
+    Dual<decltype( sqrt( Q() ) ), X> sqrt( const Dual<Q, X>& x ) {
+        using R = Dual<decltype( sqrt( Q() ) ), X> ;
+        const double r = std::sqrt( x.value().getValue() ) ;
+        const double d = x.derivative().getValue() ;
+        // A zero derivative stays zero at r = 0 instead of giving 0 * inf
+        return R( typename R::ValueType( r ), typename R::DerivativeType( d == 0.0 ? 0.0 : 0.5 * d / r ) );
+    }
+
+    template<int N, typename Q, typename X>
+    Dual<decltype( pow<N>( Q() ) ), X> pow( const Dual<Q, X>& x ) {
+        using R = Dual<decltype( pow<N>( Q() ) ), X> ;
+        const double a = x.value().getValue() ;
+        // Separate from the value so that a = 0 does not give 0 * inf
+        const double slope = N == 0 ? 0.0 : N * std::pow( a, N - 1 ) ;
+        return R( typename R::ValueType( std::pow( a, N ) ), typename R::DerivativeType( slope * x.derivative().getValue() ) );
+    }
+
+    template<typename Q, typename X>
+    std::ostream& operator<<( std::ostream& os, const Dual<Q, X>& x )
+    {
+        os << x.value() << " (d/dx " << x.derivative() << ")" ;
+        return os ;
+    }
+
+    /**
+     * Value of quantity Q and its partial derivatives with respect to
+     * variables of the quantities Xs. Partial I has the quantity Q / X_I.
+     * The partials are stored as one array, so every operation updates all
+     * of them in a single loop that the compiler vectorizes.
+     *
+     * \code
+     * using P = MultiDual<Voltage, Voltage, Resistance> ;
+     * auto u = P::variable<0>( 12_V ) ;
+     * auto r = MultiDual<Resistance, Voltage, Resistance>::variable<1>( 6_Ohm ) ;
+     * auto power = u * u / r ;
+     * Current dp_du = power.partial<0>() ;
+     * \endcode
+     */
+    template<typename Q, typename... Xs>
+    class MultiDual {
+    public:
+        /**
+         * Number of variables.
+         */
+        static constexpr std::size_t N = sizeof...(Xs) ;
+
+        static_assert( N > 0, "A dual number needs at least one variable" );
+
+        /**
+         * Quantity of variable I.
+         */
+        template<std::size_t I>
+        using VariableType = typename std::tuple_element<I, std::tuple<Xs...>>::type ;
+
+        /**
+         * Type of the partial derivative with respect to variable I.
+         */
+        template<std::size_t I>
+        using PartialType = decltype( Q() / VariableType<I>() ) ;
+
+        MultiDual()
+        : v( 0 ), d{} {
+        }
+
+        /**
+         * A constant.
+         */
+        explicit MultiDual( const Q& value )
+        : v( value.getValue() ), d{} {
+        }
+
+        /**
+         * Variable I itself: its partial with respect to itself is one, all
+         * other partials are zero.
+         */
+        template<std::size_t I>
+        static MultiDual variable( const Q& x ) {
+            static_assert( std::is_same<Q, VariableType<I>>::value, "The quantity does not match the variable" );
+            MultiDual result( x ) ;
+            result.d[I] = 1.0 ;
+            return result;
+        }
+
+        Q value() const {
+            return Q( v );
+        }
+
+        template<std::size_t I>
+        PartialType<I> partial() const {
+            return PartialType<I>( d[I] );
+        }
+
+        template<std::size_t I>
+        void setPartial( const PartialType<I>& p ) {
+            d[I] = p.getValue() ;
+        }
+
+        /**
+         * The partials in fundamental SI units.
+         */
+        const double * partials() const {
+            return d;
+        }
+
+        double * partials() {
+            return d;
+        }
+
+        MultiDual& operator+=( const MultiDual& rhs ) {
+            v += rhs.v ;
+            for( std::size_t i = 0; i < N; ++i ) {
+                d[i] += rhs.d[i] ;
+            }
+            return *this;
+        }
+
+        MultiDual& operator-=( const MultiDual& rhs ) {
+            v -= rhs.v ;
+            for( std::size_t i = 0; i < N; ++i ) {
+                d[i] -= rhs.d[i] ;
+            }
+            return *this;
+        }
+
+        MultiDual& operator*=( double rhs ) {
+            v *= rhs ;
+            for( std::size_t i = 0; i < N; ++i ) {
+                d[i] *= rhs ;
+            }
+            return *this;
+        }
+
+        MultiDual& operator/=( double rhs ) {
+            return *this *= 1.0 / rhs;
+        }
+
+        /**
+         * Apply the chain rule: the result has the value \c value and the
+         * partials scale times the partials of \c x. A zero partial stays
+         * zero where \c scale is infinite, as for sqrt() at zero.
+         */
+        template<typename R>
+        static MultiDual<R, Xs...> chain( const MultiDual& x, double value, double scale ) {
+            MultiDual<R, Xs...> result { R( value ) } ;
+            double * r = result.partials() ;
+            for( std::size_t i = 0; i < N; ++i ) {
+                r[i] = x.d[i] == 0.0 ? 0.0 : scale * x.d[i] ;
+            }
+            return result;
+        }
+
+    private:
+        double v ;
+        double d[N] ;
+    } ;
+
+    //
+    // Arithmetic operators for MultiDual<> instances.
+    //
+    template<typename Q, typename... Xs>
+    MultiDual<Q, Xs...> operator+( MultiDual<Q, Xs...> lhs, const MultiDual<Q, Xs...>& rhs ) {
+        return lhs += rhs;
+    }
+
+    template<typename Q, typename... Xs>
+    MultiDual<Q, Xs...> operator-( MultiDual<Q, Xs...> lhs, const MultiDual<Q, Xs...>& rhs ) {
+        return lhs -= rhs;
+    }
+
+    template<typename Q, typename... Xs>
+    MultiDual<Q, Xs...> operator-( MultiDual<Q, Xs...> rhs ) {
+        return rhs *= -1.0;
+    }
+
+    template<typename Q1, typename Q2, typename... Xs>
+    MultiDual<decltype( Q1() * Q2() ), Xs...> operator*( const MultiDual<Q1, Xs...>& lhs, const MultiDual<Q2, Xs...>& rhs ) {
+        using R = decltype( Q1() * Q2() ) ;
+        const double a = lhs.value().getValue(), b = rhs.value().getValue() ;
+        MultiDual<R, Xs...> result { R( a * b ) } ;
+        const double * da = lhs.partials() ;
+        const double * db = rhs.partials() ;
+        double * r = result.partials() ;
+        for( std::size_t i = 0; i < sizeof...(Xs); ++i ) {
+            r[i] = da[i] * b + a * db[i] ;
+        }
+        return result;
+    }
+
+    template<typename Q1, typename Q2, typename... Xs>
+    MultiDual<decltype( Q1() / Q2() ), Xs...> operator/( const MultiDual<Q1, Xs...>& lhs, const MultiDual<Q2, Xs...>& rhs ) {
+        using R = decltype( Q1() / Q2() ) ;
+        const double inv = 1.0 / rhs.value().getValue() ;
+        const double q = lhs.value().getValue() * inv ;
+        MultiDual<R, Xs...> result { R( q ) } ;
+        const double * da = lhs.partials() ;
+        const double * db = rhs.partials() ;
+        double * r = result.partials() ;
+        for( std::size_t i = 0; i < sizeof...(Xs); ++i ) {
+            r[i] = ( da[i] - q * db[i] ) * inv ;
+        }
+        return result;
+    }
+
+    template<typename Q, typename... Xs>
+    MultiDual<Q, Xs...> operator*( MultiDual<Q, Xs...> lhs, double rhs ) {
+        return lhs *= rhs;
+    }
+
+    template<typename Q, typename... Xs>
+    MultiDual<Q, Xs...> operator*( double lhs, MultiDual<Q, Xs...> rhs ) {
+        return rhs *= lhs;
+    }
+
+    template<typename Q, typename... Xs>
+    MultiDual<Q, Xs...> operator/( MultiDual<Q, Xs...> lhs, double rhs ) {
+        return lhs /= rhs;
+    }
+
+    /**
+     * Products and quotients with constant quantities.
+     */
+    template<typename Q, typename... Xs, class L, class M, class T, class EC, class TT, class AS, class LI>
+    MultiDual<decltype( Q() * Quantity<L, M, T, EC, TT, AS, LI>() ), Xs...>
+    operator*( const MultiDual<Q, Xs...>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return MultiDual<Q, Xs...>::template chain<decltype( Q() * rhs )>( lhs, lhs.value().getValue() * rhs.getValue(), rhs.getValue() );
+    }
+
+    template<typename Q, typename... Xs, class L, class M, class T, class EC, class TT, class AS, class LI>
+    MultiDual<decltype( Quantity<L, M, T, EC, TT, AS, LI>() * Q() ), Xs...>
+    operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const MultiDual<Q, Xs...>& rhs ) {
+        return rhs * lhs;
+    }
+
+    template<typename Q, typename... Xs, class L, class M, class T, class EC, class TT, class AS, class LI>
+    MultiDual<decltype( Q() / Quantity<L, M, T, EC, TT, AS, LI>() ), Xs...>
+    operator/( const MultiDual<Q, Xs...>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return MultiDual<Q, Xs...>::template chain<decltype( Q() / rhs )>( lhs, lhs.value().getValue() / rhs.getValue(), 1.0 / rhs.getValue() );
+    }
+
+    template<typename Q, typename... Xs, class L, class M, class T, class EC, class TT, class AS, class LI>
+    MultiDual<decltype( Quantity<L, M, T, EC, TT, AS, LI>() / Q() ), Xs...>
+    operator/( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const MultiDual<Q, Xs...>& rhs ) {
+        const double inv = 1.0 / rhs.value().getValue() ;
+        const double q = lhs.getValue() * inv ;
+        return MultiDual<Q, Xs...>::template chain<decltype( lhs / Q() )>( rhs, q, -q * inv );
+    }
+
+    template<typename Q, typename... Xs>
+    MultiDual<decltype( sqrt( Q() ) ), Xs...> sqrt( const MultiDual<Q, Xs...>& x ) {
+        const double r = std::sqrt( x.value().getValue() ) ;
+        return MultiDual<Q, Xs...>::template chain<decltype( sqrt( Q() ) )>( x, r, 0.5 / r );
+    }
+
+    template<int N, typename Q, typename... Xs>
+    MultiDual<decltype( pow<N>( Q() ) ), Xs...> pow( const MultiDual<Q, Xs...>& x ) {
+        const double a = x.value().getValue() ;
+        const double slope = N == 0 ? 0.0 : N * std::pow( a, N - 1 ) ;
+        return MultiDual<Q, Xs...>::template chain<decltype( pow<N>( Q() ) )>( x, std::pow( a, N ), slope );
+    }
+
+}
+// namespace SciQ;
+
+#endif /* DUAL_HPP_ */
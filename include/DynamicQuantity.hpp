@@ -0,0 +1,574 @@
+/*
+ * DynamicQuantity.hpp
+ *
+ *      Runtime counterpart of the compile-time Quantity<> types. A
+ *      DynamicQuantity carries its dimension as a packed 64-bit word so that
+ *      values read from configuration files, messages or from_string() can be
+ *      handled with runtime-checked arithmetic and converted back to the
+ *      static types once their dimension is known.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef DYNAMICQUANTITY_HPP_
+#define DYNAMICQUANTITY_HPP_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * Dimension of a quantity as the exponents of the seven base units,
+     * packed into a single 64-bit word. Each exponent occupies one signed
+     * byte (base unit i lives in byte i, in the order L, M, T, EC, TT, AS, LI)
+     * and is stored in steps of 1/FRACTION, so that the results of sqrt() can
+     * be represented. The highest byte is always zero.
+     *
+     * Two dimensions are equal if and only if their packed words are equal,
+     * which makes dimension checks a single integer comparison.
+     */
+    class Dimension {
+    public:
+        /**
+         * Exponents are stored as multiples of 1/FRACTION.
+         */
+        static constexpr int FRACTION = 4 ;
+
+        /**
+         * Range of the exponents that can be represented.
+         */
+        static constexpr int MIN_EXPONENT = -128 / FRACTION ;
+        static constexpr int MAX_EXPONENT = 127 / FRACTION ;
+
+        /**
+         * Creates the dimension of a dimensionless quantity.
+         */
+        constexpr Dimension()
+        : bits( 0 ) {
+        }
+
+        /**
+         * Creates a dimension from its packed representation as returned by
+         * getPacked().
+         */
+        constexpr explicit Dimension( std::uint64_t packed )
+        : bits( packed & 0x00FFFFFFFFFFFFFFull ) {
+        }
+
+        /**
+         * Creates a dimension from the exponent num/den of each of the base
+         * units. Throws std::domain_error if an exponent cannot be
+         * represented.
+         */
+        static constexpr Dimension fromRatios( const long num[NUM_BASE_UNITS],
+                                               const long den[NUM_BASE_UNITS] ) {
+            std::uint64_t packed = 0 ;
+            for( int i = 0; i < NUM_BASE_UNITS; ++i ) {
+                packed |= lane( encode( num[i], den[i] ), i ) ;
+            }
+            return Dimension( packed ) ;
+        }
+
+        /**
+         * Get the packed representation of this dimension.
+         */
+        constexpr std::uint64_t getPacked() const {
+            return bits;
+        }
+
+        /**
+         * Get the exponent of base unit \c i multiplied by FRACTION.
+         */
+        constexpr int getScaledExponent( int i ) const {
+            return static_cast<std::int8_t>( ( bits >> ( 8 * i ) ) & 0xFF );
+        }
+
+        /**
+         * Get the numerator of the (reduced) exponent of base unit \c i.
+         */
+        constexpr long getNumerator( int i ) const {
+            return getScaledExponent( i ) / gcd( getScaledExponent( i ), FRACTION );
+        }
+
+        /**
+         * Get the denominator of the (reduced) exponent of base unit \c i.
+         */
+        constexpr long getDenominator( int i ) const {
+            return FRACTION / gcd( getScaledExponent( i ), FRACTION );
+        }
+
+        /**
+         * True if all exponents are zero.
+         */
+        constexpr bool isDimensionless() const {
+            return bits == 0;
+        }
+
+        /**
+         * Raise the dimension to an integer power (multiplies all exponents).
+         * Throws std::overflow_error if an exponent leaves the supported
+         * range.
+         */
+        constexpr Dimension pow( int power ) const {
+            std::uint64_t packed = 0 ;
+            for( int i = 0; i < NUM_BASE_UNITS; ++i ) {
+                packed |= lane( checkRange( getScaledExponent( i ) * power ), i ) ;
+            }
+            return Dimension( packed ) ;
+        }
+
+        /**
+         * Take the n-th root of the dimension (divides all exponents). Throws
+         * std::domain_error if the result cannot be represented.
+         */
+        constexpr Dimension root( int n ) const {
+            std::uint64_t packed = 0 ;
+            for( int i = 0; i < NUM_BASE_UNITS; ++i ) {
+                if( n == 0 || getScaledExponent( i ) % n != 0 ) {
+                    throw std::domain_error( "Dimension exponent is not representable" );
+                }
+                packed |= lane( getScaledExponent( i ) / n, i ) ;
+            }
+            return Dimension( packed ) ;
+        }
+
+        /**
+         * Dimension of the product of two quantities (adds the exponents).
+         */
+        friend constexpr Dimension operator*( const Dimension& lhs, const Dimension& rhs ) {
+            std::uint64_t packed = 0 ;
+            for( int i = 0; i < NUM_BASE_UNITS; ++i ) {
+                packed |= lane( checkRange( lhs.getScaledExponent( i ) + rhs.getScaledExponent( i ) ), i ) ;
+            }
+            return Dimension( packed ) ;
+        }
+
+        /**
+         * Dimension of the ratio of two quantities (subtracts the exponents).
+         */
+        friend constexpr Dimension operator/( const Dimension& lhs, const Dimension& rhs ) {
+            std::uint64_t packed = 0 ;
+            for( int i = 0; i < NUM_BASE_UNITS; ++i ) {
+                packed |= lane( checkRange( lhs.getScaledExponent( i ) - rhs.getScaledExponent( i ) ), i ) ;
+            }
+            return Dimension( packed ) ;
+        }
+
+        friend constexpr bool operator==( const Dimension& lhs, const Dimension& rhs ) {
+            return lhs.bits == rhs.bits;
+        }
+
+        friend constexpr bool operator!=( const Dimension& lhs, const Dimension& rhs ) {
+            return lhs.bits != rhs.bits;
+        }
+
+    private:
+        static constexpr int gcd( int a, int b ) {
+            a = a < 0 ? -a : a ;
+            while( b != 0 ) {
+                int t = a % b ;
+                a = b ;
+                b = t ;
+            }
+            return a == 0 ? 1 : a ;
+        }
+
+        static constexpr int checkRange( int scaled ) {
+            if( scaled < -128 || scaled > 127 ) {
+                throw std::overflow_error( "Dimension exponent out of range" );
+            }
+            return scaled;
+        }
+
+        static constexpr int encode( long num, long den ) {
+            if( den == 0 || ( num * FRACTION ) % den != 0 ) {
+                throw std::domain_error( "Dimension exponent is not representable" );
+            }
+            return checkRange( static_cast<int>( num * FRACTION / den ) );
+        }
+
+        static constexpr std::uint64_t lane( int scaled, int i ) {
+            return static_cast<std::uint64_t>( static_cast<std::uint8_t>( scaled ) ) << ( 8 * i );
+        }
+
+        /**
+         * Packed exponents, one signed byte per base unit.
+         */
+        std::uint64_t bits;
+    };
+
+    /**
+     * Maps a compile-time Quantity<> type to its runtime Dimension. The
+     * exponents are validated at compile time.
+     */
+    template<typename Q>
+    struct DimensionOf
+    {} ;
+
+    template<class L, class M, class T, class EC, class TT, class AS, class LI>
+    struct DimensionOf<Quantity<L, M, T, EC, TT, AS, LI>>
+    {
+        template<class R>
+        struct Representable {
+            static constexpr bool value = ( R::num * Dimension::FRACTION ) % R::den == 0 &&
+                                          R::num * Dimension::FRACTION / R::den >= -128 &&
+                                          R::num * Dimension::FRACTION / R::den <= 127 ;
+        } ;
+        static_assert( Representable<L>::value && Representable<M>::value &&
+                       Representable<T>::value && Representable<EC>::value &&
+                       Representable<TT>::value && Representable<AS>::value &&
+                       Representable<LI>::value,
+                       "Exponents of the quantity cannot be represented by Dimension." );
+
+        static constexpr Dimension get() {
+            const long num[NUM_BASE_UNITS] = { L::num, M::num, T::num, EC::num, TT::num, AS::num, LI::num } ;
+            const long den[NUM_BASE_UNITS] = { L::den, M::den, T::den, EC::den, TT::den, AS::den, LI::den } ;
+            return Dimension::fromRatios( num, den );
+        }
+    } ;
+
+    /**
+     * Get the runtime Dimension of the Quantity<> type Q.
+     */
+    template<typename Q>
+    constexpr Dimension dimensionOf() {
+        return DimensionOf<Q>::get();
+    }
+
+    /**
+     * A quantity whose dimension is only known at runtime. It holds the value
+     * in the fundamental SI unit together with a packed Dimension. All
+     * arithmetic is checked at runtime: adding or comparing quantities with
+     * different dimensions throws std::invalid_argument.
+     *
+     * Static quantities convert implicitly into a DynamicQuantity. The
+     * reverse conversion is checked:
+     *
+     * \code
+     * DynamicQuantity d = 3_m ;
+     * Length l = d.as<Length>() ;  // OK
+     * Time t = d.as<Time>() ;      // throws std::invalid_argument
+     * \endcode
+     */
+    class DynamicQuantity {
+    public:
+        /**
+         * Creates a dimensionless quantity with the specified value.
+         */
+        constexpr explicit DynamicQuantity( double val=0, Dimension dim=Dimension() )
+        : value( val ), dimension( dim ) {
+        }
+
+        /**
+         * Creates a dynamic quantity from a static one.
+         */
+        template<class L, class M, class T, class EC, class TT, class AS, class LI>
+        constexpr DynamicQuantity( const Quantity<L, M, T, EC, TT, AS, LI>& q )
+        : value( q.getValue() ), dimension( dimensionOf<Quantity<L, M, T, EC, TT, AS, LI>>() ) {
+        }
+
+        /**
+         * Get the value of this quantity in its fundamental SI unit.
+         */
+        constexpr double getValue() const {
+            return value;
+        }
+
+        /**
+         * Get the dimension of this quantity.
+         */
+        constexpr Dimension getDimension() const {
+            return dimension;
+        }
+
+        /**
+         * True if this quantity has the dimension of the Quantity<> type Q.
+         */
+        template<typename Q>
+        constexpr bool is() const {
+            return dimension == dimensionOf<Q>();
+        }
+
+        /**
+         * Convert this quantity into the Quantity<> type Q. Throws
+         * std::invalid_argument if the dimensions do not match.
+         */
+        template<typename Q>
+        constexpr Q as() const {
+            if( !is<Q>() ) {
+                throw std::invalid_argument( "DynamicQuantity: dimension mismatch in conversion" );
+            }
+            return Q( value );
+        }
+
+        /**
+         * Explicit conversion into a static quantity. Same as as<>().
+         */
+        template<class L, class M, class T, class EC, class TT, class AS, class LI>
+        constexpr explicit operator Quantity<L, M, T, EC, TT, AS, LI>() const {
+            return as<Quantity<L, M, T, EC, TT, AS, LI>>();
+        }
+
+        /**
+         * Get the value of this quantity in units of \c rhs. Throws
+         * std::invalid_argument if the dimensions do not match.
+         */
+        constexpr double in( const DynamicQuantity& rhs ) const {
+            return requireSame( rhs ), value / rhs.value;
+        }
+
+        DynamicQuantity& operator+=( const DynamicQuantity& rhs ) {
+            requireSame( rhs );
+            value += rhs.value;
+            return *this;
+        }
+
+        DynamicQuantity& operator-=( const DynamicQuantity& rhs ) {
+            requireSame( rhs );
+            value -= rhs.value;
+            return *this;
+        }
+
+        /**
+         * Throws std::invalid_argument unless \c rhs has the same dimension
+         * as this quantity.
+         */
+        constexpr bool requireSame( const DynamicQuantity& rhs ) const {
+            if( dimension != rhs.dimension ) {
+                throw std::invalid_argument( "DynamicQuantity: dimension mismatch" );
+            }
+            return true;
+        }
+
+    private:
+        /**
+         * Value of this quantity in its fundamental SI units.
+         */
+        double value;
+
+        /**
+         * Dimension of the value.
+         */
+        Dimension dimension;
+    };
+
+    //
+    // Arithmetic operators for DynamicQuantity instances. Static quantities
+    // take part through the implicit conversion; the explicit overloads for
+    // Quantity<> operands are needed so that they are preferred over the
+    // generic scalar operators of Quantity<>.
+    //
+    inline DynamicQuantity operator+( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return DynamicQuantity( lhs ) += rhs;
+    }
+
+    inline DynamicQuantity operator-( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return DynamicQuantity( lhs ) -= rhs;
+    }
+
+    constexpr DynamicQuantity operator*( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return DynamicQuantity( lhs.getValue() * rhs.getValue(), lhs.getDimension() * rhs.getDimension() );
+    }
+
+    constexpr DynamicQuantity operator/( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return DynamicQuantity( lhs.getValue() / rhs.getValue(), lhs.getDimension() / rhs.getDimension() );
+    }
+
+    constexpr DynamicQuantity operator*( const DynamicQuantity& lhs, double rhs ) {
+        return DynamicQuantity( lhs.getValue() * rhs, lhs.getDimension() );
+    }
+
+    constexpr DynamicQuantity operator*( double lhs, const DynamicQuantity& rhs ) {
+        return DynamicQuantity( lhs * rhs.getValue(), rhs.getDimension() );
+    }
+
+    constexpr DynamicQuantity operator/( const DynamicQuantity& lhs, double rhs ) {
+        return DynamicQuantity( lhs.getValue() / rhs, lhs.getDimension() );
+    }
+
+    constexpr DynamicQuantity operator/( double lhs, const DynamicQuantity& rhs ) {
+        return DynamicQuantity( lhs / rhs.getValue(), Dimension() / rhs.getDimension() );
+    }
+
+    template<class L, class M, class T, class EC, class TT, class AS, class LI>
+    constexpr DynamicQuantity operator*( const DynamicQuantity& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return lhs * DynamicQuantity( rhs );
+    }
+
+    template<class L, class M, class T, class EC, class TT, class AS, class LI>
+    constexpr DynamicQuantity operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const DynamicQuantity& rhs ) {
+        return DynamicQuantity( lhs ) * rhs;
+    }
+
+    template<class L, class M, class T, class EC, class TT, class AS, class LI>
+    constexpr DynamicQuantity operator/( const DynamicQuantity& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return lhs / DynamicQuantity( rhs );
+    }
+
+    template<class L, class M, class T, class EC, class TT, class AS, class LI>
+    constexpr DynamicQuantity operator/( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const DynamicQuantity& rhs ) {
+        return DynamicQuantity( lhs ) / rhs;
+    }
+
+    //
+    // Comparison operators. Comparing quantities of different dimensions
+    // throws std::invalid_argument.
+    //
+    constexpr bool operator==( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return lhs.requireSame( rhs ) && lhs.getValue() == rhs.getValue();
+    }
+
+    constexpr bool operator!=( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return lhs.requireSame( rhs ) && lhs.getValue() != rhs.getValue();
+    }
+
+    constexpr bool operator<=( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return lhs.requireSame( rhs ) && lhs.getValue() <= rhs.getValue();
+    }
+
+    constexpr bool operator>=( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return lhs.requireSame( rhs ) && lhs.getValue() >= rhs.getValue();
+    }
+
+    constexpr bool operator<( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return lhs.requireSame( rhs ) && lhs.getValue() < rhs.getValue();
+    }
+
+    constexpr bool operator>( const DynamicQuantity& lhs, const DynamicQuantity& rhs ) {
+        return lhs.requireSame( rhs ) && lhs.getValue() > rhs.getValue();
+    }
+
+    // Mathematical operations
+    inline DynamicQuantity sqrt( const DynamicQuantity& lhs ) {
+        return DynamicQuantity( std::sqrt( lhs.getValue() ), lhs.getDimension().root( 2 ) );
+    }
+
+    template<int power>
+    DynamicQuantity pow( const DynamicQuantity& lhs ) {
+        return DynamicQuantity( std::pow( lhs.getValue(), (double)power ), lhs.getDimension().pow( power ) );
+    }
+
+    inline DynamicQuantity pow( const DynamicQuantity& lhs, int power ) {
+        return DynamicQuantity( std::pow( lhs.getValue(), (double)power ), lhs.getDimension().pow( power ) );
+    }
+
+    /**
+     * Display the dimension using the symbols of the base units, in the same
+     * format as the generic operator<<() of Quantity<>.
+     */
+    inline std::ostream& operator<<( std::ostream& os, const Dimension& dim )
+    {
+        static const std::array<std::string, NUM_BASE_UNITS> base_units {
+            FundamentalUnit<Length>::Name,
+            FundamentalUnit<Mass>::Name,
+            FundamentalUnit<Time>::Name,
+            FundamentalUnit<Current>::Name,
+            FundamentalUnit<Temperature>::Name,
+            FundamentalUnit<Substance>::Name,
+            FundamentalUnit<Luminous>::Name
+        } ;
+        for(int i=0; i<NUM_BASE_UNITS; ++i) {
+            const long num = dim.getNumerator( i ) ;
+            const long den = dim.getDenominator( i ) ;
+            if (0 == num) {
+                continue ;
+            }
+            if (1 == num && 1 == den) {
+                os << " " << base_units[i] ;
+            } else {
+                os << " " << base_units[i] << "^" << num ;
+            }
+            if (1 != den) {
+                os << "/" << den;
+            }
+        }
+        return os ;
+    }
+
+    inline std::ostream& operator<<( std::ostream& os, const DynamicQuantity& q )
+    {
+        os << q.getValue() << q.getDimension() ;
+        return os ;
+    }
+
+    /**
+     * Given a string with a value and a unit, as accepted by
+     * from_string( const std::string, double* ), create a DynamicQuantity
+     * with the dimension of that unit.
+     * @param s String containing the value and unit
+     * @return True if the string could be parsed
+     */
+    inline bool from_string( const std::string input_val_unit, DynamicQuantity * quantity ) {
+      // Supported units and their dimensions
+      static const std::vector<std::pair<std::string, Dimension>> UNITS = {
+                  { std::string( FundamentalUnit<Length>::Name ), dimensionOf<Length>() },
+                  { std::string( FundamentalUnit<Mass>::Name ), dimensionOf<Mass>() },
+                  { std::string( FundamentalUnit<Time>::Name ), dimensionOf<Time>() },
+                  { std::string( FundamentalUnit<Current>::Name ), dimensionOf<Current>() },
+                  { std::string( FundamentalUnit<Temperature>::Name ), dimensionOf<Temperature>() },
+                  { std::string( FundamentalUnit<Substance>::Name ), dimensionOf<Substance>() },
+                  { std::string( FundamentalUnit<Luminous>::Name ), dimensionOf<Luminous>() },
+                  { std::string( FundamentalUnit<Angle>::Name ), dimensionOf<Angle>() },
+                  { std::string( FundamentalUnit<Frequency>::Name ), dimensionOf<Frequency>() },
+                  { std::string( FundamentalUnit<Force>::Name ), dimensionOf<Force>() },
+                  { std::string( FundamentalUnit<Pressure>::Name ), dimensionOf<Pressure>() },
+                  { std::string( FundamentalUnit<Energy>::Name ), dimensionOf<Energy>() },
+                  { std::string( FundamentalUnit<Power>::Name ), dimensionOf<Power>() },
+                  { std::string( FundamentalUnit<Charge>::Name ), dimensionOf<Charge>() },
+                  { std::string( FundamentalUnit<Voltage>::Name ), dimensionOf<Voltage>() },
+                  { std::string( FundamentalUnit<Capacitance>::Name ), dimensionOf<Capacitance>() },
+                  { std::string( FundamentalUnit<Resistance>::Name ), dimensionOf<Resistance>() },
+                  { std::string( FundamentalUnit<Conductance>::Name ), dimensionOf<Conductance>() },
+                  { std::string( FundamentalUnit<MagneticFlux>::Name ), dimensionOf<MagneticFlux>() },
+                  { std::string( FundamentalUnit<MagneticField>::Name ), dimensionOf<MagneticField>() },
+                  { std::string( FundamentalUnit<Inductance>::Name ), dimensionOf<Inductance>() },
+                  { std::string( FundamentalUnit<Illuminance>::Name ), dimensionOf<Illuminance>() },
+                  { std::string( FundamentalUnit<AbsorbedDose>::Name ), dimensionOf<AbsorbedDose>() },
+                  { std::string( FundamentalUnit<CatalyticActivity>::Name ), dimensionOf<CatalyticActivity>() },
+                  { std::string( FundamentalUnit<DynamicViscosity>::Name ), dimensionOf<DynamicViscosity>() },
+                  { std::string( FundamentalUnit<AngularAcceleration>::Name ), dimensionOf<AngularAcceleration>() },
+                  { std::string( FundamentalUnit<Irradiance>::Name ), dimensionOf<Irradiance>() },
+                  { std::string( FundamentalUnit<Entropy>::Name ), dimensionOf<Entropy>() },
+                  { std::string( FundamentalUnit<SpecificEntropy>::Name ), dimensionOf<SpecificEntropy>() },
+                  { std::string( FundamentalUnit<ThermalConductivity>::Name ), dimensionOf<ThermalConductivity>() },
+                  { std::string( FundamentalUnit<ElectricFieldStrength>::Name ), dimensionOf<ElectricFieldStrength>() },
+                  { std::string( FundamentalUnit<ElectricChargeDensity>::Name ), dimensionOf<ElectricChargeDensity>() },
+                  { std::string( FundamentalUnit<ElectricFluxDensity>::Name ), dimensionOf<ElectricFluxDensity>() },
+                  { std::string( FundamentalUnit<Permittivity>::Name ), dimensionOf<Permittivity>() },
+                  { std::string( FundamentalUnit<Permeability>::Name ), dimensionOf<Permeability>() },
+                  { std::string( FundamentalUnit<MolarEnergy>::Name ), dimensionOf<MolarEnergy>() },
+                  { std::string( FundamentalUnit<MolarEntropy>::Name ), dimensionOf<MolarEntropy>() },
+                  { std::string( FundamentalUnit<Exposure>::Name ), dimensionOf<Exposure>() },
+                  { std::string( FundamentalUnit<AbsorbedDoseRate>::Name ), dimensionOf<AbsorbedDoseRate>() },
+                  { std::string( FundamentalUnit<CatalyticConcentration>::Name ), dimensionOf<CatalyticConcentration>() },
+                  { std::string( FundamentalUnit<Speed>::Name ), dimensionOf<Speed>() },
+                  { std::string( FundamentalUnit<Acceleration>::Name ), dimensionOf<Acceleration>() }
+              };
+
+        double value ;
+        if( ! from_string( input_val_unit, &value ) ) {
+            return false;
+        }
+
+        // from_string() already validated the format "<value> <unit>"
+        std::stringstream ss(input_val_unit);
+        std::string unit;
+        ss >> unit >> unit;
+        for(const auto& unit_ : UNITS ) {
+            if( unit_.first.compare(unit) == 0) {
+                *quantity = DynamicQuantity( value, unit_.second );
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* DYNAMICQUANTITY_HPP_ */
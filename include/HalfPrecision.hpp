@@ -0,0 +1,404 @@
+/*
+ * HalfPrecision.hpp
+ *
+ *      16-bit storage of quantities in IEEE half precision (fp16) or
+ *      bfloat16 for large feature stores. StoredQuantity<Q, Format> keeps
+ *      the quantity type and two bytes of bits; it has no arithmetic and
+ *      is converted back to Q, or to float, to compute. Bulk conversions
+ *      use F16C or AVX-512F for fp16 and SSE2/AVX integer code for
+ *      bfloat16 where available, and a bit exact scalar version otherwise.
+ *      Values are rounded to float and then to nearest even.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef HALFPRECISION_HPP_
+#define HALFPRECISION_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    namespace detail {
+        inline std::uint32_t floatBits( float x ) {
+            std::uint32_t u ;
+            std::memcpy( &u, &x, sizeof(u) ) ;
+            return u;
+        }
+
+        inline float bitsFloat( std::uint32_t u ) {
+            float x ;
+            std::memcpy( &x, &u, sizeof(x) ) ;
+            return x;
+        }
+    }
+    // namespace detail;
+
+    /**
+     * IEEE 754 binary16: 5 exponent and 10 mantissa bits, largest finite
+     * value 65504, normal down to 6.1e-5 and subnormal down to 6e-8.
+     */
+    struct Float16 {
+        /**
+         * Round to nearest even; overflow gives infinity and NaN a quiet
+         * NaN.
+         */
+        static std::uint16_t encode( float x ) {
+            std::uint32_t u = detail::floatBits( x ) ;
+            const std::uint32_t sign = ( u >> 16 ) & 0x8000 ;
+            u &= 0x7FFFFFFF ;
+            std::uint32_t h ;
+            if( u >= 0x47800000 ) {
+                // At least 2^16, infinity or NaN
+                h = u > 0x7F800000 ? 0x7E00 : 0x7C00 ;
+            } else if( u < 0x38800000 ) {
+                // Below 2^-14: adding 0.5 aligns the subnormal mantissa and
+                // rounds it in the FPU
+                h = detail::floatBits( detail::bitsFloat( u ) + 0.5f ) - 0x3F000000 ;
+            } else {
+                // Rebias the exponent and round the 13 dropped bits, which
+                // may carry into the exponent up to infinity
+                u += 0xC8000FFF + ( ( u >> 13 ) & 1 ) ;
+                h = u >> 13 ;
+            }
+            return std::uint16_t( sign | h );
+        }
+
+        static float decode( std::uint16_t h ) {
+            std::uint32_t u = std::uint32_t( h & 0x7FFF ) << 13 ;
+            const std::uint32_t exponent = u & 0x0F800000 ;
+            u += 0x38000000 ;
+            if( exponent == 0x0F800000 ) {
+                // Infinity or NaN
+                u += 0x38000000 ;
+            } else if( exponent == 0 ) {
+                // Zero or subnormal: renormalize in the FPU
+                u = detail::floatBits( detail::bitsFloat( u + 0x00800000 ) - detail::bitsFloat( 0x38800000 ) ) ;
+            }
+            return detail::bitsFloat( u | std::uint32_t( h & 0x8000 ) << 16 );
+        }
+
+        static void encode( const float * x, std::size_t n, std::uint16_t * out ) {
+            std::size_t i = 0 ;
+#if defined(__AVX512F__)
+            for( ; i + 16 <= n; i += 16 ) {
+                _mm256_storeu_si256( reinterpret_cast<__m256i *>( out + i ),
+                                     _mm512_cvtps_ph( _mm512_loadu_ps( x + i ), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) ) ;
+            }
+#endif
+#if defined(__F16C__) && defined(__AVX__)
+            for( ; i + 8 <= n; i += 8 ) {
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ),
+                                  _mm256_cvtps_ph( _mm256_loadu_ps( x + i ), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = encode( x[i] ) ;
+            }
+        }
+
+        static void encode( const double * x, std::size_t n, std::uint16_t * out ) {
+            std::size_t i = 0 ;
+#if defined(__AVX512F__)
+            for( ; i + 16 <= n; i += 16 ) {
+                const __m256d lo = _mm256_castps_pd( _mm512_cvtpd_ps( _mm512_loadu_pd( x + i ) ) ) ;
+                const __m256d hi = _mm256_castps_pd( _mm512_cvtpd_ps( _mm512_loadu_pd( x + i + 8 ) ) ) ;
+                const __m512 v = _mm512_castpd_ps( _mm512_insertf64x4( _mm512_castpd256_pd512( lo ), hi, 1 ) ) ;
+                _mm256_storeu_si256( reinterpret_cast<__m256i *>( out + i ),
+                                     _mm512_cvtps_ph( v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) ) ;
+            }
+#endif
+#if defined(__F16C__) && defined(__AVX__)
+            for( ; i + 8 <= n; i += 8 ) {
+                const __m256 v = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm256_cvtpd_ps( _mm256_loadu_pd( x + i ) ) ),
+                                                       _mm256_cvtpd_ps( _mm256_loadu_pd( x + i + 4 ) ), 1 ) ;
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ),
+                                  _mm256_cvtps_ph( v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = encode( float( x[i] ) ) ;
+            }
+        }
+
+        static void decode( const std::uint16_t * h, std::size_t n, float * out ) {
+            std::size_t i = 0 ;
+#if defined(__AVX512F__)
+            for( ; i + 16 <= n; i += 16 ) {
+                _mm512_storeu_ps( out + i, _mm512_cvtph_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i *>( h + i ) ) ) ) ;
+            }
+#endif
+#if defined(__F16C__) && defined(__AVX__)
+            for( ; i + 8 <= n; i += 8 ) {
+                _mm256_storeu_ps( out + i, _mm256_cvtph_ps( _mm_loadu_si128( reinterpret_cast<const __m128i *>( h + i ) ) ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = decode( h[i] ) ;
+            }
+        }
+
+        static void decode( const std::uint16_t * h, std::size_t n, double * out ) {
+            std::size_t i = 0 ;
+#if defined(__AVX512F__)
+            for( ; i + 16 <= n; i += 16 ) {
+                const __m512 v = _mm512_cvtph_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i *>( h + i ) ) ) ;
+                _mm512_storeu_pd( out + i, _mm512_cvtps_pd( _mm512_castps512_ps256( v ) ) ) ;
+                _mm512_storeu_pd( out + i + 8, _mm512_cvtps_pd( _mm256_castpd_ps( _mm512_extractf64x4_pd( _mm512_castps_pd( v ), 1 ) ) ) ) ;
+            }
+#endif
+#if defined(__F16C__) && defined(__AVX__)
+            for( ; i + 8 <= n; i += 8 ) {
+                const __m256 v = _mm256_cvtph_ps( _mm_loadu_si128( reinterpret_cast<const __m128i *>( h + i ) ) ) ;
+                _mm256_storeu_pd( out + i, _mm256_cvtps_pd( _mm256_castps256_ps128( v ) ) ) ;
+                _mm256_storeu_pd( out + i + 4, _mm256_cvtps_pd( _mm256_extractf128_ps( v, 1 ) ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = double( decode( h[i] ) ) ;
+            }
+        }
+    } ;
+
+    /**
+     * bfloat16: the upper half of a float, with its exponent range (up to
+     * 3.4e38) and 8 significant bits, about two decimal digits.
+     */
+    struct BFloat16 {
+        /**
+         * Round to nearest even; NaN stays a quiet NaN.
+         */
+        static std::uint16_t encode( float x ) {
+            const std::uint32_t u = detail::floatBits( x ) ;
+            if( ( u & 0x7FFFFFFF ) > 0x7F800000 ) {
+                return std::uint16_t( u >> 16 | 0x0040 );
+            }
+            return std::uint16_t( ( u + 0x7FFF + ( ( u >> 16 ) & 1 ) ) >> 16 );
+        }
+
+        static float decode( std::uint16_t h ) {
+            return detail::bitsFloat( std::uint32_t( h ) << 16 );
+        }
+
+        static void encode( const float * x, std::size_t n, std::uint16_t * out ) {
+            std::size_t i = 0 ;
+#if defined(__SSE2__)
+            for( ; i + 8 <= n; i += 8 ) {
+                const __m128i lo = roundLanes( _mm_castps_si128( _mm_loadu_ps( x + i ) ) ) ;
+                const __m128i hi = roundLanes( _mm_castps_si128( _mm_loadu_ps( x + i + 4 ) ) ) ;
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ), _mm_packs_epi32( lo, hi ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = encode( x[i] ) ;
+            }
+        }
+
+        static void encode( const double * x, std::size_t n, std::uint16_t * out ) {
+            std::size_t i = 0 ;
+#if defined(__AVX__)
+            for( ; i + 8 <= n; i += 8 ) {
+                const __m128i lo = roundLanes( _mm_castps_si128( _mm256_cvtpd_ps( _mm256_loadu_pd( x + i ) ) ) ) ;
+                const __m128i hi = roundLanes( _mm_castps_si128( _mm256_cvtpd_ps( _mm256_loadu_pd( x + i + 4 ) ) ) ) ;
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ), _mm_packs_epi32( lo, hi ) ) ;
+            }
+#elif defined(__SSE2__)
+            for( ; i + 8 <= n; i += 8 ) {
+                __m128 f[2] ;
+                for( int k = 0; k < 2; ++k ) {
+                    f[k] = _mm_movelh_ps( _mm_cvtpd_ps( _mm_loadu_pd( x + i + 4 * k ) ),
+                                          _mm_cvtpd_ps( _mm_loadu_pd( x + i + 4 * k + 2 ) ) ) ;
+                }
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ),
+                                  _mm_packs_epi32( roundLanes( _mm_castps_si128( f[0] ) ), roundLanes( _mm_castps_si128( f[1] ) ) ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = encode( float( x[i] ) ) ;
+            }
+        }
+
+        static void decode( const std::uint16_t * h, std::size_t n, float * out ) {
+            std::size_t i = 0 ;
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128() ;
+            for( ; i + 8 <= n; i += 8 ) {
+                const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i *>( h + i ) ) ;
+                _mm_storeu_ps( out + i, _mm_castsi128_ps( _mm_unpacklo_epi16( zero, v ) ) ) ;
+                _mm_storeu_ps( out + i + 4, _mm_castsi128_ps( _mm_unpackhi_epi16( zero, v ) ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = decode( h[i] ) ;
+            }
+        }
+
+        static void decode( const std::uint16_t * h, std::size_t n, double * out ) {
+            std::size_t i = 0 ;
+#if defined(__AVX__)
+            const __m128i zero = _mm_setzero_si128() ;
+            for( ; i + 8 <= n; i += 8 ) {
+                const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i *>( h + i ) ) ;
+                _mm256_storeu_pd( out + i, _mm256_cvtps_pd( _mm_castsi128_ps( _mm_unpacklo_epi16( zero, v ) ) ) ) ;
+                _mm256_storeu_pd( out + i + 4, _mm256_cvtps_pd( _mm_castsi128_ps( _mm_unpackhi_epi16( zero, v ) ) ) ) ;
+            }
+#elif defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128() ;
+            for( ; i + 8 <= n; i += 8 ) {
+                const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i *>( h + i ) ) ;
+                const __m128 lo = _mm_castsi128_ps( _mm_unpacklo_epi16( zero, v ) ) ;
+                const __m128 hi = _mm_castsi128_ps( _mm_unpackhi_epi16( zero, v ) ) ;
+                _mm_storeu_pd( out + i, _mm_cvtps_pd( lo ) ) ;
+                _mm_storeu_pd( out + i + 2, _mm_cvtps_pd( _mm_movehl_ps( lo, lo ) ) ) ;
+                _mm_storeu_pd( out + i + 4, _mm_cvtps_pd( hi ) ) ;
+                _mm_storeu_pd( out + i + 6, _mm_cvtps_pd( _mm_movehl_ps( hi, hi ) ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = double( decode( h[i] ) ) ;
+            }
+        }
+
+    private:
+#if defined(__SSE2__)
+        /**
+         * encode() on four floats, leaving the result in the low half of
+         * each lane, sign extended so that a signed pack keeps the bits.
+         */
+        static __m128i roundLanes( __m128i u ) {
+            const __m128i one = _mm_set1_epi32( 1 ) ;
+            const __m128i odd = _mm_and_si128( _mm_srli_epi32( u, 16 ), one ) ;
+            const __m128i rounded = _mm_srai_epi32( _mm_add_epi32( u, _mm_add_epi32( _mm_set1_epi32( 0x7FFF ), odd ) ), 16 ) ;
+            const __m128i quiet = _mm_srai_epi32( _mm_or_si128( u, _mm_set1_epi32( 0x00400000 ) ), 16 ) ;
+            const __m128i magnitude = _mm_and_si128( u, _mm_set1_epi32( 0x7FFFFFFF ) ) ;
+            const __m128i nan = _mm_cmpgt_epi32( magnitude, _mm_set1_epi32( 0x7F800000 ) ) ;
+            return _mm_or_si128( _mm_and_si128( nan, quiet ), _mm_andnot_si128( nan, rounded ) );
+        }
+#endif
+    } ;
+
+    /**
+     * A Q stored in 16 bits in the given Format (Float16 or BFloat16).
+     * Arrays of it take a quarter of the memory of arrays of Q; convert
+     * them with pack() and unpack() to compute. The quantity type is kept,
+     * so a stored Speed can only be unpacked to a Speed.
+     *
+     * \code
+     * std::vector<HalfQuantity<Speed>> features = pack<Float16>( speeds ) ;
+     * std::vector<Speed> restored = unpack( features ) ;
+     * \endcode
+     */
+    template<typename Q, typename Format = Float16>
+    class StoredQuantity {
+    public:
+        using QuantityType = Q ;
+        using FormatType = Format ;
+
+        constexpr StoredQuantity()
+        : data( 0 ) {
+        }
+
+        explicit StoredQuantity( const Q& x )
+        : data( Format::encode( float( x.getValue() ) ) ) {
+        }
+
+        static constexpr StoredQuantity fromBits( std::uint16_t bits ) {
+            return StoredQuantity( bits, 0 );
+        }
+
+        constexpr std::uint16_t bits() const {
+            return data;
+        }
+
+        Q value() const {
+            return Q( double( Format::decode( data ) ) );
+        }
+
+        operator Q() const {
+            return value();
+        }
+
+    private:
+        constexpr StoredQuantity( std::uint16_t bits, int )
+        : data( bits ) {
+        }
+
+        std::uint16_t data ;
+    } ;
+
+    template<typename Q>
+    using HalfQuantity = StoredQuantity<Q, Float16> ;
+
+    template<typename Q>
+    using BFloat16Quantity = StoredQuantity<Q, BFloat16> ;
+
+    namespace detail {
+        template<typename Q, typename Format>
+        std::uint16_t * storageBits( StoredQuantity<Q, Format> * x ) {
+            static_assert( sizeof(StoredQuantity<Q, Format>) == sizeof(std::uint16_t),
+                           "StoredQuantity must be layout compatible with std::uint16_t" );
+            return reinterpret_cast<std::uint16_t *>( x );
+        }
+
+        template<typename Q, typename Format>
+        const std::uint16_t * storageBits( const StoredQuantity<Q, Format> * x ) {
+            static_assert( sizeof(StoredQuantity<Q, Format>) == sizeof(std::uint16_t),
+                           "StoredQuantity must be layout compatible with std::uint16_t" );
+            return reinterpret_cast<const std::uint16_t *>( x );
+        }
+    }
+    // namespace detail;
+
+    /**
+     * Convert \c n quantities to 16-bit storage.
+     */
+    template<typename Q, typename Format>
+    void pack( const Q * x, std::size_t n, StoredQuantity<Q, Format> * out ) {
+        static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+        Format::encode( reinterpret_cast<const double *>( x ), n, detail::storageBits( out ) ) ;
+    }
+
+    /**
+     * Convert \c n stored values back to quantities.
+     */
+    template<typename Q, typename Format>
+    void unpack( const StoredQuantity<Q, Format> * x, std::size_t n, Q * out ) {
+        static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+        Format::decode( detail::storageBits( x ), n, reinterpret_cast<double *>( out ) ) ;
+    }
+
+    /**
+     * Convert \c n stored values to floats in the SI unit of Q, for
+     * computations in single precision.
+     */
+    template<typename Q, typename Format>
+    void unpack( const StoredQuantity<Q, Format> * x, std::size_t n, float * out ) {
+        Format::decode( detail::storageBits( x ), n, out ) ;
+    }
+
+    template<typename Format, typename Q>
+    std::vector<StoredQuantity<Q, Format>> pack( const std::vector<Q>& values ) {
+        std::vector<StoredQuantity<Q, Format>> out( values.size() ) ;
+        pack( values.data(), values.size(), out.data() ) ;
+        return out;
+    }
+
+    template<typename Q, typename Format>
+    std::vector<Q> unpack( const std::vector<StoredQuantity<Q, Format>>& stored ) {
+        std::vector<Q> out( stored.size() ) ;
+        unpack( stored.data(), stored.size(), out.data() ) ;
+        return out;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* HALFPRECISION_HPP_ */
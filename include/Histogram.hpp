@@ -0,0 +1,359 @@
+/*
+ * Histogram.hpp
+ *
+ *      Histograms of quantity samples with typed bin edges. On uniform
+ *      bins the bin of a block of samples is computed with branch-free
+ *      SSE2/AVX code; explicit edges are searched with the branch-free
+ *      upper_bound() of Sort.hpp. Large arrays are binned in blocks on the
+ *      thread pool, each into a private histogram, which are merged at the
+ *      end. Bin centers and widths have the type of the samples, densities
+ *      the inverse type.
+ *      Link with the platform thread library (-pthread).
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef HISTOGRAM_HPP_
+#define HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "ScientificQuantities.hpp"
+#include "Parallel.hpp"
+#include "Sort.hpp"
+
+namespace SciQ {
+
+    /**
+     * Arrays of at least this many samples are binned in blocks on the
+     * thread pool.
+     */
+    constexpr std::size_t PARALLEL_HISTOGRAM_SIZE = std::size_t( 1 ) << 18 ;
+
+    namespace detail {
+        /**
+         * Number of samples whose bins are computed at once; small enough
+         * for the L1 cache.
+         */
+        constexpr std::size_t HISTOGRAM_BLOCK = 1024 ;
+
+        /**
+         * Slot of a sample on uniform bins: 0 below the first bin, 1 to
+         * \c bins for the bins, bins + 1 at and above the last edge and
+         * bins + 2 for NaN. \c t is the position in units of bins,
+         * ( x - low ) * scale, which is clamped to [-1, bins] and shifted
+         * by one so that truncation rounds down.
+         */
+        inline std::uint32_t uniformSlot( double t, double bins ) {
+            return t != t ? std::uint32_t( bins ) + 2 : std::uint32_t( std::min( std::max( t, -1.0 ), bins ) + 1.0 );
+        }
+
+        inline void uniformSlots( const double * x, std::size_t n, double low, double scale, double bins,
+                                  std::uint32_t * slots ) {
+            std::size_t i = 0 ;
+#if defined(__AVX__)
+            const __m256d vlow = _mm256_set1_pd( low ) ;
+            const __m256d vscale = _mm256_set1_pd( scale ) ;
+            const __m256d below = _mm256_set1_pd( -1.0 ) ;
+            const __m256d above = _mm256_set1_pd( bins ) ;
+            const __m256d missing = _mm256_set1_pd( bins + 1.0 ) ;
+            const __m256d one = _mm256_set1_pd( 1.0 ) ;
+            for( ; i + 4 <= n; i += 4 ) {
+                __m256d t = _mm256_mul_pd( _mm256_sub_pd( _mm256_loadu_pd( x + i ), vlow ), vscale ) ;
+                // Both return their second operand if one is NaN
+                t = _mm256_min_pd( above, _mm256_max_pd( below, t ) ) ;
+                t = _mm256_blendv_pd( missing, t, _mm256_cmp_pd( t, t, _CMP_ORD_Q ) ) ;
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( slots + i ), _mm256_cvttpd_epi32( _mm256_add_pd( t, one ) ) ) ;
+            }
+#elif defined(__SSE2__)
+            const __m128d vlow = _mm_set1_pd( low ) ;
+            const __m128d vscale = _mm_set1_pd( scale ) ;
+            const __m128d below = _mm_set1_pd( -1.0 ) ;
+            const __m128d above = _mm_set1_pd( bins ) ;
+            const __m128d missing = _mm_set1_pd( bins + 1.0 ) ;
+            const __m128d one = _mm_set1_pd( 1.0 ) ;
+            for( ; i + 4 <= n; i += 4 ) {
+                __m128d t0 = _mm_mul_pd( _mm_sub_pd( _mm_loadu_pd( x + i ), vlow ), vscale ) ;
+                __m128d t1 = _mm_mul_pd( _mm_sub_pd( _mm_loadu_pd( x + i + 2 ), vlow ), vscale ) ;
+                t0 = _mm_min_pd( above, _mm_max_pd( below, t0 ) ) ;
+                t1 = _mm_min_pd( above, _mm_max_pd( below, t1 ) ) ;
+                const __m128d ordered0 = _mm_cmpord_pd( t0, t0 ) ;
+                const __m128d ordered1 = _mm_cmpord_pd( t1, t1 ) ;
+                t0 = _mm_or_pd( _mm_and_pd( ordered0, t0 ), _mm_andnot_pd( ordered0, missing ) ) ;
+                t1 = _mm_or_pd( _mm_and_pd( ordered1, t1 ), _mm_andnot_pd( ordered1, missing ) ) ;
+                const __m128i k = _mm_unpacklo_epi64( _mm_cvttpd_epi32( _mm_add_pd( t0, one ) ),
+                                                      _mm_cvttpd_epi32( _mm_add_pd( t1, one ) ) ) ;
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( slots + i ), k ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                slots[i] = uniformSlot( ( x[i] - low ) * scale, bins ) ;
+            }
+        }
+    }
+    // namespace detail;
+
+    /**
+     * Histogram of samples of the quantity Q. Bins are half-open, [lower,
+     * upper); samples below the first edge count as underflow, samples at
+     * or above the last edge as overflow and NaNs as missing.
+     *
+     * \code
+     * Histogram<Speed> h( 0_mps, 40_mps, 80 ) ;
+     * h.add( speeds ) ;
+     * Speed mode = h.center( h.maximum() ) ;
+     * \endcode
+     */
+    template<typename Q>
+    class Histogram {
+    public:
+        using DensityType = decltype( 1.0 / std::declval<Q>() ) ;
+
+        /**
+         * \c n bins of equal width from \c from to \c to. A sample x falls
+         * into bin floor( ( x - from ) * n / ( to - from ) ), so
+         * samples within rounding of an edge may fall on either side.
+         */
+        Histogram( const Q& from, const Q& to, std::size_t n )
+        : isUniform( true ), low( from.getValue() ), scale( 0.0 ) {
+            if( !( from < to ) || n == 0 || n > ( std::size_t( 1 ) << 30 ) ) {
+                throw std::invalid_argument( "Histogram needs low < high and 1 to 2^30 bins" );
+            }
+            scale = double( n ) / ( to.getValue() - low ) ;
+            const double step = ( to.getValue() - low ) / double( n ) ;
+            for( std::size_t i = 0; i < n; ++i ) {
+                edges.push_back( Q( low + double( i ) * step ) ) ;
+            }
+            edges.push_back( to ) ;
+            counts.assign( n + 3, 0 ) ;
+        }
+
+        /**
+         * Bins between the given edges, which must increase strictly.
+         */
+        explicit Histogram( std::vector<Q> binEdges )
+        : isUniform( false ), low( 0.0 ), scale( 0.0 ), edges( std::move( binEdges ) ) {
+            if( edges.size() < 2 || edges.size() > ( std::size_t( 1 ) << 30 ) ) {
+                throw std::invalid_argument( "Histogram needs 2 to 2^30 edges" );
+            }
+            for( std::size_t i = 1; i < edges.size(); ++i ) {
+                if( !( edges[i - 1] < edges[i] ) ) {
+                    throw std::invalid_argument( "Histogram edges must increase strictly" );
+                }
+            }
+            counts.assign( edges.size() + 2, 0 ) ;
+        }
+
+        std::size_t bins() const {
+            return edges.size() - 1;
+        }
+
+        bool uniform() const {
+            return isUniform;
+        }
+
+        /**
+         * Edge \c i, from 0 to bins().
+         */
+        const Q& edge( std::size_t i ) const {
+            return edges[i];
+        }
+
+        Q center( std::size_t bin ) const {
+            return Q( 0.5 * ( edges[bin].getValue() + edges[bin + 1].getValue() ) );
+        }
+
+        Q width( std::size_t bin ) const {
+            return Q( edges[bin + 1].getValue() - edges[bin].getValue() );
+        }
+
+        std::vector<Q> centers() const {
+            std::vector<Q> c ;
+            for( std::size_t i = 0; i < bins(); ++i ) {
+                c.push_back( center( i ) ) ;
+            }
+            return c;
+        }
+
+        std::vector<Q> widths() const {
+            std::vector<Q> w ;
+            for( std::size_t i = 0; i < bins(); ++i ) {
+                w.push_back( width( i ) ) ;
+            }
+            return w;
+        }
+
+        std::uint64_t count( std::size_t bin ) const {
+            return counts[bin + 1];
+        }
+
+        std::uint64_t underflow() const {
+            return counts[0];
+        }
+
+        std::uint64_t overflow() const {
+            return counts[bins() + 1];
+        }
+
+        std::uint64_t missing() const {
+            return counts[bins() + 2];
+        }
+
+        /**
+         * Number of samples that are not NaN, including under- and
+         * overflow.
+         */
+        std::uint64_t total() const {
+            std::uint64_t n = 0 ;
+            for( std::size_t s = 0; s < bins() + 2; ++s ) {
+                n += counts[s] ;
+            }
+            return n;
+        }
+
+        /**
+         * Fraction of the samples in \c bin divided by its width, which
+         * integrates to one over the bins if there is no under- or
+         * overflow.
+         */
+        DensityType density( std::size_t bin ) const {
+            const std::uint64_t n = total() ;
+            return n == 0 ? DensityType( 0.0 ) : DensityType( double( count( bin ) ) / double( n ) / width( bin ).getValue() );
+        }
+
+        /**
+         * Bin with the most samples, the first of several.
+         */
+        std::size_t maximum() const {
+            return std::size_t( std::max_element( counts.begin() + 1, counts.begin() + 1 + bins() ) - counts.begin() - 1 );
+        }
+
+        void add( const Q& x ) {
+            ++counts[slot( x.getValue() )] ;
+        }
+
+        /**
+         * Add \c n samples, on the thread pool for at least
+         * PARALLEL_HISTOGRAM_SIZE samples.
+         */
+        void add( const Q * x, std::size_t n, parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+            static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+            const double * v = reinterpret_cast<const double *>( x ) ;
+            if( n < PARALLEL_HISTOGRAM_SIZE || pool.size() == 1 ) {
+                tally( v, n, counts ) ;
+                return;
+            }
+            const std::size_t blocks = 4 * pool.size() ;
+            const std::size_t block = ( n + blocks - 1 ) / blocks ;
+            std::vector<std::vector<std::uint64_t>> partial( blocks ) ;
+            pool.parallelFor( 0, blocks, 1, [&]( std::size_t b, std::size_t e ) {
+                for( std::size_t k = b; k < e; ++k ) {
+                    const std::size_t first = std::min( n, k * block ) ;
+                    partial[k].assign( counts.size(), 0 ) ;
+                    tally( v + first, std::min( n, first + block ) - first, partial[k] ) ;
+                }
+            } ) ;
+            for( const auto& p : partial ) {
+                for( std::size_t s = 0; s < counts.size(); ++s ) {
+                    counts[s] += p[s] ;
+                }
+            }
+        }
+
+        void add( const std::vector<Q>& x, parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+            add( x.data(), x.size(), pool ) ;
+        }
+
+        /**
+         * Add the counts of a histogram with the same edges.
+         */
+        Histogram& operator+=( const Histogram& rhs ) {
+            if( rhs.edges.size() != edges.size() || !std::equal( edges.begin(), edges.end(), rhs.edges.begin(),
+                    []( const Q& a, const Q& b ) { return a.getValue() == b.getValue(); } ) ) {
+                throw std::invalid_argument( "Histograms with different edges cannot be merged" );
+            }
+            for( std::size_t s = 0; s < counts.size(); ++s ) {
+                counts[s] += rhs.counts[s] ;
+            }
+            return *this;
+        }
+
+        void clear() {
+            std::fill( counts.begin(), counts.end(), 0 ) ;
+        }
+
+    private:
+        /**
+         * Slot of \c x in counts: underflow, the bins, overflow, missing.
+         */
+        std::size_t slot( double x ) const {
+            if( isUniform ) {
+                return detail::uniformSlot( ( x - low ) * scale, double( bins() ) );
+            }
+            return x != x ? bins() + 2 : upper_bound( edges, Q( x ) );
+        }
+
+        /**
+         * Add the samples to \c out. The slots of a block of samples are
+         * computed first; they are then counted into four copies of the
+         * counters in turn, so that runs of samples in the same bin do
+         * not wait for each other's increments.
+         */
+        void tally( const double * x, std::size_t n, std::vector<std::uint64_t>& out ) const {
+            const std::size_t slots = counts.size() ;
+            if( n < 4 * slots ) {
+                for( std::size_t i = 0; i < n; ++i ) {
+                    ++out[slot( x[i] )] ;
+                }
+                return;
+            }
+            std::vector<std::uint64_t> copies( 4 * slots, 0 ) ;
+            std::uint64_t * c0 = copies.data() ;
+            std::uint64_t * c1 = c0 + slots ;
+            std::uint64_t * c2 = c1 + slots ;
+            std::uint64_t * c3 = c2 + slots ;
+            std::uint32_t s[detail::HISTOGRAM_BLOCK] ;
+            for( std::size_t first = 0; first < n; first += detail::HISTOGRAM_BLOCK ) {
+                const std::size_t m = std::min( n - first, detail::HISTOGRAM_BLOCK ) ;
+                if( isUniform ) {
+                    detail::uniformSlots( x + first, m, low, scale, double( bins() ), s ) ;
+                } else {
+                    for( std::size_t i = 0; i < m; ++i ) {
+                        s[i] = std::uint32_t( slot( x[first + i] ) ) ;
+                    }
+                }
+                std::size_t i = 0 ;
+                for( ; i + 4 <= m; i += 4 ) {
+                    ++c0[s[i]] ;
+                    ++c1[s[i + 1]] ;
+                    ++c2[s[i + 2]] ;
+                    ++c3[s[i + 3]] ;
+                }
+                for( ; i < m; ++i ) {
+                    ++c0[s[i]] ;
+                }
+            }
+            for( std::size_t k = 0; k < slots; ++k ) {
+                out[k] += c0[k] + c1[k] + c2[k] + c3[k] ;
+            }
+        }
+
+        bool isUniform ;
+        double low ;
+        double scale ;
+        std::vector<Q> edges ;
+        std::vector<std::uint64_t> counts ;     // Underflow, bins, overflow, missing
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* HISTOGRAM_HPP_ */
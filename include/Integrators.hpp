@@ -0,0 +1,317 @@
+/*
+ * Integrators.hpp
+ *
+ *      Explicit ODE integrators (Euler, classic Runge-Kutta and adaptive
+ *      Dormand-Prince RK45) for states made of Quantity<> values. The state
+ *      is either a single Quantity<> or a StateVector<>; its time derivative
+ *      has the type decltype(State()/Time()), so integrating a Speed yields a
+ *      Length without any explicit conversion.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef INTEGRATORS_HPP_
+#define INTEGRATORS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Matrix.hpp"
+
+namespace SciQ {
+
+    /**
+     * Type of the time derivative of the state S.
+     */
+    template<typename S>
+    using DerivativeOf = decltype( S() / Time() ) ;
+
+    /**
+     * Access to the values of a state in its fundamental SI units. A state
+     * is either a Quantity<> (one value) or a StateVector<>.
+     */
+    template<typename S>
+    struct StateTraits
+    {} ;
+
+    template<class L, class M, class T, class EC, class TT, class AS, class LI>
+    struct StateTraits<Quantity<L, M, T, EC, TT, AS, LI>> {
+        using Type = Quantity<L, M, T, EC, TT, AS, LI> ;
+        static constexpr std::size_t SIZE = 1 ;
+
+        static Type load( const double * p, std::size_t ) {
+            return Type( p[0] );
+        }
+
+        static void store( const Type& x, double * p, std::size_t ) {
+            p[0] = x.getValue() ;
+        }
+    } ;
+
+    template<typename... Qs>
+    struct StateTraits<StateVector<Qs...>> {
+        using Type = StateVector<Qs...> ;
+        static constexpr std::size_t SIZE = sizeof...(Qs) ;
+
+        static Type load( const double * p, std::size_t stride ) {
+            Type x ;
+            for( std::size_t c = 0; c < SIZE; ++c ) {
+                x.data()[c] = p[c * stride] ;
+            }
+            return x;
+        }
+
+        static void store( const Type& x, double * p, std::size_t stride ) {
+            for( std::size_t c = 0; c < SIZE; ++c ) {
+                p[c * stride] = x.data()[c] ;
+            }
+        }
+    } ;
+
+    //
+    // Single steps. The derivative function is called as f( t, x ) and must
+    // return a DerivativeOf<S>.
+    //
+
+    /**
+     * One explicit Euler step from \c t to \c t + \c dt.
+     */
+    template<typename S, typename F>
+    S eulerStep( F f, const Time& t, const S& x, const Time& dt ) {
+        return x + f( t, x ) * dt;
+    }
+
+    /**
+     * One step of the classic fourth order Runge-Kutta method.
+     */
+    template<typename S, typename F>
+    S rk4Step( F f, const Time& t, const S& x, const Time& dt ) {
+        const Time half = dt * 0.5 ;
+        const DerivativeOf<S> k1 = f( t, x ) ;
+        const DerivativeOf<S> k2 = f( t + half, x + k1 * half ) ;
+        const DerivativeOf<S> k3 = f( t + half, x + k2 * half ) ;
+        const DerivativeOf<S> k4 = f( t + dt, x + k3 * dt ) ;
+        return x + ( k1 + k2 * 2.0 + k3 * 2.0 + k4 ) * ( dt / 6.0 );
+    }
+
+    /**
+     * One step of the Dormand-Prince 5(4) method. Returns the fifth order
+     * solution and stores the difference to the embedded fourth order
+     * solution, an estimate of the local error, in \c error.
+     */
+    template<typename S, typename F>
+    S rk45Step( F f, const Time& t, const S& x, const Time& dt, S * error ) {
+        using D = DerivativeOf<S> ;
+        const D k1 = f( t, x ) ;
+        const D k2 = f( t + dt * (1.0/5), x + k1 * ( dt * (1.0/5) ) ) ;
+        const D k3 = f( t + dt * (3.0/10), x + ( k1 * (3.0/40) + k2 * (9.0/40) ) * dt ) ;
+        const D k4 = f( t + dt * (4.0/5), x + ( k1 * (44.0/45) - k2 * (56.0/15) + k3 * (32.0/9) ) * dt ) ;
+        const D k5 = f( t + dt * (8.0/9), x + ( k1 * (19372.0/6561) - k2 * (25360.0/2187) + k3 * (64448.0/6561)
+                                               - k4 * (212.0/729) ) * dt ) ;
+        const D k6 = f( t + dt, x + ( k1 * (9017.0/3168) - k2 * (355.0/33) + k3 * (46732.0/5247)
+                                     + k4 * (49.0/176) - k5 * (5103.0/18656) ) * dt ) ;
+        const S x5 = x + ( k1 * (35.0/384) + k3 * (500.0/1113) + k4 * (125.0/192) - k5 * (2187.0/6784)
+                           + k6 * (11.0/84) ) * dt ;
+        const D k7 = f( t + dt, x5 ) ;
+        *error = ( k1 * (71.0/57600) - k3 * (71.0/16695) + k4 * (71.0/1920) - k5 * (17253.0/339200)
+                   + k6 * (22.0/525) - k7 * (1.0/40) ) * dt ;
+        return x5;
+    }
+
+    /**
+     * Integration method of the fixed step integrate().
+     */
+    enum class IntegrationMethod {
+        Euler,
+        RK4
+    } ;
+
+    /**
+     * Integrate from \c t0 to \c t1 with a fixed step of (at most) \c dt.
+     * The last step is shortened to end exactly at \c t1. No memory is
+     * allocated. Throws std::invalid_argument unless t0 <= t1, dt > 0 and
+     * the number of steps is finite and fits into std::size_t.
+     */
+    template<typename S, typename F>
+    S integrate( F f, Time t0, S x, const Time& t1, const Time& dt,
+                 IntegrationMethod method = IntegrationMethod::RK4 ) {
+        const double count = std::ceil( ( t1 - t0 ).getValue() / dt.getValue() - 1e-9 ) ;
+        // Also false for NaN
+        if( !( dt.getValue() > 0 && t1.getValue() >= t0.getValue() &&
+               count < static_cast<double>( std::numeric_limits<std::size_t>::max() ) ) ) {
+            throw std::invalid_argument( "integrate: need t0 <= t1, dt > 0 and a finite number of steps" );
+        }
+        const std::size_t steps = count > 0 ? static_cast<std::size_t>( count ) : 0 ;
+        const Time h = steps == 0 ? Time() : ( t1 - t0 ) / static_cast<double>( steps ) ;
+        for( std::size_t i = 0; i < steps; ++i ) {
+            x = method == IntegrationMethod::Euler ? eulerStep( f, t0, x, h ) : rk4Step( f, t0, x, h ) ;
+            t0 = t0 + h ;
+        }
+        return x;
+    }
+
+    namespace detail {
+        /**
+         * Largest ratio |error| / (atol + rtol * |x|) over the elements of
+         * the state. A step is accepted if the ratio is at most one.
+         */
+        template<typename S>
+        double errorRatio( const S& error, const S& x, const S& atol, double rtol ) {
+            constexpr std::size_t n = StateTraits<S>::SIZE ;
+            std::array<double, n> e, v, a ;
+            StateTraits<S>::store( error, e.data(), 1 ) ;
+            StateTraits<S>::store( x, v.data(), 1 ) ;
+            StateTraits<S>::store( atol, a.data(), 1 ) ;
+            double ratio = 0 ;
+            for( std::size_t c = 0; c < n; ++c ) {
+                ratio = std::max( ratio, std::abs( e[c] ) / ( std::abs( a[c] ) + rtol * std::abs( v[c] ) ) ) ;
+            }
+            return ratio;
+        }
+    }
+
+    /**
+     * Integrate from \c t0 to \c t1 with the adaptive Dormand-Prince 5(4)
+     * method. The step size is adjusted so that the local error of every
+     * element stays below \c atol + \c rtol * |x|, where the absolute
+     * tolerance \c atol has the quantities of the state. \c dt is the initial
+     * step. If \c steps is not null the number of accepted steps is stored
+     * there. Throws std::invalid_argument unless t0 <= t1 and dt > 0, and
+     * std::runtime_error if the step size underflows.
+     */
+    template<typename S, typename F>
+    S integrateAdaptive( F f, Time t0, S x, const Time& t1, const S& atol, double rtol,
+                         Time dt, std::size_t * steps = nullptr ) {
+        // Also false for NaN
+        if( !( dt.getValue() > 0 && t1.getValue() >= t0.getValue() ) ) {
+            throw std::invalid_argument( "integrateAdaptive: need t0 <= t1 and dt > 0" );
+        }
+        std::size_t accepted = 0 ;
+        const Time span = t1 - t0 ;
+        while( t0 < t1 ) {
+            if( t0 + dt > t1 ) {
+                dt = t1 - t0 ;
+            }
+            S error ;
+            const S next = rk45Step( f, t0, x, dt, &error ) ;
+            const double ratio = detail::errorRatio( error, next, atol, rtol ) ;
+            if( ratio <= 1.0 ) {
+                t0 = t0 + dt ;
+                x = next ;
+                ++accepted ;
+            }
+            // Standard step size controller for a fifth order method
+            const double factor = ratio == 0 ? 5.0 : std::min( 5.0, std::max( 0.2, 0.9 * std::pow( ratio, -0.2 ) ) ) ;
+            dt = dt * factor ;
+            if( dt.getValue() <= 1e-14 * span.getValue() && t0 < t1 ) {
+                throw std::runtime_error( "integrateAdaptive: step size underflow" );
+            }
+        }
+        if( steps != nullptr ) {
+            *steps = accepted ;
+        }
+        return x;
+    }
+
+    /**
+     * Advances many independent systems with the same derivative function.
+     * The states are kept in structure-of-arrays layout: element c of system
+     * i is stored at c * size() + i, so each element forms a contiguous
+     * array. The states are allocated on construction; the step functions
+     * are plain loops over the systems that the compiler can vectorize when
+     * the derivative function is inlined.
+     *
+     * \code
+     * BatchIntegrator<StateVector<Length, Speed>> batch( 10000 ) ;
+     * auto f = []( const Time&, const StateVector<Length, Speed>& x ) {
+     *     return DerivativeOf<StateVector<Length, Speed>>( x.get<1>(), x.get<0>() * ( -1.0 / ( 1_s * 1_s ) ) ) ;
+     * } ;
+     * batch.stepRK4( f, 0_s, 0.01_s ) ;
+     * \endcode
+     */
+    template<typename S>
+    class BatchIntegrator {
+    public:
+        using Traits = StateTraits<S> ;
+        using D = DerivativeOf<S> ;
+
+        /**
+         * Number of values of one state.
+         */
+        static constexpr std::size_t STATE_SIZE = Traits::SIZE ;
+
+        explicit BatchIntegrator( std::size_t n )
+        : n( n ), x( STATE_SIZE * n ) {
+        }
+
+        std::size_t size() const {
+            return n;
+        }
+
+        S get( std::size_t i ) const {
+            return Traits::load( x.data() + i, n );
+        }
+
+        void set( std::size_t i, const S& s ) {
+            Traits::store( s, x.data() + i, n ) ;
+        }
+
+        /**
+         * Contiguous array with element \c c of all states.
+         */
+        double * component( std::size_t c ) {
+            return x.data() + c * n;
+        }
+
+        const double * component( std::size_t c ) const {
+            return x.data() + c * n;
+        }
+
+        /**
+         * Advance all systems by one explicit Euler step.
+         */
+        template<typename F>
+        void stepEuler( F f, const Time& t, const Time& dt ) {
+            double * px = x.data() ;
+            for( std::size_t i = 0; i < n; ++i ) {
+                const S s = Traits::load( px + i, n ) ;
+                Traits::store( s + f( t, s ) * dt, px + i, n ) ;
+            }
+        }
+
+        /**
+         * Advance all systems by one classic Runge-Kutta step. All four
+         * stages of a system are evaluated in one iteration, so the states
+         * are read and written only once per step.
+         */
+        template<typename F>
+        void stepRK4( F f, const Time& t, const Time& dt ) {
+            // The stages are spelled out rather than calling rk4Step() so that
+            // the loop body stays small enough to be inlined and vectorized
+            const Time half = dt * 0.5 ;
+            const Time sixth = dt / 6.0 ;
+            double * px = x.data() ;
+            for( std::size_t i = 0; i < n; ++i ) {
+                const S s = Traits::load( px + i, n ) ;
+                const D k1 = f( t, s ) ;
+                const D k2 = f( t + half, s + k1 * half ) ;
+                const D k3 = f( t + half, s + k2 * half ) ;
+                const D k4 = f( t + dt, s + k3 * dt ) ;
+                Traits::store( s + ( k1 + k2 * 2.0 + k3 * 2.0 + k4 ) * sixth, px + i, n ) ;
+            }
+        }
+
+    private:
+        std::size_t n ;
+        std::vector<double> x ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* INTEGRATORS_HPP_ */
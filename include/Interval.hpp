@@ -0,0 +1,700 @@
+/*
+ * Interval.hpp
+ *
+ *      Quantities known only to lie within bounds. Every operation rounds
+ *      the bounds of its result outward, so the true result of the exact
+ *      arithmetic is always enclosed. Comparisons return a Tristate that
+ *      is Unknown when the intervals overlap. IntervalArray<> evaluates
+ *      bounds in bulk with branch-free SSE2/AVX kernels that give the same
+ *      bits as the scalar operators.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef INTERVAL_HPP_
+#define INTERVAL_HPP_
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * Result of comparing intervals: True or False if it holds for all or
+     * for no values within the bounds, Unknown otherwise.
+     */
+    enum class Tristate {
+        False,
+        True,
+        Unknown
+    } ;
+
+    /**
+     * True only if the comparison holds for all values within the bounds.
+     */
+    constexpr bool certainly( Tristate t ) {
+        return t == Tristate::True;
+    }
+
+    /**
+     * True if the comparison holds for some values within the bounds.
+     */
+    constexpr bool possibly( Tristate t ) {
+        return t != Tristate::False;
+    }
+
+    namespace detail {
+    namespace lanes {
+        //
+        // Outward rounding. The rounding mode of the FPU is left at round to
+        // nearest, where a result is off by at most half an ulp, and the
+        // result is moved away by at least one ulp instead: |r| * epsilon
+        // is one ulp or more for normal numbers, the smallest subnormal
+        // covers zero and subnormals and the clamp keeps infinities
+        // infinite. Both need subnormals, i.e. no flush to zero
+        // (-ffast-math).
+        //
+        constexpr double ROUNDING = std::numeric_limits<double>::epsilon() ;
+        constexpr double LARGEST = std::numeric_limits<double>::max() ;
+        constexpr double SMALLEST = std::numeric_limits<double>::denorm_min() ;
+        constexpr double INF = std::numeric_limits<double>::infinity() ;
+
+        // Scalar versions of the vector operations below; min() and max()
+        // return the second operand for NaN as minpd and maxpd do
+        inline double add( double a, double b ) { return a + b; }
+        inline double sub( double a, double b ) { return a - b; }
+        inline double mul( double a, double b ) { return a * b; }
+        inline double div( double a, double b ) { return a / b; }
+        inline double min( double a, double b ) { return a < b ? a : b; }
+        inline double max( double a, double b ) { return a > b ? a : b; }
+
+        inline double down( double r ) {
+            return r - ( min( std::abs( r ) * ROUNDING, LARGEST ) + SMALLEST );
+        }
+
+        inline double up( double r ) {
+            return r + ( min( std::abs( r ) * ROUNDING, LARGEST ) + SMALLEST );
+        }
+
+        /**
+         * a * b, but 0 for 0 * inf: the bound of an entire interval times
+         * zero, whose exact product is zero. NaN operands stay NaN.
+         */
+        inline double product( double a, double b ) {
+            const double p = a * b ;
+            return p != p && a == a && b == b ? 0.0 : p;
+        }
+
+        inline void entireIfZero( double blo, double bhi, double& lo, double& hi ) {
+            if( blo <= 0 && bhi >= 0 ) {
+                lo = -INF ;
+                hi = INF ;
+            }
+        }
+
+#if defined(__AVX__)
+        using Vec = __m256d ;
+        constexpr std::size_t WIDTH = 4 ;
+        inline Vec load( const double * p ) { return _mm256_loadu_pd( p ); }
+        inline void store( double * p, Vec v ) { _mm256_storeu_pd( p, v ) ; }
+        inline Vec set( double x ) { return _mm256_set1_pd( x ); }
+        inline Vec add( Vec a, Vec b ) { return _mm256_add_pd( a, b ); }
+        inline Vec sub( Vec a, Vec b ) { return _mm256_sub_pd( a, b ); }
+        inline Vec mul( Vec a, Vec b ) { return _mm256_mul_pd( a, b ); }
+        inline Vec div( Vec a, Vec b ) { return _mm256_div_pd( a, b ); }
+        inline Vec min( Vec a, Vec b ) { return _mm256_min_pd( a, b ); }
+        inline Vec max( Vec a, Vec b ) { return _mm256_max_pd( a, b ); }
+        inline Vec lessEqual( Vec a, Vec b ) { return _mm256_cmp_pd( a, b, _CMP_LE_OQ ); }
+        inline Vec ordered( Vec a, Vec b ) { return _mm256_cmp_pd( a, b, _CMP_ORD_Q ); }
+        inline Vec unordered( Vec a, Vec b ) { return _mm256_cmp_pd( a, b, _CMP_UNORD_Q ); }
+        inline Vec bitAnd( Vec a, Vec b ) { return _mm256_and_pd( a, b ); }
+        inline Vec bitAndNot( Vec a, Vec b ) { return _mm256_andnot_pd( a, b ); }
+        inline Vec bitOr( Vec a, Vec b ) { return _mm256_or_pd( a, b ); }
+#elif defined(__SSE2__)
+        using Vec = __m128d ;
+        constexpr std::size_t WIDTH = 2 ;
+        inline Vec load( const double * p ) { return _mm_loadu_pd( p ); }
+        inline void store( double * p, Vec v ) { _mm_storeu_pd( p, v ) ; }
+        inline Vec set( double x ) { return _mm_set1_pd( x ); }
+        inline Vec add( Vec a, Vec b ) { return _mm_add_pd( a, b ); }
+        inline Vec sub( Vec a, Vec b ) { return _mm_sub_pd( a, b ); }
+        inline Vec mul( Vec a, Vec b ) { return _mm_mul_pd( a, b ); }
+        inline Vec div( Vec a, Vec b ) { return _mm_div_pd( a, b ); }
+        inline Vec min( Vec a, Vec b ) { return _mm_min_pd( a, b ); }
+        inline Vec max( Vec a, Vec b ) { return _mm_max_pd( a, b ); }
+        inline Vec lessEqual( Vec a, Vec b ) { return _mm_cmple_pd( a, b ); }
+        inline Vec ordered( Vec a, Vec b ) { return _mm_cmpord_pd( a, b ); }
+        inline Vec unordered( Vec a, Vec b ) { return _mm_cmpunord_pd( a, b ); }
+        inline Vec bitAnd( Vec a, Vec b ) { return _mm_and_pd( a, b ); }
+        inline Vec bitAndNot( Vec a, Vec b ) { return _mm_andnot_pd( a, b ); }
+        inline Vec bitOr( Vec a, Vec b ) { return _mm_or_pd( a, b ); }
+#endif
+
+#if defined(__SSE2__)
+        inline Vec down( Vec r ) {
+            const Vec magnitude = bitAndNot( set( -0.0 ), r ) ;
+            return sub( r, add( min( mul( magnitude, set( ROUNDING ) ), set( LARGEST ) ), set( SMALLEST ) ) );
+        }
+
+        inline Vec up( Vec r ) {
+            const Vec magnitude = bitAndNot( set( -0.0 ), r ) ;
+            return add( r, add( min( mul( magnitude, set( ROUNDING ) ), set( LARGEST ) ), set( SMALLEST ) ) );
+        }
+
+        inline Vec product( Vec a, Vec b ) {
+            const Vec p = mul( a, b ) ;
+            // Clear the NaN of 0 * inf, which is only NaN with ordered operands
+            return bitAndNot( bitAnd( ordered( a, b ), unordered( p, p ) ), p );
+        }
+
+        inline void entireIfZero( Vec blo, Vec bhi, Vec& lo, Vec& hi ) {
+            const Vec zero = set( 0.0 ) ;
+            const Vec mask = bitAnd( lessEqual( blo, zero ), lessEqual( zero, bhi ) ) ;
+            lo = bitOr( bitAnd( mask, set( -INF ) ), bitAndNot( mask, lo ) ) ;
+            hi = bitOr( bitAnd( mask, set( INF ) ), bitAndNot( mask, hi ) ) ;
+        }
+#endif
+
+        //
+        // Bounds of the result of an operation on [alo, ahi] and [blo, bhi],
+        // written once for double and for vector registers
+        //
+        template<typename V>
+        void addBounds( V alo, V ahi, V blo, V bhi, V& lo, V& hi ) {
+            lo = down( add( alo, blo ) ) ;
+            hi = up( add( ahi, bhi ) ) ;
+        }
+
+        template<typename V>
+        void subtractBounds( V alo, V ahi, V blo, V bhi, V& lo, V& hi ) {
+            lo = down( sub( alo, bhi ) ) ;
+            hi = up( sub( ahi, blo ) ) ;
+        }
+
+        template<typename V>
+        void multiplyBounds( V alo, V ahi, V blo, V bhi, V& lo, V& hi ) {
+            const V p1 = product( alo, blo ), p2 = product( alo, bhi ), p3 = product( ahi, blo ), p4 = product( ahi, bhi ) ;
+            lo = down( min( min( p1, p2 ), min( p3, p4 ) ) ) ;
+            hi = up( max( max( p1, p2 ), max( p3, p4 ) ) ) ;
+        }
+
+        /**
+         * A divisor that contains zero gives the entire real line.
+         */
+        template<typename V>
+        void divideBounds( V alo, V ahi, V blo, V bhi, V& lo, V& hi ) {
+            const V q1 = div( alo, blo ), q2 = div( alo, bhi ), q3 = div( ahi, blo ), q4 = div( ahi, bhi ) ;
+            lo = down( min( min( q1, q2 ), min( q3, q4 ) ) ) ;
+            hi = up( max( max( q1, q2 ), max( q3, q4 ) ) ) ;
+            entireIfZero( blo, bhi, lo, hi ) ;
+        }
+
+        /**
+         * Apply bounds( alo, ahi, blo, bhi, lo, hi ) to \c n elements, whole
+         * registers at a time. The results may overwrite the operands.
+         */
+        template<typename Bounds>
+        void apply( const double * alo, const double * ahi, const double * blo, const double * bhi,
+                    double * lo, double * hi, std::size_t n, Bounds bounds ) {
+            std::size_t i = 0 ;
+#if defined(__SSE2__)
+            for( ; i + WIDTH <= n; i += WIDTH ) {
+                Vec l, h ;
+                bounds( load( alo + i ), load( ahi + i ), load( blo + i ), load( bhi + i ), l, h ) ;
+                store( lo + i, l ) ;
+                store( hi + i, h ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                bounds( alo[i], ahi[i], blo[i], bhi[i], lo[i], hi[i] ) ;
+            }
+        }
+
+        /**
+         * Lower bound of b^n for b >= 0.
+         */
+        inline double powDown( double b, int n ) {
+            double r = n == 0 ? 1.0 : b ;
+            for( int k = 1; k < n; ++k ) {
+                r = max( 0.0, down( r * b ) ) ;
+            }
+            return r;
+        }
+
+        /**
+         * Upper bound of b^n for b >= 0.
+         */
+        inline double powUp( double b, int n ) {
+            double r = n == 0 ? 1.0 : b ;
+            for( int k = 1; k < n; ++k ) {
+                r = up( r * b ) ;
+            }
+            return r;
+        }
+    }
+    // namespace lanes;
+    }
+
+    /**
+     * A value of the quantity Q known to lie in [lower, upper].
+     *
+     * Expressions that use the same interval more than once, such as
+     * x * x, give wider bounds than necessary because every occurrence is
+     * treated as independent; write pow<2>( x ) instead.
+     *
+     * \code
+     * Interval<Force> load( 900_N, 1100_N ) ;
+     * Interval<Area> pad( 0.0099_m2, 0.0101_m2 ) ;
+     * Interval<Pressure> p = load / pad ;
+     * if( certainly( p < 120000_Pa ) ) {
+     *     ...
+     * }
+     * \endcode
+     */
+    template<typename Q>
+    class Interval {
+    public:
+        constexpr Interval()
+        : lo( 0 ), hi( 0 ) {
+        }
+
+        /**
+         * The degenerate interval [value, value].
+         */
+        constexpr Interval( const Q& value )
+        : lo( value.getValue() ), hi( value.getValue() ) {
+        }
+
+        /**
+         * Throws std::invalid_argument if \c lower is above \c upper.
+         */
+        Interval( const Q& lower, const Q& upper )
+        : lo( lower.getValue() ), hi( upper.getValue() ) {
+            if( lo > hi ) {
+                throw std::invalid_argument( "Interval: lower bound above upper bound" );
+            }
+        }
+
+        constexpr Q lower() const {
+            return Q( lo );
+        }
+
+        constexpr Q upper() const {
+            return Q( hi );
+        }
+
+        constexpr Q midpoint() const {
+            return Q( 0.5 * lo + 0.5 * hi );
+        }
+
+        /**
+         * Upper bound of upper - lower.
+         */
+        Q width() const {
+            return Q( detail::lanes::up( hi - lo ) );
+        }
+
+        constexpr bool contains( const Q& x ) const {
+            return lo <= x.getValue() && x.getValue() <= hi;
+        }
+
+        constexpr bool contains( const Interval& x ) const {
+            return lo <= x.lo && x.hi <= hi;
+        }
+
+        Interval& operator+=( const Interval& rhs ) {
+            detail::lanes::addBounds( lo, hi, rhs.lo, rhs.hi, lo, hi ) ;
+            return *this;
+        }
+
+        Interval& operator-=( const Interval& rhs ) {
+            detail::lanes::subtractBounds( lo, hi, rhs.lo, rhs.hi, lo, hi ) ;
+            return *this;
+        }
+
+        Interval& operator*=( double rhs ) {
+            detail::lanes::multiplyBounds( lo, hi, rhs, rhs, lo, hi ) ;
+            return *this;
+        }
+
+        Interval& operator/=( double rhs ) {
+            detail::lanes::divideBounds( lo, hi, rhs, rhs, lo, hi ) ;
+            return *this;
+        }
+
+    private:
+        double lo ;
+        double hi ;
+    } ;
+
+    //
+    // Arithmetic operators for Interval<> instances
+    //
+    template<typename Q>
+    Interval<Q> operator+( Interval<Q> lhs, const Interval<Q>& rhs ) {
+        return lhs += rhs;
+    }
+
+    template<typename Q>
+    Interval<Q> operator-( Interval<Q> lhs, const Interval<Q>& rhs ) {
+        return lhs -= rhs;
+    }
+
+    template<typename Q>
+    Interval<Q> operator-( const Interval<Q>& rhs ) {
+        return Interval<Q>( Q( -rhs.upper().getValue() ), Q( -rhs.lower().getValue() ) );
+    }
+
+    template<typename Q1, typename Q2>
+    Interval<decltype( Q1() * Q2() )> operator*( const Interval<Q1>& lhs, const Interval<Q2>& rhs ) {
+        using R = decltype( Q1() * Q2() ) ;
+        double lo, hi ;
+        detail::lanes::multiplyBounds( lhs.lower().getValue(), lhs.upper().getValue(),
+                                       rhs.lower().getValue(), rhs.upper().getValue(), lo, hi ) ;
+        return Interval<R>( R( lo ), R( hi ) );
+    }
+
+    /**
+     * The quotient is the entire real line if \c rhs contains zero.
+     */
+    template<typename Q1, typename Q2>
+    Interval<decltype( Q1() / Q2() )> operator/( const Interval<Q1>& lhs, const Interval<Q2>& rhs ) {
+        using R = decltype( Q1() / Q2() ) ;
+        double lo, hi ;
+        detail::lanes::divideBounds( lhs.lower().getValue(), lhs.upper().getValue(),
+                                     rhs.lower().getValue(), rhs.upper().getValue(), lo, hi ) ;
+        return Interval<R>( R( lo ), R( hi ) );
+    }
+
+    template<typename Q>
+    Interval<Q> operator*( Interval<Q> lhs, double rhs ) {
+        return lhs *= rhs;
+    }
+
+    template<typename Q>
+    Interval<Q> operator*( double lhs, Interval<Q> rhs ) {
+        return rhs *= lhs;
+    }
+
+    template<typename Q>
+    Interval<Q> operator/( Interval<Q> lhs, double rhs ) {
+        return lhs /= rhs;
+    }
+
+    /**
+     * Scale an interval by an exact quantity.
+     */
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Interval<decltype( Q() * Quantity<L, M, T, EC, TT, AS, LI>() )>
+    operator*( const Interval<Q>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return lhs * Interval<Quantity<L, M, T, EC, TT, AS, LI>>( rhs );
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Interval<decltype( Quantity<L, M, T, EC, TT, AS, LI>() * Q() )>
+    operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Interval<Q>& rhs ) {
+        return Interval<Quantity<L, M, T, EC, TT, AS, LI>>( lhs ) * rhs;
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Interval<decltype( Q() / Quantity<L, M, T, EC, TT, AS, LI>() )>
+    operator/( const Interval<Q>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        return lhs / Interval<Quantity<L, M, T, EC, TT, AS, LI>>( rhs );
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Interval<decltype( Quantity<L, M, T, EC, TT, AS, LI>() / Q() )>
+    operator/( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Interval<Q>& rhs ) {
+        return Interval<Quantity<L, M, T, EC, TT, AS, LI>>( lhs ) / rhs;
+    }
+
+    /**
+     * Square root of the non-negative part of \c x. Throws
+     * std::domain_error if \c x lies entirely below zero.
+     */
+    template<typename Q>
+    Interval<decltype( sqrt( Q() ) )> sqrt( const Interval<Q>& x ) {
+        using R = decltype( sqrt( Q() ) ) ;
+        if( x.upper().getValue() < 0 ) {
+            throw std::domain_error( "Interval: square root of a negative interval" );
+        }
+        const double lo = std::sqrt( detail::lanes::max( x.lower().getValue(), 0.0 ) ) ;
+        const double hi = std::sqrt( x.upper().getValue() ) ;
+        return Interval<R>( R( detail::lanes::max( 0.0, detail::lanes::down( lo ) ) ), R( detail::lanes::up( hi ) ) );
+    }
+
+    /**
+     * Integer power. Even powers of an interval that contains zero start
+     * at zero; negative powers of such an interval are the entire real
+     * line.
+     */
+    template<int N, typename Q>
+    Interval<decltype( pow<N>( Q() ) )> pow( const Interval<Q>& x ) {
+        using R = decltype( pow<N>( Q() ) ) ;
+        using namespace detail::lanes ;
+        const int n = N < 0 ? -N : N ;
+        const double a = x.lower().getValue(), b = x.upper().getValue() ;
+        double lo, hi ;
+        if( n == 0 ) {
+            lo = hi = 1 ;
+        } else if( n % 2 == 1 ) {
+            lo = a >= 0 ? powDown( a, n ) : -powUp( -a, n ) ;
+            hi = b >= 0 ? powUp( b, n ) : -powDown( -b, n ) ;
+        } else if( a >= 0 ) {
+            lo = powDown( a, n ) ;
+            hi = powUp( b, n ) ;
+        } else if( b <= 0 ) {
+            lo = powDown( -b, n ) ;
+            hi = powUp( -a, n ) ;
+        } else {
+            lo = 0 ;
+            hi = powUp( max( -a, b ), n ) ;
+        }
+        if( N < 0 ) {
+            divideBounds( 1.0, 1.0, lo, hi, lo, hi ) ;
+        }
+        return Interval<R>( R( lo ), R( hi ) );
+    }
+
+    /**
+     * Smallest interval that contains both \c a and \c b.
+     */
+    template<typename Q>
+    Interval<Q> hull( const Interval<Q>& a, const Interval<Q>& b ) {
+        return Interval<Q>( a.lower() < b.lower() ? a.lower() : b.lower(),
+                            a.upper() > b.upper() ? a.upper() : b.upper() );
+    }
+
+    //
+    // Comparisons. True or False when all pairs of values within the
+    // bounds agree, Unknown otherwise.
+    //
+    template<typename Q>
+    Tristate operator<( const Interval<Q>& lhs, const Interval<Q>& rhs ) {
+        return lhs.upper() < rhs.lower() ? Tristate::True
+             : lhs.lower() >= rhs.upper() ? Tristate::False : Tristate::Unknown;
+    }
+
+    template<typename Q>
+    Tristate operator<=( const Interval<Q>& lhs, const Interval<Q>& rhs ) {
+        return lhs.upper() <= rhs.lower() ? Tristate::True
+             : lhs.lower() > rhs.upper() ? Tristate::False : Tristate::Unknown;
+    }
+
+    template<typename Q>
+    Tristate operator>( const Interval<Q>& lhs, const Interval<Q>& rhs ) {
+        return rhs < lhs;
+    }
+
+    template<typename Q>
+    Tristate operator>=( const Interval<Q>& lhs, const Interval<Q>& rhs ) {
+        return rhs <= lhs;
+    }
+
+    template<typename Q>
+    Tristate operator<( const Interval<Q>& lhs, const Q& rhs ) {
+        return lhs < Interval<Q>( rhs );
+    }
+
+    template<typename Q>
+    Tristate operator<=( const Interval<Q>& lhs, const Q& rhs ) {
+        return lhs <= Interval<Q>( rhs );
+    }
+
+    template<typename Q>
+    Tristate operator>( const Interval<Q>& lhs, const Q& rhs ) {
+        return lhs > Interval<Q>( rhs );
+    }
+
+    template<typename Q>
+    Tristate operator>=( const Interval<Q>& lhs, const Q& rhs ) {
+        return lhs >= Interval<Q>( rhs );
+    }
+
+    template<typename Q>
+    Tristate operator<( const Q& lhs, const Interval<Q>& rhs ) {
+        return Interval<Q>( lhs ) < rhs;
+    }
+
+    template<typename Q>
+    Tristate operator<=( const Q& lhs, const Interval<Q>& rhs ) {
+        return Interval<Q>( lhs ) <= rhs;
+    }
+
+    template<typename Q>
+    Tristate operator>( const Q& lhs, const Interval<Q>& rhs ) {
+        return Interval<Q>( lhs ) > rhs;
+    }
+
+    template<typename Q>
+    Tristate operator>=( const Q& lhs, const Interval<Q>& rhs ) {
+        return Interval<Q>( lhs ) >= rhs;
+    }
+
+    inline std::ostream& operator<<( std::ostream& os, Tristate t )
+    {
+        os << ( t == Tristate::True ? "true" : t == Tristate::False ? "false" : "unknown" ) ;
+        return os ;
+    }
+
+    template<typename Q>
+    std::ostream& operator<<( std::ostream& os, const Interval<Q>& x )
+    {
+        os << "[" << x.lower() << ", " << x.upper() << "]" ;
+        return os ;
+    }
+
+    /**
+     * Many intervals of the quantity Q, stored as one array of lower and
+     * one array of upper bounds. The element-wise operations below run the
+     * same bound computations as the Interval<> operators on whole vector
+     * registers, without branches, and give identical results.
+     */
+    template<typename Q>
+    class IntervalArray {
+    public:
+        IntervalArray() = default ;
+
+        explicit IntervalArray( std::size_t n )
+        : lo( n ), hi( n ) {
+        }
+
+        std::size_t size() const {
+            return lo.size();
+        }
+
+        void reserve( std::size_t n ) {
+            lo.reserve( n ) ;
+            hi.reserve( n ) ;
+        }
+
+        void push_back( const Interval<Q>& x ) {
+            lo.push_back( x.lower().getValue() ) ;
+            hi.push_back( x.upper().getValue() ) ;
+        }
+
+        Interval<Q> operator[]( std::size_t i ) const {
+            return Interval<Q>( Q( lo[i] ), Q( hi[i] ) );
+        }
+
+        void set( std::size_t i, const Interval<Q>& x ) {
+            lo[i] = x.lower().getValue() ;
+            hi[i] = x.upper().getValue() ;
+        }
+
+        /**
+         * The lower bounds in the fundamental SI unit.
+         */
+        double * lowers() {
+            return lo.data();
+        }
+
+        const double * lowers() const {
+            return lo.data();
+        }
+
+        /**
+         * The upper bounds in the fundamental SI unit.
+         */
+        double * uppers() {
+            return hi.data();
+        }
+
+        const double * uppers() const {
+            return hi.data();
+        }
+
+    private:
+        std::vector<double> lo ;
+        std::vector<double> hi ;
+    } ;
+
+    namespace detail {
+        template<typename R, typename Q1, typename Q2, typename Bounds>
+        void bound( const IntervalArray<Q1>& lhs, const IntervalArray<Q2>& rhs, IntervalArray<R>& result, Bounds bounds ) {
+            if( lhs.size() != rhs.size() ) {
+                throw std::invalid_argument( "IntervalArray: arrays differ in size" );
+            }
+            if( result.size() != lhs.size() ) {
+                result = IntervalArray<R>( lhs.size() ) ;
+            }
+            lanes::apply( lhs.lowers(), lhs.uppers(), rhs.lowers(), rhs.uppers(),
+                          result.lowers(), result.uppers(), lhs.size(), bounds ) ;
+        }
+    }
+
+    //
+    // Element-wise operations on IntervalArray<> instances. The functions
+    // write to an existing array, which is resized if needed, so repeated
+    // calls do not allocate; the operators return a new array. Both throw
+    // std::invalid_argument if the operands differ in size.
+    //
+    template<typename Q>
+    void add( const IntervalArray<Q>& lhs, const IntervalArray<Q>& rhs, IntervalArray<Q>& result ) {
+        detail::bound( lhs, rhs, result, []( auto alo, auto ahi, auto blo, auto bhi, auto& lo, auto& hi ) {
+            detail::lanes::addBounds( alo, ahi, blo, bhi, lo, hi ) ;
+        } ) ;
+    }
+
+    template<typename Q>
+    void subtract( const IntervalArray<Q>& lhs, const IntervalArray<Q>& rhs, IntervalArray<Q>& result ) {
+        detail::bound( lhs, rhs, result, []( auto alo, auto ahi, auto blo, auto bhi, auto& lo, auto& hi ) {
+            detail::lanes::subtractBounds( alo, ahi, blo, bhi, lo, hi ) ;
+        } ) ;
+    }
+
+    template<typename Q1, typename Q2>
+    void multiply( const IntervalArray<Q1>& lhs, const IntervalArray<Q2>& rhs, IntervalArray<decltype( Q1() * Q2() )>& result ) {
+        detail::bound( lhs, rhs, result, []( auto alo, auto ahi, auto blo, auto bhi, auto& lo, auto& hi ) {
+            detail::lanes::multiplyBounds( alo, ahi, blo, bhi, lo, hi ) ;
+        } ) ;
+    }
+
+    template<typename Q1, typename Q2>
+    void divide( const IntervalArray<Q1>& lhs, const IntervalArray<Q2>& rhs, IntervalArray<decltype( Q1() / Q2() )>& result ) {
+        detail::bound( lhs, rhs, result, []( auto alo, auto ahi, auto blo, auto bhi, auto& lo, auto& hi ) {
+            detail::lanes::divideBounds( alo, ahi, blo, bhi, lo, hi ) ;
+        } ) ;
+    }
+
+    template<typename Q>
+    IntervalArray<Q> operator+( const IntervalArray<Q>& lhs, const IntervalArray<Q>& rhs ) {
+        IntervalArray<Q> result ;
+        add( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q>
+    IntervalArray<Q> operator-( const IntervalArray<Q>& lhs, const IntervalArray<Q>& rhs ) {
+        IntervalArray<Q> result ;
+        subtract( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q1, typename Q2>
+    IntervalArray<decltype( Q1() * Q2() )> operator*( const IntervalArray<Q1>& lhs, const IntervalArray<Q2>& rhs ) {
+        IntervalArray<decltype( Q1() * Q2() )> result ;
+        multiply( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q1, typename Q2>
+    IntervalArray<decltype( Q1() / Q2() )> operator/( const IntervalArray<Q1>& lhs, const IntervalArray<Q2>& rhs ) {
+        IntervalArray<decltype( Q1() / Q2() )> result ;
+        divide( lhs, rhs, result ) ;
+        return result;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* INTERVAL_HPP_ */
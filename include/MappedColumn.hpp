@@ -0,0 +1,391 @@
+/*
+ * MappedColumn.hpp
+ *
+ *      Memory-mapped column files of Quantity<> values for data sets that do
+ *      not fit in memory. A column file uses the binary array format of
+ *      BinaryIO.hpp with doubles in the fundamental SI unit, so the mapped
+ *      payload is used as an array of quantities without deserialization.
+ *
+ *      This header requires a POSIX system (mmap, madvise, pwrite).
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef MAPPEDCOLUMN_HPP_
+#define MAPPEDCOLUMN_HPP_
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "MappedColumn.hpp requires a POSIX system"
+#endif
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ScientificQuantities.hpp"
+#include "BinaryIO.hpp"
+
+namespace SciQ {
+
+    /**
+     * Expected access pattern of a mapped column, passed on to madvise().
+     */
+    enum class ColumnAccess {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed,
+        DontNeed
+    } ;
+
+    namespace detail {
+        inline std::system_error systemError( const std::string& what ) {
+            return std::system_error( errno, std::generic_category(), what );
+        }
+
+        inline std::size_t pageSize() {
+            static const std::size_t size = static_cast<std::size_t>( sysconf( _SC_PAGESIZE ) ) ;
+            return size;
+        }
+    }
+
+    /**
+     * Typed, read-only view of a column file. The file is mapped on
+     * construction; its header is validated and the stored dimension is
+     * checked against Q, so opening a Voltage column as Speed throws
+     * std::invalid_argument.
+     *
+     * \code
+     * MappedColumn<Speed> speeds( "speed.sciq" ) ;
+     * speeds.advise( ColumnAccess::Sequential ) ;
+     * Speed max_speed ;
+     * for( const Speed& s : speeds ) {
+     *     max_speed = std::max( max_speed, s ) ;
+     * }
+     * \endcode
+     */
+    template<typename Q>
+    class MappedColumn {
+    public:
+        using value_type = Q ;
+        using const_iterator = const Q* ;
+
+        /**
+         * Map the column file at \c path. Throws std::system_error if the
+         * file cannot be mapped and std::runtime_error/std::invalid_argument
+         * if it is not a valid column of Q.
+         */
+        explicit MappedColumn( const std::string& path )
+        : path( path ) {
+            map() ;
+        }
+
+        MappedColumn( const MappedColumn& ) = delete ;
+        MappedColumn& operator=( const MappedColumn& ) = delete ;
+
+        MappedColumn( MappedColumn&& other )
+        : path( std::move( other.path ) ), mapping( other.mapping ), mappedSize( other.mappedSize ),
+          values( other.values ), count( other.count ) {
+            other.mapping = nullptr ;
+            other.mappedSize = 0 ;
+            other.values = nullptr ;
+            other.count = 0 ;
+        }
+
+        MappedColumn& operator=( MappedColumn&& other ) {
+            if( this != &other ) {
+                unmap() ;
+                path = std::move( other.path ) ;
+                mapping = other.mapping ;
+                mappedSize = other.mappedSize ;
+                values = other.values ;
+                count = other.count ;
+                other.mapping = nullptr ;
+                other.mappedSize = 0 ;
+                other.values = nullptr ;
+                other.count = 0 ;
+            }
+            return *this;
+        }
+
+        ~MappedColumn() {
+            unmap() ;
+        }
+
+        /**
+         * Re-map the file to pick up values appended since it was opened.
+         * @return True if the number of values changed
+         */
+        bool refresh() {
+            const std::size_t previous = count ;
+            unmap() ;
+            map() ;
+            return count != previous;
+        }
+
+        std::size_t size() const {
+            return count;
+        }
+
+        const Q * data() const {
+            return values;
+        }
+
+        const Q& operator[]( std::size_t i ) const {
+            return values[i];
+        }
+
+        const_iterator begin() const {
+            return values;
+        }
+
+        const_iterator end() const {
+            return values + count;
+        }
+
+        /**
+         * Tell the kernel how the values [first, first+n) will be accessed.
+         * The range is widened to whole pages.
+         */
+        void advise( ColumnAccess access, std::size_t first = 0, std::size_t n = std::size_t(-1) ) const {
+            if( mapping == nullptr || first >= count ) {
+                return;
+            }
+            n = std::min( n, count - first ) ;
+            const std::size_t page = detail::pageSize() ;
+            const std::size_t begin_byte = ( BINARY_HEADER_SIZE + first * sizeof(Q) ) / page * page ;
+            const std::size_t end_byte = BINARY_HEADER_SIZE + ( first + n ) * sizeof(Q) ;
+            static const int advice[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED } ;
+            if( madvise( static_cast<char*>( mapping ) + begin_byte, end_byte - begin_byte,
+                         advice[static_cast<int>( access )] ) != 0 ) {
+                throw detail::systemError( "madvise failed for " + path );
+            }
+        }
+
+        /**
+         * Call \c f( first, last ) for consecutive chunks of the column. The
+         * chunk boundaries fall on page boundaries of the file and each chunk
+         * spans about \c chunk_bytes bytes. The next chunk is prefetched while
+         * \c f processes the current one, and pages that have been processed
+         * are released when \c release is set, which keeps the resident set
+         * small when streaming through very large columns.
+         */
+        template<typename F>
+        void forEachChunk( F f, std::size_t chunk_bytes = std::size_t(1) << 24, bool release = false ) const {
+            const std::size_t page = detail::pageSize() ;
+            chunk_bytes = std::max( page, chunk_bytes / page * page ) ;
+            std::size_t first = 0 ;
+            while( first < count ) {
+                // Last element whose end lies on or before the next page aligned boundary
+                const std::size_t begin_byte = BINARY_HEADER_SIZE + first * sizeof(Q) ;
+                const std::size_t end_byte = ( begin_byte / page * page ) + chunk_bytes ;
+                const std::size_t last = std::min( count, std::max( first + 1, ( end_byte - BINARY_HEADER_SIZE ) / sizeof(Q) ) ) ;
+                if( last < count ) {
+                    advise( ColumnAccess::WillNeed, last, last - first ) ;
+                }
+                f( values + first, values + last ) ;
+                if( release ) {
+                    advise( ColumnAccess::DontNeed, first, last - first ) ;
+                }
+                first = last ;
+            }
+        }
+
+    private:
+        void map() {
+            const int fd = open( path.c_str(), O_RDONLY ) ;
+            if( fd < 0 ) {
+                throw detail::systemError( "Cannot open " + path );
+            }
+            struct stat st ;
+            if( fstat( fd, &st ) != 0 ) {
+                close( fd ) ;
+                throw detail::systemError( "Cannot stat " + path );
+            }
+            mappedSize = static_cast<std::size_t>( st.st_size ) ;
+            if( mappedSize < BINARY_HEADER_SIZE ) {
+                close( fd ) ;
+                throw std::runtime_error( "Column file too small: " + path );
+            }
+            mapping = mmap( nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0 ) ;
+            close( fd ) ;
+            if( mapping == MAP_FAILED ) {
+                mapping = nullptr ;
+                throw detail::systemError( "Cannot map " + path );
+            }
+            try {
+                // Values beyond the count in the header are an incomplete append
+                BinaryArrayView<Q> view( mapping, mappedSize ) ;
+                values = view.data() ;
+                count = view.size() ;
+            }
+            catch( ... ) {
+                unmap() ;
+                throw;
+            }
+        }
+
+        void unmap() {
+            if( mapping != nullptr ) {
+                munmap( mapping, mappedSize ) ;
+                mapping = nullptr ;
+            }
+            values = nullptr ;
+            count = 0 ;
+        }
+
+        std::string path ;
+        void * mapping = nullptr ;
+        std::size_t mappedSize = 0 ;
+        const Q * values = nullptr ;
+        std::size_t count = 0 ;
+    } ;
+
+    /**
+     * Appends values to a column file. A new file is created with an empty
+     * header; an existing file is validated against Q and extended. Values
+     * are buffered and written on flush(), which also updates the count in
+     * the header so that readers (see MappedColumn::refresh()) see either the
+     * old or the new set of values.
+     */
+    template<typename Q>
+    class ColumnWriter {
+    public:
+        /**
+         * Open or create the column file at \c path. \c buffer_size is the
+         * number of values that are buffered before they are written.
+         */
+        explicit ColumnWriter( const std::string& path, std::size_t buffer_size = 1 << 16 )
+        : path( path ) {
+            fd = open( path.c_str(), O_RDWR | O_CREAT, 0644 ) ;
+            if( fd < 0 ) {
+                throw detail::systemError( "Cannot open " + path );
+            }
+            try {
+                openHeader() ;
+                buffer.reserve( buffer_size ) ;
+            }
+            catch( ... ) {
+                close( fd ) ;
+                throw;
+            }
+        }
+
+        ColumnWriter( const ColumnWriter& ) = delete ;
+        ColumnWriter& operator=( const ColumnWriter& ) = delete ;
+
+        /**
+         * Write the buffered values. A destructor cannot report errors, so
+         * call flush() first to get them as exceptions.
+         */
+        ~ColumnWriter() {
+            try {
+                flush() ;
+            }
+            catch( ... ) {
+            }
+            close( fd ) ;
+        }
+
+        void append( const Q& q ) {
+            buffer.push_back( q ) ;
+            if( buffer.size() == buffer.capacity() ) {
+                flush() ;
+            }
+        }
+
+        void append( const Q * data, std::size_t n ) {
+            flush() ;
+            writeValues( data, n ) ;
+        }
+
+        /**
+         * Number of values in the file, including the buffered ones.
+         */
+        std::size_t size() const {
+            return header.count + buffer.size();
+        }
+
+        /**
+         * Write the buffered values and update the header.
+         */
+        void flush() {
+            writeValues( buffer.data(), buffer.size() ) ;
+            buffer.clear() ;
+        }
+
+    private:
+        /**
+         * Write the header of a new file or validate the one of an existing
+         * file, whose count must fit into the file.
+         */
+        void openHeader() {
+            unsigned char head[BINARY_HEADER_SIZE] ;
+            const ssize_t n = pread( fd, head, BINARY_HEADER_SIZE, 0 ) ;
+            if( n < 0 ) {
+                throw detail::systemError( "Cannot read " + path );
+            }
+            if( n == 0 ) {
+                header.dimension = dimensionOf<Q>() ;
+                writeHeader() ;
+                return;
+            }
+            struct stat st ;
+            if( fstat( fd, &st ) != 0 ) {
+                throw detail::systemError( "Cannot stat " + path );
+            }
+            if( n != static_cast<ssize_t>( BINARY_HEADER_SIZE ) || !header.decode( head, BINARY_HEADER_SIZE ) ||
+                !header.fitsIn( static_cast<std::uint64_t>( st.st_size ) - BINARY_HEADER_SIZE ) ) {
+                throw std::runtime_error( "Invalid column file: " + path );
+            }
+            if( header.dimension != dimensionOf<Q>() || !header.isZeroCopy() ) {
+                throw std::invalid_argument( "Column file does not hold the requested quantity: " + path );
+            }
+        }
+
+        void writeValues( const Q * data, std::size_t n ) {
+            if( n == 0 ) {
+                return;
+            }
+            const char * bytes = reinterpret_cast<const char*>( data ) ;
+            std::size_t remaining = n * sizeof(Q) ;
+            off_t offset = BINARY_HEADER_SIZE + header.count * sizeof(Q) ;
+            while( remaining > 0 ) {
+                const ssize_t written = pwrite( fd, bytes, remaining, offset ) ;
+                if( written < 0 ) {
+                    if( errno == EINTR ) {
+                        continue;
+                    }
+                    throw detail::systemError( "Cannot write " + path );
+                }
+                bytes += written ;
+                remaining -= written ;
+                offset += written ;
+            }
+            header.count += n ;
+            writeHeader() ;
+        }
+
+        void writeHeader() {
+            unsigned char head[BINARY_HEADER_SIZE] ;
+            header.encode( head ) ;
+            if( pwrite( fd, head, BINARY_HEADER_SIZE, 0 ) != static_cast<ssize_t>( BINARY_HEADER_SIZE ) ) {
+                throw detail::systemError( "Cannot write header of " + path );
+            }
+        }
+
+        std::string path ;
+        int fd = -1 ;
+        BinaryHeader header ;
+        std::vector<Q> buffer ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* MAPPEDCOLUMN_HPP_ */
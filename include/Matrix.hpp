@@ -0,0 +1,470 @@
+/*
+ * Matrix.hpp
+ *
+ *      State vectors and matrices whose elements have different
+ *      quantities, as used by estimation filters. The element quantities are
+ *      part of the type and checked at compile time, while the values are
+ *      kept in a plain contiguous block of doubles so that the kernels are
+ *      ordinary fixed-size loops.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef MATRIX_HPP_
+#define MATRIX_HPP_
+
+#include <tuple>
+#include <type_traits>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    namespace detail {
+        /**
+         * True if all types are the same.
+         */
+        template<typename... Ts>
+        struct AllSame : std::true_type
+        {} ;
+
+        template<typename T, typename... Ts>
+        struct AllSame<T, Ts...> : std::integral_constant<bool, std::is_same<std::tuple<T, Ts...>, std::tuple<Ts..., T>>::value>
+        {} ;
+
+        template<typename T, typename... Ts>
+        struct First {
+            using type = T ;
+        } ;
+    }
+
+    /**
+     * Vector of quantities of different kinds, e.g. the state of a filter
+     * StateVector<Length, Speed, Angle>. The values are stored in their
+     * fundamental SI units in a contiguous array of doubles.
+     */
+    template<typename... Qs>
+    class StateVector {
+    public:
+        static_assert( sizeof...(Qs) > 0, "A state vector needs at least one element" );
+
+        /**
+         * Number of elements.
+         */
+        static constexpr std::size_t SIZE = sizeof...(Qs) ;
+
+        /**
+         * Quantity of the I-th element.
+         */
+        template<std::size_t I>
+        using ElementType = typename std::tuple_element<I, std::tuple<Qs...>>::type ;
+
+        /**
+         * Creates a vector with all elements zero.
+         */
+        constexpr StateVector()
+        : v{} {
+        }
+
+        constexpr explicit StateVector( const Qs&... qs )
+        : v{ qs.getValue()... } {
+        }
+
+        static constexpr std::size_t size() {
+            return SIZE;
+        }
+
+        template<std::size_t I>
+        constexpr ElementType<I> get() const {
+            return ElementType<I>( v[I] );
+        }
+
+        template<std::size_t I>
+        void set( const ElementType<I>& q ) {
+            v[I] = q.getValue() ;
+        }
+
+        const double * data() const {
+            return v;
+        }
+
+        double * data() {
+            return v;
+        }
+
+        StateVector& operator+=( const StateVector& rhs ) {
+            for( std::size_t i = 0; i < SIZE; ++i ) {
+                v[i] += rhs.v[i] ;
+            }
+            return *this;
+        }
+
+        StateVector& operator-=( const StateVector& rhs ) {
+            for( std::size_t i = 0; i < SIZE; ++i ) {
+                v[i] -= rhs.v[i] ;
+            }
+            return *this;
+        }
+
+        StateVector& operator*=( double rhs ) {
+            for( std::size_t i = 0; i < SIZE; ++i ) {
+                v[i] *= rhs ;
+            }
+            return *this;
+        }
+
+    private:
+        double v[SIZE] ;
+    } ;
+
+    template<typename... Qs>
+    StateVector<Qs...> operator+( const StateVector<Qs...>& lhs, const StateVector<Qs...>& rhs ) {
+        return StateVector<Qs...>( lhs ) += rhs;
+    }
+
+    template<typename... Qs>
+    StateVector<Qs...> operator-( const StateVector<Qs...>& lhs, const StateVector<Qs...>& rhs ) {
+        return StateVector<Qs...>( lhs ) -= rhs;
+    }
+
+    template<typename... Qs>
+    StateVector<Qs...> operator*( const StateVector<Qs...>& lhs, double rhs ) {
+        return StateVector<Qs...>( lhs ) *= rhs;
+    }
+
+    template<typename... Qs>
+    StateVector<Qs...> operator*( double lhs, const StateVector<Qs...>& rhs ) {
+        return StateVector<Qs...>( rhs ) *= lhs;
+    }
+
+    /**
+     * Multiply all elements by a quantity: StateVector<Speed, AngularVelocity>
+     * times a Time is a StateVector<Length, Angle>.
+     */
+    template<typename... Qs, class L, class M, class T, class EC, class TT, class AS, class LI>
+    StateVector<decltype( Qs() * Quantity<L, M, T, EC, TT, AS, LI>() )...>
+    operator*( const StateVector<Qs...>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        StateVector<decltype( Qs() * rhs )...> result ;
+        for( std::size_t i = 0; i < sizeof...(Qs); ++i ) {
+            result.data()[i] = lhs.data()[i] * rhs.getValue() ;
+        }
+        return result;
+    }
+
+    template<typename... Qs, class L, class M, class T, class EC, class TT, class AS, class LI>
+    StateVector<decltype( Quantity<L, M, T, EC, TT, AS, LI>() * Qs() )...>
+    operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const StateVector<Qs...>& rhs ) {
+        return rhs * lhs;
+    }
+
+    template<typename... Qs, class L, class M, class T, class EC, class TT, class AS, class LI>
+    StateVector<decltype( Qs() / Quantity<L, M, T, EC, TT, AS, LI>() )...>
+    operator/( const StateVector<Qs...>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        StateVector<decltype( Qs() / rhs )...> result ;
+        for( std::size_t i = 0; i < sizeof...(Qs); ++i ) {
+            result.data()[i] = lhs.data()[i] / rhs.getValue() ;
+        }
+        return result;
+    }
+
+    /**
+     * State vector of the reciprocal quantities.
+     */
+    template<typename SV>
+    struct Reciprocal
+    {} ;
+
+    template<typename... Qs>
+    struct Reciprocal<StateVector<Qs...>> {
+        using type = StateVector<decltype( Dimensionless() / Qs() )...> ;
+    } ;
+
+    /**
+     * Matrix whose element (i, j) has the quantity R_i / C_j, where R and C
+     * are StateVector<> types. With this convention the Jacobian of a
+     * function from the state In to the state Out is a Matrix<Out, In>, and
+     * the covariance of a state X is a Matrix<X, Reciprocal<X>>
+     * (see Covariance).
+     *
+     * Values are stored row-major in a contiguous array of doubles.
+     * Products are only defined when the dimensions line up, which is
+     * checked at compile time.
+     */
+    template<typename R, typename C>
+    class Matrix
+    {} ;
+
+    template<typename... Rs, typename... Cs>
+    class Matrix<StateVector<Rs...>, StateVector<Cs...>> {
+    public:
+        using RowType = StateVector<Rs...> ;
+        using ColumnType = StateVector<Cs...> ;
+
+        static constexpr std::size_t ROWS = sizeof...(Rs) ;
+        static constexpr std::size_t COLS = sizeof...(Cs) ;
+
+        /**
+         * Quantity of the element (I, J).
+         */
+        template<std::size_t I, std::size_t J>
+        using ElementType = decltype( typename RowType::template ElementType<I>() /
+                                      typename ColumnType::template ElementType<J>() ) ;
+
+        /**
+         * Creates a matrix with all elements zero.
+         */
+        constexpr Matrix()
+        : m{} {
+        }
+
+        /**
+         * Matrix with ones on the diagonal. Only defined when the diagonal
+         * elements are dimensionless, i.e. for Matrix<X, X>.
+         */
+        static Matrix identity() {
+            static_assert( ROWS == COLS && std::is_same<RowType, ColumnType>::value,
+                           "Only a Matrix<X, X> has a dimensionless identity" );
+            Matrix result ;
+            for( std::size_t i = 0; i < ROWS; ++i ) {
+                result.m[i * COLS + i] = 1.0 ;
+            }
+            return result;
+        }
+
+        template<std::size_t I, std::size_t J>
+        constexpr ElementType<I, J> get() const {
+            static_assert( I < ROWS && J < COLS, "Matrix index out of range" );
+            return ElementType<I, J>( m[I * COLS + J] );
+        }
+
+        template<std::size_t I, std::size_t J>
+        void set( const ElementType<I, J>& q ) {
+            static_assert( I < ROWS && J < COLS, "Matrix index out of range" );
+            m[I * COLS + J] = q.getValue() ;
+        }
+
+        /**
+         * Value of element (i, j) in its fundamental SI unit.
+         */
+        double operator()( std::size_t i, std::size_t j ) const {
+            return m[i * COLS + j];
+        }
+
+        double& operator()( std::size_t i, std::size_t j ) {
+            return m[i * COLS + j];
+        }
+
+        const double * data() const {
+            return m;
+        }
+
+        double * data() {
+            return m;
+        }
+
+        Matrix& operator+=( const Matrix& rhs ) {
+            for( std::size_t i = 0; i < ROWS * COLS; ++i ) {
+                m[i] += rhs.m[i] ;
+            }
+            return *this;
+        }
+
+        Matrix& operator-=( const Matrix& rhs ) {
+            for( std::size_t i = 0; i < ROWS * COLS; ++i ) {
+                m[i] -= rhs.m[i] ;
+            }
+            return *this;
+        }
+
+        Matrix& operator*=( double rhs ) {
+            for( std::size_t i = 0; i < ROWS * COLS; ++i ) {
+                m[i] *= rhs ;
+            }
+            return *this;
+        }
+
+    private:
+        double m[ROWS * COLS] ;
+    } ;
+
+    /**
+     * Covariance matrix of the state X: element (i, j) has the quantity
+     * X_i * X_j.
+     */
+    template<typename X>
+    using Covariance = Matrix<X, typename Reciprocal<X>::type> ;
+
+    namespace detail {
+        /**
+         * Checks that the inner dimensions of a product line up. The k-th
+         * column of the left operand has the quantity 1/C_k and the k-th row
+         * of the right operand R_k; their product R_k/C_k must be the same
+         * quantity, Scale, for every k.
+         */
+        template<typename C, typename R>
+        struct InnerProduct
+        {} ;
+
+        template<typename... Cs, typename... Rs>
+        struct InnerProduct<StateVector<Cs...>, StateVector<Rs...>> {
+            static_assert( sizeof...(Cs) == sizeof...(Rs), "Inner dimensions of the product do not match" );
+            static_assert( AllSame<decltype( Rs() / Cs() )...>::value,
+                           "Quantities of the product do not line up" );
+            using Scale = typename First<decltype( Rs() / Cs() )...>::type ;
+        } ;
+
+        template<typename SV, typename S>
+        struct Scaled
+        {} ;
+
+        template<typename... Qs, typename S>
+        struct Scaled<StateVector<Qs...>, S> {
+            using type = StateVector<decltype( Qs() * S() )...> ;
+        } ;
+    }
+
+    template<typename R, typename C>
+    Matrix<R, C> operator+( const Matrix<R, C>& lhs, const Matrix<R, C>& rhs ) {
+        return Matrix<R, C>( lhs ) += rhs;
+    }
+
+    template<typename R, typename C>
+    Matrix<R, C> operator-( const Matrix<R, C>& lhs, const Matrix<R, C>& rhs ) {
+        return Matrix<R, C>( lhs ) -= rhs;
+    }
+
+    template<typename R, typename C>
+    Matrix<R, C> operator*( const Matrix<R, C>& lhs, double rhs ) {
+        return Matrix<R, C>( lhs ) *= rhs;
+    }
+
+    template<typename R, typename C>
+    Matrix<R, C> operator*( double lhs, const Matrix<R, C>& rhs ) {
+        return Matrix<R, C>( rhs ) *= lhs;
+    }
+
+    /**
+     * Matrix product. Matrix<A, B> * Matrix<B, C> is a Matrix<A, C>; more
+     * generally the right operand may have rows B_k * S for any common
+     * quantity S, giving a Matrix<A * S, C>.
+     */
+    template<typename A, typename B, typename B2, typename C>
+    Matrix<typename detail::Scaled<A, typename detail::InnerProduct<B, B2>::Scale>::type, C>
+    operator*( const Matrix<A, B>& lhs, const Matrix<B2, C>& rhs ) {
+        using ResultType = Matrix<typename detail::Scaled<A, typename detail::InnerProduct<B, B2>::Scale>::type, C> ;
+        constexpr std::size_t n = Matrix<A, B>::ROWS ;
+        constexpr std::size_t p = Matrix<A, B>::COLS ;
+        constexpr std::size_t q = Matrix<B2, C>::COLS ;
+        ResultType result ;
+        double * r = result.data() ;
+        const double * a = lhs.data() ;
+        const double * b = rhs.data() ;
+        // i-k-j order keeps the innermost loop contiguous in b and r
+        for( std::size_t i = 0; i < n; ++i ) {
+            for( std::size_t k = 0; k < p; ++k ) {
+                const double aik = a[i * p + k] ;
+                for( std::size_t j = 0; j < q; ++j ) {
+                    r[i * q + j] += aik * b[k * q + j] ;
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Matrix-vector product. Matrix<Out, In> * In is an Out.
+     */
+    template<typename A, typename B, typename... Xs>
+    typename detail::Scaled<A, typename detail::InnerProduct<B, StateVector<Xs...>>::Scale>::type
+    operator*( const Matrix<A, B>& lhs, const StateVector<Xs...>& rhs ) {
+        using ResultType = typename detail::Scaled<A, typename detail::InnerProduct<B, StateVector<Xs...>>::Scale>::type ;
+        constexpr std::size_t n = Matrix<A, B>::ROWS ;
+        constexpr std::size_t p = Matrix<A, B>::COLS ;
+        ResultType result ;
+        const double * a = lhs.data() ;
+        const double * x = rhs.data() ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            double sum = 0 ;
+            for( std::size_t k = 0; k < p; ++k ) {
+                sum += a[i * p + k] * x[k] ;
+            }
+            result.data()[i] = sum ;
+        }
+        return result;
+    }
+
+    /**
+     * Transpose. Element (j, i) of the result has the quantity of element
+     * (i, j), so Matrix<A, B> becomes Matrix<1/B, 1/A>.
+     */
+    template<typename A, typename B>
+    Matrix<typename Reciprocal<B>::type, typename Reciprocal<A>::type>
+    transpose( const Matrix<A, B>& x ) {
+        Matrix<typename Reciprocal<B>::type, typename Reciprocal<A>::type> result ;
+        constexpr std::size_t n = Matrix<A, B>::ROWS ;
+        constexpr std::size_t p = Matrix<A, B>::COLS ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            for( std::size_t j = 0; j < p; ++j ) {
+                result( j, i ) = x( i, j ) ;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Inverse of a square matrix by Gauss-Jordan elimination with partial
+     * pivoting. The inverse of a Matrix<A, B> is a Matrix<B, A>. Throws
+     * std::domain_error if the matrix is singular.
+     */
+    template<typename A, typename B>
+    Matrix<B, A> inverse( const Matrix<A, B>& x ) {
+        constexpr std::size_t n = Matrix<A, B>::ROWS ;
+        static_assert( n == Matrix<A, B>::COLS, "Only square matrices can be inverted" );
+        double a[n * n] ;
+        Matrix<B, A> result ;
+        double * r = result.data() ;
+        for( std::size_t i = 0; i < n * n; ++i ) {
+            a[i] = x.data()[i] ;
+        }
+        for( std::size_t i = 0; i < n; ++i ) {
+            r[i * n + i] = 1.0 ;
+        }
+        for( std::size_t c = 0; c < n; ++c ) {
+            std::size_t pivot = c ;
+            for( std::size_t i = c + 1; i < n; ++i ) {
+                if( std::abs( a[i * n + c] ) > std::abs( a[pivot * n + c] ) ) {
+                    pivot = i ;
+                }
+            }
+            if( a[pivot * n + c] == 0 ) {
+                throw std::domain_error( "Matrix is singular" );
+            }
+            if( pivot != c ) {
+                for( std::size_t j = 0; j < n; ++j ) {
+                    std::swap( a[c * n + j], a[pivot * n + j] ) ;
+                    std::swap( r[c * n + j], r[pivot * n + j] ) ;
+                }
+            }
+            const double inv = 1.0 / a[c * n + c] ;
+            for( std::size_t j = 0; j < n; ++j ) {
+                a[c * n + j] *= inv ;
+                r[c * n + j] *= inv ;
+            }
+            for( std::size_t i = 0; i < n; ++i ) {
+                const double f = a[i * n + c] ;
+                if( i == c || f == 0 ) {
+                    continue;
+                }
+                for( std::size_t j = 0; j < n; ++j ) {
+                    a[i * n + j] -= f * a[c * n + j] ;
+                    r[i * n + j] -= f * r[c * n + j] ;
+                }
+            }
+        }
+        return result;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* MATRIX_HPP_ */
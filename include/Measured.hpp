@@ -0,0 +1,375 @@
+/*
+ * Measured.hpp
+ *
+ *      Quantities with a standard uncertainty. The uncertainty is propagated
+ *      to first order through the arithmetic operators, sqrt() and pow<>(),
+ *      assuming that the operands are uncorrelated. MeasuredArray<> holds
+ *      many measurements as separate value and sigma arrays so that bulk
+ *      propagation runs as plain vectorizable loops.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef MEASURED_HPP_
+#define MEASURED_HPP_
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * A value of the quantity Q with its standard deviation sigma.
+     *
+     * Every operation treats its operands as independent. An expression
+     * that uses the same measurement twice, such as x * x, therefore
+     * underestimates the uncertainty; write pow<2>( x ) instead.
+     *
+     * \code
+     * Measured<Length> width( 2_m, 0.01_m ) ;
+     * Measured<Length> height( 3_m, 0.02_m ) ;
+     * Measured<Area> area = width * height ;   // 6 m^2 +/- 0.05 m^2
+     * \endcode
+     */
+    template<typename Q>
+    class Measured {
+    public:
+        /**
+         * Type of the variance.
+         */
+        using SquareType = decltype( Q() * Q() ) ;
+
+        constexpr Measured()
+        : v( 0 ), s( 0 ) {
+        }
+
+        /**
+         * A measurement with the given value and standard deviation. A
+         * missing sigma makes an exact value.
+         */
+        constexpr Measured( const Q& value, const Q& sigma = Q() )
+        : v( value.getValue() ), s( sigma.getValue() < 0 ? -sigma.getValue() : sigma.getValue() ) {
+        }
+
+        constexpr Q value() const {
+            return Q( v );
+        }
+
+        constexpr Q sigma() const {
+            return Q( s );
+        }
+
+        constexpr SquareType variance() const {
+            return SquareType( s * s );
+        }
+
+        /**
+         * Sigma divided by the magnitude of the value.
+         */
+        double relativeError() const {
+            return s / std::abs( v );
+        }
+
+        Measured& operator+=( const Measured& rhs ) {
+            v += rhs.v ;
+            s = std::sqrt( s * s + rhs.s * rhs.s ) ;
+            return *this;
+        }
+
+        Measured& operator-=( const Measured& rhs ) {
+            v -= rhs.v ;
+            s = std::sqrt( s * s + rhs.s * rhs.s ) ;
+            return *this;
+        }
+
+        Measured& operator*=( double rhs ) {
+            v *= rhs ;
+            s *= std::abs( rhs ) ;
+            return *this;
+        }
+
+        Measured& operator/=( double rhs ) {
+            v /= rhs ;
+            s /= std::abs( rhs ) ;
+            return *this;
+        }
+
+    private:
+        double v ;
+        double s ;
+    } ;
+
+    //
+    // Arithmetic operators for Measured<> instances. Sums and differences
+    // add the variances; products and quotients add the squared relative
+    // errors.
+    //
+    template<typename Q>
+    Measured<Q> operator+( Measured<Q> lhs, const Measured<Q>& rhs ) {
+        return lhs += rhs;
+    }
+
+    template<typename Q>
+    Measured<Q> operator-( Measured<Q> lhs, const Measured<Q>& rhs ) {
+        return lhs -= rhs;
+    }
+
+    template<typename Q>
+    Measured<Q> operator-( const Measured<Q>& rhs ) {
+        return Measured<Q>( Q( -rhs.value().getValue() ), rhs.sigma() );
+    }
+
+    template<typename Q1, typename Q2>
+    Measured<decltype( Q1() * Q2() )> operator*( const Measured<Q1>& lhs, const Measured<Q2>& rhs ) {
+        using R = decltype( Q1() * Q2() ) ;
+        const double a = lhs.value().getValue(), b = rhs.value().getValue() ;
+        const double da = b * lhs.sigma().getValue(), db = a * rhs.sigma().getValue() ;
+        return Measured<R>( R( a * b ), R( std::sqrt( da * da + db * db ) ) );
+    }
+
+    template<typename Q1, typename Q2>
+    Measured<decltype( Q1() / Q2() )> operator/( const Measured<Q1>& lhs, const Measured<Q2>& rhs ) {
+        using R = decltype( Q1() / Q2() ) ;
+        const double inv = 1.0 / rhs.value().getValue() ;
+        const double q = lhs.value().getValue() * inv ;
+        const double dq = q * rhs.sigma().getValue() ;
+        const double da = lhs.sigma().getValue() ;
+        return Measured<R>( R( q ), R( std::abs( inv ) * std::sqrt( da * da + dq * dq ) ) );
+    }
+
+    template<typename Q>
+    Measured<Q> operator*( Measured<Q> lhs, double rhs ) {
+        return lhs *= rhs;
+    }
+
+    template<typename Q>
+    Measured<Q> operator*( double lhs, Measured<Q> rhs ) {
+        return rhs *= lhs;
+    }
+
+    template<typename Q>
+    Measured<Q> operator/( Measured<Q> lhs, double rhs ) {
+        return lhs /= rhs;
+    }
+
+    /**
+     * Scale a measurement by an exact quantity.
+     */
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Measured<decltype( Q() * Quantity<L, M, T, EC, TT, AS, LI>() )>
+    operator*( const Measured<Q>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        using R = decltype( Q() * rhs ) ;
+        return Measured<R>( R( lhs.value().getValue() * rhs.getValue() ), R( lhs.sigma().getValue() * rhs.getValue() ) );
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Measured<decltype( Quantity<L, M, T, EC, TT, AS, LI>() * Q() )>
+    operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Measured<Q>& rhs ) {
+        return rhs * lhs;
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Measured<decltype( Q() / Quantity<L, M, T, EC, TT, AS, LI>() )>
+    operator/( const Measured<Q>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        using R = decltype( Q() / rhs ) ;
+        return Measured<R>( R( lhs.value().getValue() / rhs.getValue() ), R( lhs.sigma().getValue() / rhs.getValue() ) );
+    }
+
+    template<typename Q, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Measured<decltype( Quantity<L, M, T, EC, TT, AS, LI>() / Q() )>
+    operator/( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Measured<Q>& rhs ) {
+        return Measured<Quantity<L, M, T, EC, TT, AS, LI>>( lhs ) / rhs;
+    }
+
+    /**
+     * Square root; the relative error is halved.
+     */
+    template<typename Q>
+    Measured<decltype( sqrt( Q() ) )> sqrt( const Measured<Q>& x ) {
+        using R = decltype( sqrt( Q() ) ) ;
+        const double r = std::sqrt( x.value().getValue() ) ;
+        const double sigma = x.sigma().getValue() ;
+        // An exact value stays exact at r = 0; an uncertain one gets an
+        // infinite sigma
+        return Measured<R>( R( r ), R( sigma == 0.0 ? 0.0 : 0.5 * sigma / r ) );
+    }
+
+    /**
+     * Integer power; the relative error is multiplied by |N|.
+     */
+    template<int N, typename Q>
+    Measured<decltype( pow<N>( Q() ) )> pow( const Measured<Q>& x ) {
+        using R = decltype( pow<N>( Q() ) ) ;
+        const double a = x.value().getValue() ;
+        // d/da a^N, computed apart from the value so that a = 0 does not
+        // give 0 * inf; zero for N = 0
+        const double slope = N == 0 ? 0.0 : N * std::pow( a, N - 1 ) ;
+        return Measured<R>( R( std::pow( a, N ) ), R( std::abs( slope ) * x.sigma().getValue() ) );
+    }
+
+    template<typename Q>
+    std::ostream& operator<<( std::ostream& os, const Measured<Q>& x )
+    {
+        os << x.value() << " +/- " << x.sigma() ;
+        return os ;
+    }
+
+    /**
+     * Many measurements of the quantity Q, stored as one array of values and
+     * one array of standard deviations. The element-wise operations below
+     * apply the same propagation rules as those of Measured<>. Their loops
+     * vectorize when sqrt() need not set errno (-fno-math-errno).
+     */
+    template<typename Q>
+    class MeasuredArray {
+    public:
+        MeasuredArray() = default ;
+
+        explicit MeasuredArray( std::size_t n )
+        : v( n ), s( n ) {
+        }
+
+        std::size_t size() const {
+            return v.size();
+        }
+
+        void reserve( std::size_t n ) {
+            v.reserve( n ) ;
+            s.reserve( n ) ;
+        }
+
+        void push_back( const Measured<Q>& x ) {
+            v.push_back( x.value().getValue() ) ;
+            s.push_back( x.sigma().getValue() ) ;
+        }
+
+        Measured<Q> operator[]( std::size_t i ) const {
+            return Measured<Q>( Q( v[i] ), Q( s[i] ) );
+        }
+
+        void set( std::size_t i, const Measured<Q>& x ) {
+            v[i] = x.value().getValue() ;
+            s[i] = x.sigma().getValue() ;
+        }
+
+        /**
+         * The values in the fundamental SI unit.
+         */
+        double * values() {
+            return v.data();
+        }
+
+        const double * values() const {
+            return v.data();
+        }
+
+        /**
+         * The standard deviations in the fundamental SI unit.
+         */
+        double * sigmas() {
+            return s.data();
+        }
+
+        const double * sigmas() const {
+            return s.data();
+        }
+
+    private:
+        std::vector<double> v ;
+        std::vector<double> s ;
+    } ;
+
+    namespace detail {
+        template<typename R, typename Q1, typename Q2, typename Op>
+        void propagate( const MeasuredArray<Q1>& lhs, const MeasuredArray<Q2>& rhs, MeasuredArray<R>& result, Op op ) {
+            if( lhs.size() != rhs.size() ) {
+                throw std::invalid_argument( "MeasuredArray: arrays differ in size" );
+            }
+            if( result.size() != lhs.size() ) {
+                result = MeasuredArray<R>( lhs.size() ) ;
+            }
+            const double * a = lhs.values(), * da = lhs.sigmas() ;
+            const double * b = rhs.values(), * db = rhs.sigmas() ;
+            double * r = result.values(), * dr = result.sigmas() ;
+            for( std::size_t i = 0; i < lhs.size(); ++i ) {
+                op( a[i], da[i], b[i], db[i], r[i], dr[i] ) ;
+            }
+        }
+    }
+
+    //
+    // Element-wise operations on MeasuredArray<> instances. The functions
+    // write to an existing array, which is resized if needed, so repeated
+    // calls do not allocate; the operators return a new array. Both throw
+    // std::invalid_argument if the operands differ in size.
+    //
+    template<typename Q>
+    void add( const MeasuredArray<Q>& lhs, const MeasuredArray<Q>& rhs, MeasuredArray<Q>& result ) {
+        detail::propagate( lhs, rhs, result, []( double a, double da, double b, double db, double& r, double& dr ) {
+            r = a + b ;
+            dr = std::sqrt( da * da + db * db ) ;
+        } ) ;
+    }
+
+    template<typename Q>
+    void subtract( const MeasuredArray<Q>& lhs, const MeasuredArray<Q>& rhs, MeasuredArray<Q>& result ) {
+        detail::propagate( lhs, rhs, result, []( double a, double da, double b, double db, double& r, double& dr ) {
+            r = a - b ;
+            dr = std::sqrt( da * da + db * db ) ;
+        } ) ;
+    }
+
+    template<typename Q1, typename Q2>
+    void multiply( const MeasuredArray<Q1>& lhs, const MeasuredArray<Q2>& rhs, MeasuredArray<decltype( Q1() * Q2() )>& result ) {
+        detail::propagate( lhs, rhs, result, []( double a, double da, double b, double db, double& r, double& dr ) {
+            const double ea = b * da, eb = a * db ;
+            r = a * b ;
+            dr = std::sqrt( ea * ea + eb * eb ) ;
+        } ) ;
+    }
+
+    template<typename Q1, typename Q2>
+    void divide( const MeasuredArray<Q1>& lhs, const MeasuredArray<Q2>& rhs, MeasuredArray<decltype( Q1() / Q2() )>& result ) {
+        detail::propagate( lhs, rhs, result, []( double a, double da, double b, double db, double& r, double& dr ) {
+            const double inv = 1.0 / b ;
+            const double q = a * inv, dq = q * db ;
+            r = q ;
+            dr = std::abs( inv ) * std::sqrt( da * da + dq * dq ) ;
+        } ) ;
+    }
+
+    template<typename Q>
+    MeasuredArray<Q> operator+( const MeasuredArray<Q>& lhs, const MeasuredArray<Q>& rhs ) {
+        MeasuredArray<Q> result ;
+        add( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q>
+    MeasuredArray<Q> operator-( const MeasuredArray<Q>& lhs, const MeasuredArray<Q>& rhs ) {
+        MeasuredArray<Q> result ;
+        subtract( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q1, typename Q2>
+    MeasuredArray<decltype( Q1() * Q2() )> operator*( const MeasuredArray<Q1>& lhs, const MeasuredArray<Q2>& rhs ) {
+        MeasuredArray<decltype( Q1() * Q2() )> result ;
+        multiply( lhs, rhs, result ) ;
+        return result;
+    }
+
+    template<typename Q1, typename Q2>
+    MeasuredArray<decltype( Q1() / Q2() )> operator/( const MeasuredArray<Q1>& lhs, const MeasuredArray<Q2>& rhs ) {
+        MeasuredArray<decltype( Q1() / Q2() )> result ;
+        divide( lhs, rhs, result ) ;
+        return result;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* MEASURED_HPP_ */
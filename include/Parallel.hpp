@@ -0,0 +1,387 @@
+/*
+ * Parallel.hpp
+ *
+ *      Data parallel algorithms over arrays of Quantity<> values, running on
+ *      a small built-in work-stealing thread pool. The result types follow
+ *      from the callables: transforming Speed values with a lambda that
+ *      multiplies by a Time produces Length values.
+ *      Link with the platform thread library (-pthread).
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+namespace parallel {
+
+    /**
+     * Default number of elements handled by one task. Small enough to
+     * balance the load, large enough to hide the cost of scheduling.
+     */
+    constexpr std::size_t DEFAULT_GRAIN = 16384 ;
+
+    /**
+     * Fixed set of worker threads. Every worker owns a queue of tasks; it
+     * takes its own tasks from the back and, when the queue is empty, steals
+     * from the front of the other queues. A thread that waits for its tasks
+     * to finish runs tasks itself, so nested parallel calls do not deadlock.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * Create a pool that runs on \c threads threads, counting the
+         * thread that calls parallelFor(). A pool of size one runs all work
+         * on the calling thread.
+         */
+        explicit ThreadPool( unsigned threads = std::thread::hardware_concurrency() )
+        : queues( std::max( 1u, threads ) ) {
+            for( std::size_t i = 1; i < queues.size(); ++i ) {
+                workers.emplace_back( [this, i]() { workerLoop( i ); } ) ;
+            }
+        }
+
+        ThreadPool( const ThreadPool& ) = delete ;
+        ThreadPool& operator=( const ThreadPool& ) = delete ;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock( sleepMutex ) ;
+                stopping = true ;
+            }
+            wakeup.notify_all() ;
+            for( auto& w : workers ) {
+                w.join() ;
+            }
+        }
+
+        /**
+         * Number of threads, including the calling thread.
+         */
+        unsigned size() const {
+            return static_cast<unsigned>( queues.size() );
+        }
+
+        /**
+         * The pool used by the free functions of this header, with one thread
+         * per hardware thread. Created on first use.
+         */
+        static ThreadPool& global() {
+            static ThreadPool pool ;
+            return pool;
+        }
+
+        /**
+         * Call body( b, e ) for consecutive sub-ranges [b, e) of [begin, end)
+         * of at most \c grain elements, in parallel, and wait for all of
+         * them. The first exception thrown by a call is rethrown here once
+         * all calls have finished.
+         */
+        template<typename Body>
+        void parallelFor( std::size_t begin, std::size_t end, std::size_t grain, const Body& body ) {
+            grain = std::max<std::size_t>( grain, 1 ) ;
+            if( end <= begin ) {
+                return;
+            }
+            const std::size_t chunks = ( end - begin + grain - 1 ) / grain ;
+            if( chunks == 1 || size() == 1 ) {
+                body( begin, end ) ;
+                return;
+            }
+
+            Job job ;
+            job.run = []( const void * f, std::size_t b, std::size_t e ) {
+                ( *static_cast<const Body *>( f ) )( b, e ) ;
+            } ;
+            job.body = &body ;
+            job.pending = chunks ;
+
+            // Deal the chunks round-robin, starting with the own queue
+            const std::size_t self = currentQueue() ;
+            for( std::size_t c = 0; c < chunks; ++c ) {
+                const std::size_t b = begin + c * grain ;
+                Queue& q = queues[( self + c ) % queues.size()] ;
+                std::lock_guard<std::mutex> lock( q.mutex ) ;
+                q.tasks.push_back( Task{ &job, b, std::min( end, b + grain ) } ) ;
+            }
+            {
+                std::lock_guard<std::mutex> lock( sleepMutex ) ;
+                queued += chunks ;
+            }
+            wakeup.notify_all() ;
+
+            while( job.pending.load( std::memory_order_acquire ) > 0 ) {
+                if( !runOne( self ) ) {
+                    std::this_thread::yield() ;
+                }
+            }
+            if( job.error ) {
+                std::rethrow_exception( job.error );
+            }
+        }
+
+    private:
+        struct Job {
+            void (*run)( const void *, std::size_t, std::size_t ) ;
+            const void * body ;
+            std::atomic<std::size_t> pending ;
+            std::mutex errorMutex ;
+            std::exception_ptr error ;
+        } ;
+
+        struct Task {
+            Job * job ;
+            std::size_t begin ;
+            std::size_t end ;
+        } ;
+
+        struct Queue {
+            std::mutex mutex ;
+            std::deque<Task> tasks ;
+        } ;
+
+        /**
+         * Queue of the calling thread: its own queue for a worker of this
+         * pool, the first queue for any other thread.
+         */
+        std::size_t currentQueue() const {
+            return owner() == this ? index() : 0;
+        }
+
+        static const ThreadPool *& owner() {
+            static thread_local const ThreadPool * pool = nullptr ;
+            return pool;
+        }
+
+        static std::size_t& index() {
+            static thread_local std::size_t i = 0 ;
+            return i;
+        }
+
+        bool take( std::size_t self, Task& task ) {
+            for( std::size_t k = 0; k < queues.size(); ++k ) {
+                Queue& q = queues[( self + k ) % queues.size()] ;
+                std::lock_guard<std::mutex> lock( q.mutex ) ;
+                if( !q.tasks.empty() ) {
+                    if( k == 0 ) {
+                        task = q.tasks.back() ;
+                        q.tasks.pop_back() ;
+                    } else {
+                        task = q.tasks.front() ;
+                        q.tasks.pop_front() ;
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Run one task from the own queue or stolen from another queue.
+         * Returns false if all queues are empty.
+         */
+        bool runOne( std::size_t self ) {
+            Task task ;
+            if( !take( self, task ) ) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock( sleepMutex ) ;
+                --queued ;
+            }
+            Job& job = *task.job ;
+            try {
+                job.run( job.body, task.begin, task.end ) ;
+            } catch( ... ) {
+                std::lock_guard<std::mutex> lock( job.errorMutex ) ;
+                if( !job.error ) {
+                    job.error = std::current_exception() ;
+                }
+            }
+            job.pending.fetch_sub( 1, std::memory_order_release ) ;
+            return true;
+        }
+
+        void workerLoop( std::size_t self ) {
+            owner() = this ;
+            index() = self ;
+            for( ;; ) {
+                if( runOne( self ) ) {
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock( sleepMutex ) ;
+                wakeup.wait( lock, [this]() { return stopping || queued > 0; } ) ;
+                if( stopping ) {
+                    return;
+                }
+            }
+        }
+
+        std::vector<Queue> queues ;
+        std::vector<std::thread> workers ;
+        std::mutex sleepMutex ;
+        std::condition_variable wakeup ;
+        std::size_t queued = 0 ;
+        bool stopping = false ;
+    } ;
+
+    /**
+     * Call f( x ) for every element of [first, last). \c f may modify the
+     * elements.
+     */
+    template<typename T, typename F>
+    void for_each( T * first, T * last, F f, std::size_t grain = DEFAULT_GRAIN,
+                   ThreadPool& pool = ThreadPool::global() ) {
+        pool.parallelFor( 0, last - first, grain, [first, &f]( std::size_t b, std::size_t e ) {
+            for( std::size_t i = b; i < e; ++i ) {
+                f( first[i] ) ;
+            }
+        } ) ;
+    }
+
+    /**
+     * Store f( x ) of every element of [first, last) in \c out. Returns the
+     * end of the output.
+     */
+    template<typename T, typename U, typename F>
+    U * transform( const T * first, const T * last, U * out, F f, std::size_t grain = DEFAULT_GRAIN,
+                   ThreadPool& pool = ThreadPool::global() ) {
+        pool.parallelFor( 0, last - first, grain, [first, out, &f]( std::size_t b, std::size_t e ) {
+            for( std::size_t i = b; i < e; ++i ) {
+                out[i] = f( first[i] ) ;
+            }
+        } ) ;
+        return out + ( last - first );
+    }
+
+    /**
+     * Element-wise f( x ) of a vector. The element type of the result is the
+     * return type of \c f, e.g. a vector of Length for a Speed * Time lambda.
+     */
+    template<typename T, typename F>
+    std::vector<decltype( std::declval<F&>()( std::declval<const T&>() ) )>
+    transform( const std::vector<T>& in, F f, std::size_t grain = DEFAULT_GRAIN,
+               ThreadPool& pool = ThreadPool::global() ) {
+        std::vector<decltype( f( std::declval<const T&>() ) )> out( in.size() ) ;
+        transform( in.data(), in.data() + in.size(), out.data(), f, grain, pool ) ;
+        return out;
+    }
+
+    /**
+     * Combine all elements of [first, last) and \c init with the
+     * associative operation \c op. Every task reduces its own range in
+     * order and the partial results are combined in order, so the result
+     * does not depend on the number of threads.
+     */
+    template<typename T, typename R, typename Op>
+    R reduce( const T * first, const T * last, R init, Op op, std::size_t grain = DEFAULT_GRAIN,
+              ThreadPool& pool = ThreadPool::global() ) {
+        const std::size_t n = last - first ;
+        grain = std::max<std::size_t>( grain, 1 ) ;
+        const std::size_t chunks = ( n + grain - 1 ) / grain ;
+        std::vector<R> partial( chunks ) ;
+        pool.parallelFor( 0, chunks, 1, [&]( std::size_t b, std::size_t e ) {
+            for( std::size_t c = b; c < e; ++c ) {
+                const std::size_t end = std::min( n, ( c + 1 ) * grain ) ;
+                R sum = first[c * grain] ;
+                for( std::size_t i = c * grain + 1; i < end; ++i ) {
+                    sum = op( sum, first[i] ) ;
+                }
+                partial[c] = sum ;
+            }
+        } ) ;
+        for( const R& p : partial ) {
+            init = op( init, p ) ;
+        }
+        return init;
+    }
+
+    /**
+     * Sum of all elements of [first, last).
+     */
+    template<typename T>
+    T reduce( const T * first, const T * last, std::size_t grain = DEFAULT_GRAIN,
+              ThreadPool& pool = ThreadPool::global() ) {
+        return reduce( first, last, T(), std::plus<T>(), grain, pool );
+    }
+
+    /**
+     * Store the running combination out[i] = init op x[0] op ... op x[i] of
+     * [first, last) in \c out, e.g. timestamps from Time deltas. Blocked
+     * two-pass scan: the blocks are reduced in parallel, the block totals
+     * are scanned in order and the blocks are then scanned in parallel from
+     * their offsets. Returns the end of the output.
+     */
+    template<typename T, typename U, typename Op>
+    U * inclusive_scan( const T * first, const T * last, U * out, Op op, U init,
+                        std::size_t grain = DEFAULT_GRAIN, ThreadPool& pool = ThreadPool::global() ) {
+        const std::size_t n = last - first ;
+        grain = std::max<std::size_t>( grain, 1 ) ;
+        const std::size_t chunks = ( n + grain - 1 ) / grain ;
+        if( chunks <= 1 || pool.size() == 1 ) {
+            for( std::size_t i = 0; i < n; ++i ) {
+                init = op( init, first[i] ) ;
+                out[i] = init ;
+            }
+            return out + n;
+        }
+
+        // Totals of all blocks but the last, scanned into the starting value
+        // of every block
+        std::vector<U> offset( chunks ) ;
+        pool.parallelFor( 0, chunks - 1, 1, [&]( std::size_t b, std::size_t e ) {
+            for( std::size_t c = b; c < e; ++c ) {
+                U sum = first[c * grain] ;
+                for( std::size_t i = c * grain + 1; i < ( c + 1 ) * grain; ++i ) {
+                    sum = op( sum, first[i] ) ;
+                }
+                offset[c + 1] = sum ;
+            }
+        } ) ;
+        offset[0] = init ;
+        for( std::size_t c = 1; c < chunks; ++c ) {
+            offset[c] = op( offset[c - 1], offset[c] ) ;
+        }
+
+        pool.parallelFor( 0, chunks, 1, [&]( std::size_t b, std::size_t e ) {
+            for( std::size_t c = b; c < e; ++c ) {
+                const std::size_t end = std::min( n, ( c + 1 ) * grain ) ;
+                U sum = offset[c] ;
+                for( std::size_t i = c * grain; i < end; ++i ) {
+                    sum = op( sum, first[i] ) ;
+                    out[i] = sum ;
+                }
+            }
+        } ) ;
+        return out + n;
+    }
+
+    /**
+     * Running sum of [first, last).
+     */
+    template<typename T>
+    T * inclusive_scan( const T * first, const T * last, T * out, std::size_t grain = DEFAULT_GRAIN,
+                        ThreadPool& pool = ThreadPool::global() ) {
+        return inclusive_scan( first, last, out, std::plus<T>(), T(), grain, pool );
+    }
+
+}
+// namespace parallel;
+}
+// namespace SciQ;
+
+#endif /* PARALLEL_HPP_ */
@@ -0,0 +1,441 @@
+/*
+ * ParticleSystem.hpp
+ *
+ *      Gravitational N-body system with positions (Length), velocities
+ *      (Speed) and masses (Mass) stored as structure of arrays. The forces
+ *      are computed either directly in O(N^2) or with a Barnes-Hut octree in
+ *      O(N log N); both kernels run on a parallel::ThreadPool.
+ *      Link with the platform thread library (-pthread). The direct kernel
+ *      vectorizes when sqrt() need not set errno (-fno-math-errno).
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef PARTICLESYSTEM_HPP_
+#define PARTICLESYSTEM_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "PhysicalConstants.hpp"
+#include "Parallel.hpp"
+#include "Vector.hpp"
+
+namespace SciQ {
+
+    /**
+     * Algorithm used to compute the gravitational accelerations.
+     */
+    enum class GravityMethod {
+        Direct,     ///< Exact sum over all pairs, O(N^2)
+        BarnesHut   ///< Octree approximation, O(N log N)
+    } ;
+
+    /**
+     * A set of point masses that attract each other by Newtonian gravity.
+     *
+     * The state is kept in fundamental SI units in separate arrays per
+     * component, so the force kernels run over contiguous doubles. A
+     * softening length can be given to bound the force between close
+     * particles: the pair distance r is replaced by sqrt( r^2 + eps^2 ).
+     *
+     * \code
+     * ParticleSystem system ;
+     * system.add( Vec3<Length>(), Vec3<Speed>(), MassOfEarth ) ;
+     * system.add( Vec3<Length>( 7000_km, 0_m, 0_m ), Vec3<Speed>( 0_mps, 7546_mps, 0_mps ), 1_kg ) ;
+     * for( int i = 0; i < 100; ++i ) {
+     *     system.step( 1_s ) ;
+     * }
+     * \endcode
+     */
+    class ParticleSystem {
+    public:
+        explicit ParticleSystem( const Length& softening = Length() )
+        : eps2( std::max( softening.getValue() * softening.getValue(), double( MIN_SOFTENING2 ) ) ),
+          pool( &parallel::ThreadPool::global() ) {
+        }
+
+        void reserve( std::size_t n ) {
+            for( auto * a : { &x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az, &m } ) {
+                a->reserve( n ) ;
+            }
+        }
+
+        /**
+         * Add a particle and return its index.
+         */
+        std::size_t add( const Vec3<Length>& position, const Vec3<Speed>& velocity, const Mass& mass ) {
+            x.push_back( position.x().getValue() ) ;
+            y.push_back( position.y().getValue() ) ;
+            z.push_back( position.z().getValue() ) ;
+            vx.push_back( velocity.x().getValue() ) ;
+            vy.push_back( velocity.y().getValue() ) ;
+            vz.push_back( velocity.z().getValue() ) ;
+            ax.push_back( 0 ) ;
+            ay.push_back( 0 ) ;
+            az.push_back( 0 ) ;
+            m.push_back( mass.getValue() ) ;
+            accelerationsValid = false ;
+            return m.size() - 1;
+        }
+
+        std::size_t size() const {
+            return m.size();
+        }
+
+        Vec3<Length> position( std::size_t i ) const {
+            return Vec3<Length>( Length( x[i] ), Length( y[i] ), Length( z[i] ) );
+        }
+
+        Vec3<Speed> velocity( std::size_t i ) const {
+            return Vec3<Speed>( Speed( vx[i] ), Speed( vy[i] ), Speed( vz[i] ) );
+        }
+
+        Mass mass( std::size_t i ) const {
+            return Mass( m[i] );
+        }
+
+        /**
+         * Acceleration of particle \c i from the last force computation.
+         */
+        Vec3<Acceleration> acceleration( std::size_t i ) const {
+            return Vec3<Acceleration>( Acceleration( ax[i] ), Acceleration( ay[i] ), Acceleration( az[i] ) );
+        }
+
+        /**
+         * Contiguous array of the positions along axis \c c (0, 1 or 2) in
+         * meters.
+         */
+        const double * positionData( std::size_t c ) const {
+            return c == 0 ? x.data() : c == 1 ? y.data() : z.data();
+        }
+
+        /**
+         * Contiguous array of the velocities along axis \c c in m/s.
+         */
+        const double * velocityData( std::size_t c ) const {
+            return c == 0 ? vx.data() : c == 1 ? vy.data() : vz.data();
+        }
+
+        const double * massData() const {
+            return m.data();
+        }
+
+        /**
+         * Thread pool that runs the force kernels. Defaults to the global
+         * pool. The pool must outlive the system.
+         */
+        void setPool( parallel::ThreadPool& pool ) {
+            this->pool = &pool ;
+        }
+
+        parallel::ThreadPool& getPool() const {
+            return *pool;
+        }
+
+        /**
+         * Select the force algorithm. \c theta is the opening angle of the
+         * Barnes-Hut method: a cell of size s at distance d is treated as a
+         * point mass if s / d < theta. Smaller values are more accurate.
+         */
+        void setMethod( GravityMethod method, double theta = 0.5 ) {
+            this->method = method ;
+            this->theta = theta ;
+            accelerationsValid = false ;
+        }
+
+        GravityMethod getMethod() const {
+            return method;
+        }
+
+        /**
+         * Compute the acceleration of every particle with the selected
+         * method.
+         */
+        void computeAccelerations() {
+            if( method == GravityMethod::BarnesHut ) {
+                buildTree() ;
+                pool->parallelFor( 0, size(), TREE_GRAIN, [this]( std::size_t begin, std::size_t end ) {
+                    treeKernel( begin, end ) ;
+                } ) ;
+            } else {
+                pool->parallelFor( 0, size(), TILE, [this]( std::size_t begin, std::size_t end ) {
+                    directKernel( begin, end ) ;
+                } ) ;
+            }
+            accelerationsValid = true ;
+        }
+
+        /**
+         * Advance the system by \c dt with the kick-drift-kick leapfrog
+         * scheme. The scheme is symplectic, so the energy of a bound system
+         * does not drift. One force computation is needed per step.
+         */
+        void step( const Time& dt ) {
+            if( !accelerationsValid ) {
+                computeAccelerations() ;
+            }
+            const double h = dt.getValue() ;
+            kick( 0.5 * h ) ;
+            const std::size_t n = size() ;
+            for( std::size_t i = 0; i < n; ++i ) {
+                x[i] += vx[i] * h ;
+                y[i] += vy[i] * h ;
+                z[i] += vz[i] * h ;
+            }
+            computeAccelerations() ;
+            kick( 0.5 * h ) ;
+        }
+
+        Energy kineticEnergy() const {
+            double e = 0 ;
+            for( std::size_t i = 0; i < size(); ++i ) {
+                e += 0.5 * m[i] * ( vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i] ) ;
+            }
+            return Energy( e );
+        }
+
+        /**
+         * Gravitational potential energy, summed exactly over all pairs.
+         */
+        Energy potentialEnergy() const {
+            double e = 0 ;
+            for( std::size_t i = 0; i < size(); ++i ) {
+                for( std::size_t j = i + 1; j < size(); ++j ) {
+                    const double dx = x[j] - x[i], dy = y[j] - y[i], dz = z[j] - z[i] ;
+                    e -= m[i] * m[j] / std::sqrt( dx * dx + dy * dy + dz * dz + eps2 ) ;
+                }
+            }
+            return Energy( G * e );
+        }
+
+        Energy totalEnergy() const {
+            return kineticEnergy() + potentialEnergy();
+        }
+
+    private:
+        static constexpr double G = GravitationalConstant.getValue() ;
+
+        /**
+         * Lower bound of the squared softening length in m^2. It keeps the
+         * interaction of a particle with itself at 0 * finite instead of
+         * 0 * inf, so the kernels need no test for i == j, and is far below
+         * any distance that matters.
+         */
+        static constexpr double MIN_SOFTENING2 = 1e-100 ;
+
+        /**
+         * Number of target particles whose accelerations are accumulated
+         * together in the direct kernel. The source loop is the outer loop,
+         * so the inner loop over the targets has no reduction and vectorizes
+         * without reordering any floating point sum. The targets of a tile
+         * and their sums, 24 KiB, stay in the L1 cache.
+         */
+        static constexpr std::size_t TILE = 512 ;
+
+        /**
+         * Cell of the Barnes-Hut octree. A leaf holds at most one particle
+         * unless the cell became too small to split further.
+         */
+        struct Node {
+            double cx, cy, cz, half ;   // Geometric center and half size
+            double mx, my, mz, mass ;   // Center of mass (while building: mass weighted sum) and total mass
+            std::int32_t child[8] ;
+            std::int32_t particle ;     // -1: empty or internal, >= 0: single particle
+            bool leaf ;
+        } ;
+
+        static constexpr int MAX_DEPTH = 48 ;
+
+        /**
+         * Number of particles per task of the Barnes-Hut kernel.
+         */
+        static constexpr std::size_t TREE_GRAIN = 256 ;
+
+        void kick( double h ) {
+            const std::size_t n = size() ;
+            for( std::size_t i = 0; i < n; ++i ) {
+                vx[i] += ax[i] * h ;
+                vy[i] += ay[i] * h ;
+                vz[i] += az[i] * h ;
+            }
+        }
+
+        void directKernel( std::size_t begin, std::size_t end ) {
+            const std::size_t n = size() ;
+            const double * px = x.data(), * py = y.data(), * pz = z.data(), * pm = m.data() ;
+            // Local copies of the targets of a tile cannot alias the sources
+            double tx[TILE], ty[TILE], tz[TILE], sx[TILE], sy[TILE], sz[TILE] ;
+            for( std::size_t first = begin; first < end; first += TILE ) {
+                const std::size_t count = std::min( end - first, std::size_t( TILE ) ) ;
+                for( std::size_t i = 0; i < count; ++i ) {
+                    tx[i] = px[first + i] ;
+                    ty[i] = py[first + i] ;
+                    tz[i] = pz[first + i] ;
+                    sx[i] = sy[i] = sz[i] = 0 ;
+                }
+                for( std::size_t j = 0; j < n; ++j ) {
+                    const double xj = px[j], yj = py[j], zj = pz[j], mj = pm[j] ;
+                    for( std::size_t i = 0; i < count; ++i ) {
+                        const double dx = xj - tx[i], dy = yj - ty[i], dz = zj - tz[i] ;
+                        const double inv = 1.0 / std::sqrt( dx * dx + dy * dy + dz * dz + eps2 ) ;
+                        const double s = mj * inv * inv * inv ;
+                        sx[i] += s * dx ;
+                        sy[i] += s * dy ;
+                        sz[i] += s * dz ;
+                    }
+                }
+                for( std::size_t i = 0; i < count; ++i ) {
+                    ax[first + i] = G * sx[i] ;
+                    ay[first + i] = G * sy[i] ;
+                    az[first + i] = G * sz[i] ;
+                }
+            }
+        }
+
+        std::int32_t newNode( double cx, double cy, double cz, double half ) {
+            Node node ;
+            node.cx = cx ;
+            node.cy = cy ;
+            node.cz = cz ;
+            node.half = half ;
+            node.mx = node.my = node.mz = node.mass = 0 ;
+            std::fill( node.child, node.child + 8, -1 ) ;
+            node.particle = -1 ;
+            node.leaf = true ;
+            tree.push_back( node ) ;
+            return static_cast<std::int32_t>( tree.size() - 1 );
+        }
+
+        int octant( const Node& node, std::size_t i ) const {
+            return ( x[i] >= node.cx ? 1 : 0 ) | ( y[i] >= node.cy ? 2 : 0 ) | ( z[i] >= node.cz ? 4 : 0 );
+        }
+
+        std::int32_t childOf( std::int32_t parent, int o ) {
+            if( tree[parent].child[o] < 0 ) {
+                const double h = tree[parent].half * 0.5 ;
+                const std::int32_t c = newNode( tree[parent].cx + ( o & 1 ? h : -h ),
+                                                tree[parent].cy + ( o & 2 ? h : -h ),
+                                                tree[parent].cz + ( o & 4 ? h : -h ), h ) ;
+                tree[parent].child[o] = c ;
+            }
+            return tree[parent].child[o];
+        }
+
+        void insert( std::size_t i ) {
+            std::int32_t node = 0 ;
+            for( int depth = 0; ; ++depth ) {
+                Node& n = tree[node] ;
+                const bool empty = n.mass == 0 && n.particle < 0 && std::all_of( n.child, n.child + 8, []( std::int32_t c ) { return c < 0; } ) ;
+                n.mass += m[i] ;
+                n.mx += m[i] * x[i] ;
+                n.my += m[i] * y[i] ;
+                n.mz += m[i] * z[i] ;
+                if( empty ) {
+                    n.particle = static_cast<std::int32_t>( i ) ;
+                    return;
+                }
+                if( depth >= MAX_DEPTH ) {
+                    // Coincident particles: keep them aggregated in this leaf
+                    n.particle = -1 ;
+                    return;
+                }
+                if( n.particle >= 0 ) {
+                    // Push the resident particle one level down
+                    const std::size_t j = static_cast<std::size_t>( n.particle ) ;
+                    tree[node].particle = -1 ;
+                    const std::int32_t c = childOf( node, octant( tree[node], j ) ) ;
+                    Node& cn = tree[c] ;
+                    cn.mass = m[j] ;
+                    cn.mx = m[j] * x[j] ;
+                    cn.my = m[j] * y[j] ;
+                    cn.mz = m[j] * z[j] ;
+                    cn.particle = static_cast<std::int32_t>( j ) ;
+                }
+                node = childOf( node, octant( tree[node], i ) ) ;
+            }
+        }
+
+        void buildTree() {
+            tree.clear() ;
+            const std::size_t n = size() ;
+            if( n == 0 ) {
+                return;
+            }
+            const auto bx = std::minmax_element( x.begin(), x.end() ) ;
+            const auto by = std::minmax_element( y.begin(), y.end() ) ;
+            const auto bz = std::minmax_element( z.begin(), z.end() ) ;
+            const double half = 0.5 * std::max( { *bx.second - *bx.first, *by.second - *by.first, *bz.second - *bz.first } ) ;
+            tree.reserve( 2 * n ) ;
+            newNode( 0.5 * ( *bx.first + *bx.second ), 0.5 * ( *by.first + *by.second ),
+                     0.5 * ( *bz.first + *bz.second ), half * ( 1 + 1e-12 ) + 1e-300 ) ;
+            for( std::size_t i = 0; i < n; ++i ) {
+                insert( i ) ;
+            }
+            for( Node& node : tree ) {
+                if( node.mass > 0 ) {
+                    node.mx /= node.mass ;
+                    node.my /= node.mass ;
+                    node.mz /= node.mass ;
+                }
+                node.leaf = std::all_of( node.child, node.child + 8, []( std::int32_t c ) { return c < 0; } ) ;
+            }
+        }
+
+        void treeKernel( std::size_t begin, std::size_t end ) {
+            const double theta2 = theta * theta ;
+            std::vector<std::int32_t> stack ;
+            stack.reserve( 8 * MAX_DEPTH ) ;
+            for( std::size_t i = begin; i < end; ++i ) {
+                const double xi = x[i], yi = y[i], zi = z[i] ;
+                double sx = 0, sy = 0, sz = 0 ;
+                stack.assign( 1, 0 ) ;
+                while( !stack.empty() ) {
+                    const Node& node = tree[stack.back()] ;
+                    stack.pop_back() ;
+                    if( node.mass == 0 || node.particle == static_cast<std::int32_t>( i ) ) {
+                        continue;
+                    }
+                    const double dx = node.mx - xi ;
+                    const double dy = node.my - yi ;
+                    const double dz = node.mz - zi ;
+                    const double d2 = dx * dx + dy * dy + dz * dz ;
+                    const double size = 2 * node.half ;
+                    if( node.leaf || size * size < theta2 * d2 ) {
+                        const double inv = 1.0 / std::sqrt( d2 + eps2 ) ;
+                        const double s = node.mass * inv * inv * inv ;
+                        sx += s * dx ;
+                        sy += s * dy ;
+                        sz += s * dz ;
+                    } else {
+                        for( std::int32_t c : node.child ) {
+                            if( c >= 0 ) {
+                                stack.push_back( c ) ;
+                            }
+                        }
+                    }
+                }
+                ax[i] = G * sx ;
+                ay[i] = G * sy ;
+                az[i] = G * sz ;
+            }
+        }
+
+        std::vector<double> x, y, z ;
+        std::vector<double> vx, vy, vz ;
+        std::vector<double> ax, ay, az ;
+        std::vector<double> m ;
+        std::vector<Node> tree ;
+        double eps2 ;
+        parallel::ThreadPool * pool ;
+        GravityMethod method = GravityMethod::Direct ;
+        double theta = 0.5 ;
+        bool accelerationsValid = false ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* PARTICLESYSTEM_HPP_ */
@@ -0,0 +1,414 @@
+/*
+ * QuantileSketch.hpp
+ *
+ *      Quantiles of quantity streams without storing the samples: a
+ *      merging t-digest keeps the distribution as some dozens of weighted
+ *      centroids that are small near the tails, so p99 and p999 stay
+ *      accurate. Sketches of several threads or nodes are merged, and
+ *      travel as a compact byte string whose header records the dimension.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef QUANTILESKETCH_HPP_
+#define QUANTILESKETCH_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "BinaryIO.hpp"
+#include "Sort.hpp"
+
+namespace SciQ {
+
+    /**
+     * Magic bytes at the start of every serialized sketch.
+     */
+    constexpr char SKETCH_MAGIC[4] = { 'S', 'c', 'i', 'T' } ;
+
+    /**
+     * Version of the serialized sketch format.
+     */
+    constexpr std::uint16_t SKETCH_VERSION = 1 ;
+
+    /**
+     * Size of the fixed part of a serialized sketch.
+     */
+    constexpr std::size_t SKETCH_HEADER_SIZE = 64 ;
+
+    /**
+     * Sketch of the distribution of a stream of Q samples, a merging
+     * t-digest with the arcsine scale function. Samples are collected in a
+     * buffer that is radix sorted and merged into the centroids when it is
+     * full, so add() is amortized O(1). With the default compression of
+     * 100 a sketch holds at most about 60 centroids. The rank error of a
+     * quantile is a fraction of 1 / compression at the median and shrinks
+     * towards the tails, where centroids hold only a few samples. NaN
+     * samples are only counted.
+     *
+     * A sketch is not safe for concurrent use, not even for quantile(),
+     * which merges the buffer. Give every thread its own sketch and merge
+     * them.
+     *
+     * \code
+     * QuantileSketch<Time> latency ;
+     * latency.add( 3.2_ms ) ;
+     * Time p99 = latency.quantile( 0.99 ) ;
+     * \endcode
+     */
+    template<typename Q>
+    class QuantileSketch {
+    public:
+        explicit QuantileSketch( double compression = 100.0 )
+        : delta( compression ), total( 0.0 ), sum( 0.0 ), lowest( std::numeric_limits<double>::infinity() ),
+          highest( -std::numeric_limits<double>::infinity() ), nans( 0 ) {
+            if( !( compression >= 10.0 && compression <= 1e5 ) ) {
+                throw std::invalid_argument( "QuantileSketch compression must be within 10 to 100000" );
+            }
+            buffer.reserve( capacity() ) ;
+        }
+
+        void add( const Q& x ) {
+            const double v = x.getValue() ;
+            if( v != v ) {
+                ++nans ;
+                return;
+            }
+            lowest = std::min( lowest, v ) ;
+            highest = std::max( highest, v ) ;
+            sum += v ;
+            buffer.push_back( detail::sortKey( v ) ) ;
+            if( buffer.size() >= capacity() ) {
+                compress() ;
+            }
+        }
+
+        void add( const Q * x, std::size_t n ) {
+            for( std::size_t i = 0; i < n; ++i ) {
+                add( x[i] ) ;
+            }
+        }
+
+        void add( const std::vector<Q>& x ) {
+            add( x.data(), x.size() ) ;
+        }
+
+        /**
+         * Merge the samples of \c rhs into this sketch. The compression
+         * of this sketch is kept.
+         */
+        QuantileSketch& operator+=( const QuantileSketch& rhs ) {
+            rhs.compress() ;
+            compress() ;
+            std::vector<Centroid> all ;
+            all.reserve( centroids.size() + rhs.centroids.size() ) ;
+            std::merge( centroids.begin(), centroids.end(), rhs.centroids.begin(), rhs.centroids.end(),
+                        std::back_inserter( all ), []( const Centroid& a, const Centroid& b ) { return a.mean < b.mean; } ) ;
+            total += rhs.total ;
+            sum += rhs.sum ;
+            lowest = std::min( lowest, rhs.lowest ) ;
+            highest = std::max( highest, rhs.highest ) ;
+            nans += rhs.nans ;
+            cluster( all ) ;
+            return *this;
+        }
+
+        /**
+         * Number of samples, without the NaNs.
+         */
+        std::uint64_t count() const {
+            return std::uint64_t( total ) + buffer.size();
+        }
+
+        std::uint64_t missing() const {
+            return nans;
+        }
+
+        double compression() const {
+            return delta;
+        }
+
+        Q min() const {
+            requireSamples() ;
+            return Q( lowest );
+        }
+
+        Q max() const {
+            requireSamples() ;
+            return Q( highest );
+        }
+
+        Q mean() const {
+            requireSamples() ;
+            return Q( sum / double( count() ) );
+        }
+
+        /**
+         * Estimate of the \c q quantile, from 0 to 1. The minimum and
+         * maximum are exact. Throws std::domain_error if the sketch holds
+         * no samples.
+         */
+        Q quantile( double q ) const {
+            requireSamples() ;
+            compress() ;
+            const double rank = std::min( std::max( q, 0.0 ), 1.0 ) * total ;
+            const Centroid& first = centroids.front() ;
+            const Centroid& last = centroids.back() ;
+            // The samples of a centroid are taken to be spread evenly around
+            // its mean, so its center lies at the weight before it plus half
+            // its own weight. Beyond the outer centers interpolate towards
+            // the exact extremes.
+            if( rank < 1.0 ) {
+                return Q( lowest );
+            }
+            if( first.weight > 1.0 && rank < first.weight / 2.0 ) {
+                return Q( lowest + ( rank - 1.0 ) / ( first.weight / 2.0 - 1.0 ) * ( first.mean - lowest ) );
+            }
+            if( rank > total - 1.0 ) {
+                return Q( highest );
+            }
+            if( last.weight > 1.0 && total - rank < last.weight / 2.0 ) {
+                return Q( highest - ( total - rank - 1.0 ) / ( last.weight / 2.0 - 1.0 ) * ( highest - last.mean ) );
+            }
+            double center = first.weight / 2.0 ;
+            for( std::size_t i = 0; i + 1 < centroids.size(); ++i ) {
+                const Centroid& a = centroids[i] ;
+                const Centroid& b = centroids[i + 1] ;
+                const double step = ( a.weight + b.weight ) / 2.0 ;
+                if( center + step > rank ) {
+                    // A single sample is not spread: it owns half a rank
+                    // on either side of its value
+                    double left = 0.0, right = 0.0 ;
+                    if( a.weight == 1.0 ) {
+                        if( rank - center < 0.5 ) {
+                            return Q( a.mean );
+                        }
+                        left = 0.5 ;
+                    }
+                    if( b.weight == 1.0 ) {
+                        if( center + step - rank <= 0.5 ) {
+                            return Q( b.mean );
+                        }
+                        right = 0.5 ;
+                    }
+                    const double toA = rank - center - left ;
+                    const double toB = center + step - rank - right ;
+                    return Q( ( a.mean * toB + b.mean * toA ) / ( toA + toB ) );
+                }
+                center += step ;
+            }
+            const double toLast = rank - ( total - last.weight / 2.0 ) ;
+            const double toHighest = last.weight / 2.0 - toLast ;
+            return Q( ( last.mean * toHighest + highest * toLast ) / ( toLast + toHighest ) );
+        }
+
+        /**
+         * Number of centroids after merging the buffer.
+         */
+        std::size_t size() const {
+            compress() ;
+            return centroids.size();
+        }
+
+        /**
+         * Memory held by the sketch in bytes.
+         */
+        std::size_t bytes() const {
+            return sizeof(*this) + buffer.capacity() * sizeof(std::uint64_t)
+                 + centroids.capacity() * sizeof(Centroid);
+        }
+
+        /**
+         * Serialize the sketch: a fixed header followed by the centroids,
+         * each as its mean and its weight as a LEB128 varint.
+         *
+         * Layout (all fields little-endian):
+         *
+         * | Offset | Size | Field                                  |
+         * |--------|------|----------------------------------------|
+         * | 0      | 4    | magic "SciT"                           |
+         * | 4      | 2    | format version                          |
+         * | 6      | 2    | reserved (0)                           |
+         * | 8      | 8    | packed Dimension                       |
+         * | 16     | 8    | compression                            |
+         * | 24     | 8    | minimum                                |
+         * | 32     | 8    | maximum                                |
+         * | 40     | 8    | sum                                    |
+         * | 48     | 8    | number of NaN samples                  |
+         * | 56     | 4    | number of centroids                    |
+         * | 60     | 4    | reserved (0)                           |
+         */
+        std::vector<unsigned char> serialize() const {
+            compress() ;
+            std::vector<unsigned char> out( SKETCH_HEADER_SIZE, 0 ) ;
+            std::memcpy( out.data(), SKETCH_MAGIC, sizeof(SKETCH_MAGIC) ) ;
+            detail::storeLE( out.data() + 4, SKETCH_VERSION ) ;
+            detail::storeLE( out.data() + 8, dimensionOf<Q>().getPacked() ) ;
+            detail::storeLE( out.data() + 16, delta ) ;
+            detail::storeLE( out.data() + 24, lowest ) ;
+            detail::storeLE( out.data() + 32, highest ) ;
+            detail::storeLE( out.data() + 40, sum ) ;
+            detail::storeLE( out.data() + 48, nans ) ;
+            detail::storeLE( out.data() + 56, std::uint32_t( centroids.size() ) ) ;
+            for( const Centroid& c : centroids ) {
+                unsigned char mean[8] ;
+                detail::storeLE( mean, c.mean ) ;
+                out.insert( out.end(), mean, mean + 8 ) ;
+                for( std::uint64_t w = std::uint64_t( c.weight ); ; w >>= 7 ) {
+                    out.push_back( static_cast<unsigned char>( ( w & 0x7f ) | ( w >= 0x80 ? 0x80 : 0 ) ) ) ;
+                    if( w < 0x80 ) {
+                        break ;
+                    }
+                }
+            }
+            return out;
+        }
+
+        /**
+         * Read a sketch written by serialize(). Throws std::runtime_error
+         * if the bytes do not hold a valid sketch and std::invalid_argument
+         * if its dimension is not the one of Q.
+         */
+        static QuantileSketch deserialize( const unsigned char * in, std::size_t size ) {
+            if( size < SKETCH_HEADER_SIZE || std::memcmp( in, SKETCH_MAGIC, sizeof(SKETCH_MAGIC) ) != 0 ||
+                detail::loadLE<std::uint16_t>( in + 4 ) != SKETCH_VERSION ) {
+                throw std::runtime_error( "QuantileSketch: invalid header" );
+            }
+            if( Dimension( detail::loadLE<std::uint64_t>( in + 8 ) ) != dimensionOf<Q>() ) {
+                throw std::invalid_argument( "QuantileSketch: dimension does not match the requested quantity" );
+            }
+            const double compression = detail::loadLE<double>( in + 16 ) ;
+            if( !( compression >= 10.0 && compression <= 1e5 ) ) {
+                throw std::runtime_error( "QuantileSketch: invalid header" );
+            }
+            QuantileSketch sketch( compression ) ;
+            sketch.lowest = detail::loadLE<double>( in + 24 ) ;
+            sketch.highest = detail::loadLE<double>( in + 32 ) ;
+            sketch.sum = detail::loadLE<double>( in + 40 ) ;
+            sketch.nans = detail::loadLE<std::uint64_t>( in + 48 ) ;
+            const std::uint32_t n = detail::loadLE<std::uint32_t>( in + 56 ) ;
+            std::size_t at = SKETCH_HEADER_SIZE ;
+            for( std::uint32_t i = 0; i < n; ++i ) {
+                if( at + 8 >= size ) {
+                    throw std::runtime_error( "QuantileSketch: truncated centroids" );
+                }
+                Centroid c ;
+                c.mean = detail::loadLE<double>( in + at ) ;
+                at += 8 ;
+                std::uint64_t w = 0 ;
+                for( int shift = 0; ; shift += 7 ) {
+                    if( at >= size || shift > 63 ) {
+                        throw std::runtime_error( "QuantileSketch: truncated centroids" );
+                    }
+                    w |= std::uint64_t( in[at] & 0x7f ) << shift ;
+                    if( !( in[at++] & 0x80 ) ) {
+                        break ;
+                    }
+                }
+                c.weight = double( w ) ;
+                sketch.total += c.weight ;
+                sketch.centroids.push_back( c ) ;
+            }
+            return sketch;
+        }
+
+        static QuantileSketch deserialize( const std::vector<unsigned char>& in ) {
+            return deserialize( in.data(), in.size() );
+        }
+
+    private:
+        struct Centroid {
+            double mean ;
+            double weight ;
+        } ;
+
+        std::size_t capacity() const {
+            return std::size_t( 5.0 * delta );
+        }
+
+        void requireSamples() const {
+            if( count() == 0 ) {
+                throw std::domain_error( "QuantileSketch holds no samples" );
+            }
+        }
+
+        /**
+         * Sort the buffer and merge it into the centroids.
+         */
+        void compress() const {
+            if( buffer.empty() ) {
+                return;
+            }
+            std::vector<std::uint64_t> scratch( buffer.size() ) ;
+            const std::uint64_t * sorted = detail::radixSort( buffer.data(), scratch.data(), buffer.size() ) ;
+            std::vector<Centroid> all ;
+            all.reserve( centroids.size() + buffer.size() ) ;
+            std::size_t c = 0 ;
+            for( std::size_t i = 0; i < buffer.size(); ++i ) {
+                const double x = detail::fromSortKey( sorted[i] ) ;
+                for( ; c < centroids.size() && centroids[c].mean <= x; ++c ) {
+                    all.push_back( centroids[c] ) ;
+                }
+                all.push_back( Centroid{ x, 1.0 } ) ;
+            }
+            all.insert( all.end(), centroids.begin() + std::ptrdiff_t( c ), centroids.end() ) ;
+            total += double( buffer.size() ) ;
+            buffer.clear() ;
+            cluster( all ) ;
+        }
+
+        /**
+         * Merge neighbours of the sorted centroids \c all of total weight
+         * total while the merged centroid spans at most one unit of
+         * k( q ) = delta / ( 2 pi ) * asin( 2 q - 1 ), which keeps the
+         * centroids near q = 0 and q = 1 small.
+         */
+        void cluster( const std::vector<Centroid>& all ) const {
+            const double pi = 3.14159265358979323846 ;
+            const double normalizer = delta / ( 2.0 * pi ) ;
+            auto limit = [&]( double before ) {
+                const double k = normalizer * std::asin( 2.0 * before / total - 1.0 ) + 1.0 ;
+                return k >= delta / 4.0 ? total : total * ( std::sin( k / normalizer ) + 1.0 ) / 2.0 ;
+            } ;
+            centroids.clear() ;
+            if( all.empty() ) {
+                return;
+            }
+            Centroid current = all.front() ;
+            double before = 0.0 ;
+            double end = limit( before ) ;
+            for( std::size_t i = 1; i < all.size(); ++i ) {
+                if( before + current.weight + all[i].weight <= end ) {
+                    current.weight += all[i].weight ;
+                    current.mean += ( all[i].mean - current.mean ) * all[i].weight / current.weight ;
+                } else {
+                    before += current.weight ;
+                    centroids.push_back( current ) ;
+                    end = limit( before ) ;
+                    current = all[i] ;
+                }
+            }
+            centroids.push_back( current ) ;
+        }
+
+        double delta ;
+        mutable double total ;      // Weight of the centroids
+        double sum ;
+        double lowest ;
+        double highest ;
+        std::uint64_t nans ;
+        mutable std::vector<std::uint64_t> buffer ;     // Sort keys of the new samples
+        mutable std::vector<Centroid> centroids ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* QUANTILESKETCH_HPP_ */
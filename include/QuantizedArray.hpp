@@ -0,0 +1,428 @@
+/*
+ * QuantizedArray.hpp
+ *
+ *      Arrays of quantities stored as 8, 16 or 32-bit integer codes with a
+ *      typed scale and offset, value = offset + scale * code, for sensor
+ *      archives that do not need a double per sample. Quantizing rounds
+ *      to the nearest code and saturates at the ends of the integer range;
+ *      both directions are converted eight samples at a time with SSE2 or
+ *      AVX. Sums, means, variances and extremes are computed on the codes.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef QUANTIZEDARRAY_HPP_
+#define QUANTIZEDARRAY_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    namespace detail {
+        /**
+         * Moves eight codes between memory and two vectors of four 32-bit
+         * integers, lanes 0-3 and 4-7. Narrowing saturates.
+         */
+        template<typename IntT>
+        struct CodeLanes ;
+
+#if defined(__SSE2__)
+        template<>
+        struct CodeLanes<std::int8_t> {
+            static void load( const std::int8_t * p, __m128i& lo, __m128i& hi ) {
+                const __m128i v = _mm_loadl_epi64( reinterpret_cast<const __m128i *>( p ) ) ;
+                // Sign extend to 16 bits, then to 32 bits
+                const __m128i w = _mm_srai_epi16( _mm_unpacklo_epi8( v, v ), 8 ) ;
+                lo = _mm_srai_epi32( _mm_unpacklo_epi16( w, w ), 16 ) ;
+                hi = _mm_srai_epi32( _mm_unpackhi_epi16( w, w ), 16 ) ;
+            }
+
+            static void store( std::int8_t * p, __m128i lo, __m128i hi ) {
+                const __m128i w = _mm_packs_epi32( lo, hi ) ;
+                _mm_storel_epi64( reinterpret_cast<__m128i *>( p ), _mm_packs_epi16( w, w ) ) ;
+            }
+        } ;
+
+        template<>
+        struct CodeLanes<std::int16_t> {
+            static void load( const std::int16_t * p, __m128i& lo, __m128i& hi ) {
+                const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i *>( p ) ) ;
+                lo = _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ) ;
+                hi = _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ) ;
+            }
+
+            static void store( std::int16_t * p, __m128i lo, __m128i hi ) {
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( p ), _mm_packs_epi32( lo, hi ) ) ;
+            }
+        } ;
+
+        template<>
+        struct CodeLanes<std::int32_t> {
+            static void load( const std::int32_t * p, __m128i& lo, __m128i& hi ) {
+                lo = _mm_loadu_si128( reinterpret_cast<const __m128i *>( p ) ) ;
+                hi = _mm_loadu_si128( reinterpret_cast<const __m128i *>( p + 4 ) ) ;
+            }
+
+            static void store( std::int32_t * p, __m128i lo, __m128i hi ) {
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( p ), lo ) ;
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( p + 4 ), hi ) ;
+            }
+        } ;
+#endif
+
+        /**
+         * Code of \c x: ( x - offset ) * inverse rounded to nearest (even on
+         * ties) and clamped to the range of IntT. NaN gives the lowest code.
+         */
+        template<typename IntT>
+        inline IntT quantizeOne( double x, double offset, double inverse ) {
+            const double lowest = double( std::numeric_limits<IntT>::min() ) ;
+            const double highest = double( std::numeric_limits<IntT>::max() ) ;
+            const double t = ( x - offset ) * inverse ;
+            return t != t ? std::numeric_limits<IntT>::min() : IntT( std::nearbyint( std::min( std::max( t, lowest ), highest ) ) );
+        }
+
+        template<typename IntT>
+        void quantize( const double * x, std::size_t n, double offset, double inverse, IntT * codes ) {
+            std::size_t i = 0 ;
+#if defined(__AVX__)
+            const __m256d voffset = _mm256_set1_pd( offset ) ;
+            const __m256d vinverse = _mm256_set1_pd( inverse ) ;
+            const __m256d lowest = _mm256_set1_pd( double( std::numeric_limits<IntT>::min() ) ) ;
+            const __m256d highest = _mm256_set1_pd( double( std::numeric_limits<IntT>::max() ) ) ;
+            for( ; i + 8 <= n; i += 8 ) {
+                __m256d a = _mm256_mul_pd( _mm256_sub_pd( _mm256_loadu_pd( x + i ), voffset ), vinverse ) ;
+                __m256d b = _mm256_mul_pd( _mm256_sub_pd( _mm256_loadu_pd( x + i + 4 ), voffset ), vinverse ) ;
+                // max returns its second operand if one is NaN, which
+                // therefore ends up at the lowest code
+                a = _mm256_min_pd( _mm256_max_pd( a, lowest ), highest ) ;
+                b = _mm256_min_pd( _mm256_max_pd( b, lowest ), highest ) ;
+                CodeLanes<IntT>::store( codes + i, _mm256_cvtpd_epi32( a ), _mm256_cvtpd_epi32( b ) ) ;
+            }
+#elif defined(__SSE2__)
+            const __m128d voffset = _mm_set1_pd( offset ) ;
+            const __m128d vinverse = _mm_set1_pd( inverse ) ;
+            const __m128d lowest = _mm_set1_pd( double( std::numeric_limits<IntT>::min() ) ) ;
+            const __m128d highest = _mm_set1_pd( double( std::numeric_limits<IntT>::max() ) ) ;
+            __m128i q[4] ;
+            for( ; i + 8 <= n; i += 8 ) {
+                for( int k = 0; k < 4; ++k ) {
+                    __m128d t = _mm_mul_pd( _mm_sub_pd( _mm_loadu_pd( x + i + 2 * k ), voffset ), vinverse ) ;
+                    // max returns its second operand if one is NaN, which
+                    // therefore ends up at the lowest code
+                    t = _mm_min_pd( _mm_max_pd( t, lowest ), highest ) ;
+                    q[k] = _mm_cvtpd_epi32( t ) ;
+                }
+                CodeLanes<IntT>::store( codes + i, _mm_unpacklo_epi64( q[0], q[1] ), _mm_unpacklo_epi64( q[2], q[3] ) ) ;
+            }
+#endif
+            for( ; i < n; ++i ) {
+                codes[i] = quantizeOne<IntT>( x[i], offset, inverse ) ;
+            }
+        }
+
+        template<typename IntT>
+        void dequantize( const IntT * codes, std::size_t n, double offset, double scale, double * x ) {
+            std::size_t i = 0 ;
+#if defined(__AVX__)
+            const __m256d voffset = _mm256_set1_pd( offset ) ;
+            const __m256d vscale = _mm256_set1_pd( scale ) ;
+            for( ; i + 8 <= n; i += 8 ) {
+                __m128i lo, hi ;
+                CodeLanes<IntT>::load( codes + i, lo, hi ) ;
+                _mm256_storeu_pd( x + i, _mm256_add_pd( voffset, _mm256_mul_pd( vscale, _mm256_cvtepi32_pd( lo ) ) ) ) ;
+                _mm256_storeu_pd( x + i + 4, _mm256_add_pd( voffset, _mm256_mul_pd( vscale, _mm256_cvtepi32_pd( hi ) ) ) ) ;
+            }
+#elif defined(__SSE2__)
+            const __m128d voffset = _mm_set1_pd( offset ) ;
+            const __m128d vscale = _mm_set1_pd( scale ) ;
+            for( ; i + 8 <= n; i += 8 ) {
+                __m128i lanes[2] ;
+                CodeLanes<IntT>::load( codes + i, lanes[0], lanes[1] ) ;
+                for( int k = 0; k < 2; ++k ) {
+                    const __m128d a = _mm_cvtepi32_pd( lanes[k] ) ;
+                    const __m128d b = _mm_cvtepi32_pd( _mm_shuffle_epi32( lanes[k], 0xEE ) ) ;
+                    _mm_storeu_pd( x + i + 4 * k, _mm_add_pd( voffset, _mm_mul_pd( vscale, a ) ) ) ;
+                    _mm_storeu_pd( x + i + 4 * k + 2, _mm_add_pd( voffset, _mm_mul_pd( vscale, b ) ) ) ;
+                }
+            }
+#endif
+            for( ; i < n; ++i ) {
+                x[i] = offset + scale * double( codes[i] ) ;
+            }
+        }
+
+        /**
+         * Exact sum of the codes. Narrow codes are summed in 32-bit blocks
+         * that cannot overflow, which vectorize better than 64-bit sums.
+         */
+        template<typename IntT>
+        std::int64_t sumCodes( const IntT * codes, std::size_t n ) {
+            std::int64_t total = 0 ;
+            if( sizeof(IntT) < 4 ) {
+                const std::size_t block = std::size_t( 1 ) << ( 32 - 8 * sizeof(IntT) ) ;
+                for( std::size_t begin = 0; begin < n; begin += block ) {
+                    const std::size_t end = std::min( n, begin + block ) ;
+                    std::int32_t partial = 0 ;
+                    for( std::size_t i = begin; i < end; ++i ) {
+                        partial += codes[i] ;
+                    }
+                    total += partial ;
+                }
+            } else {
+                for( std::size_t i = 0; i < n; ++i ) {
+                    total += codes[i] ;
+                }
+            }
+            return total;
+        }
+
+        /**
+         * Smallest and largest of \c n > 0 codes, in one pass the compiler
+         * can vectorize.
+         */
+        template<typename IntT>
+        std::pair<IntT, IntT> codeRange( const IntT * codes, std::size_t n ) {
+            IntT lo = codes[0], hi = codes[0] ;
+            for( std::size_t i = 1; i < n; ++i ) {
+                lo = codes[i] < lo ? codes[i] : lo ;
+                hi = codes[i] > hi ? codes[i] : hi ;
+            }
+            return std::make_pair( lo, hi );
+        }
+    }
+    // namespace detail;
+
+    /**
+     * Array of Q values stored as IntT codes (std::int8_t, std::int16_t or
+     * std::int32_t), value = offset + scale * code. The scale is the
+     * resolution, so a Voltage array with a scale of 1 mV and int16_t codes
+     * holds -32.768 V to 32.767 V around its offset in a quarter of the
+     * memory of a std::vector<Voltage>. Values outside the range saturate
+     * and NaN is stored as the lowest code.
+     *
+     * \code
+     * QuantizedArray<Voltage, std::int16_t> trace( 0.001_V, 0_V ) ;
+     * trace.assign( samples ) ;
+     * Voltage average = trace.mean() ;
+     * \endcode
+     */
+    template<typename Q, typename IntT = std::int16_t>
+    class QuantizedArray {
+    public:
+        static_assert( std::is_same<IntT, std::int8_t>::value || std::is_same<IntT, std::int16_t>::value ||
+                       std::is_same<IntT, std::int32_t>::value,
+                       "QuantizedArray codes must be std::int8_t, std::int16_t or std::int32_t" );
+        static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+
+        /**
+         * Type of the variance of the values.
+         */
+        using SquareType = decltype( Q() * Q() ) ;
+
+        /**
+         * An array of \c n values equal to the offset. Throws
+         * std::invalid_argument unless the scale is finite and non-zero.
+         */
+        explicit QuantizedArray( const Q& scale, const Q& offset = Q( 0 ), std::size_t n = 0 )
+        : step( scale.getValue() ), origin( offset.getValue() ), inverse( 1.0 / step ), codes( n, IntT( 0 ) ) {
+            if( step == 0 || !std::isfinite( step ) || !std::isfinite( inverse ) || !std::isfinite( origin ) ) {
+                throw std::invalid_argument( "QuantizedArray: the scale must be finite and non-zero and the offset finite" );
+            }
+        }
+
+        QuantizedArray( const Q& scale, const Q& offset, const std::vector<Q>& values )
+        : QuantizedArray( scale, offset ) {
+            assign( values ) ;
+        }
+
+        /**
+         * Quantize \c n values with the scale and offset that map their
+         * smallest and largest value to the lowest and highest code.
+         * Throws std::invalid_argument if a value is not finite.
+         */
+        static QuantizedArray fit( const Q * x, std::size_t n ) {
+            double lo = 0, hi = 0 ;
+            if( n > 0 ) {
+                const double * v = reinterpret_cast<const double *>( x ) ;
+                lo = hi = v[0] ;
+                for( std::size_t i = 1; i < n; ++i ) {
+                    lo = std::min( lo, v[i] ) ;
+                    hi = std::max( hi, v[i] ) ;
+                }
+                if( !std::isfinite( lo ) || !std::isfinite( hi ) ) {
+                    throw std::invalid_argument( "QuantizedArray::fit: the values must be finite" );
+                }
+            }
+            const double lowest = double( std::numeric_limits<IntT>::min() ) ;
+            const double highest = double( std::numeric_limits<IntT>::max() ) ;
+            const double scale = hi > lo ? ( hi - lo ) / ( highest - lowest ) : 1.0 ;
+            QuantizedArray array( Q( scale ), Q( lo - scale * lowest ) ) ;
+            array.assign( x, n ) ;
+            return array;
+        }
+
+        static QuantizedArray fit( const std::vector<Q>& values ) {
+            return fit( values.data(), values.size() );
+        }
+
+        std::size_t size() const {
+            return codes.size();
+        }
+
+        bool empty() const {
+            return codes.empty();
+        }
+
+        void resize( std::size_t n ) {
+            codes.resize( n, IntT( 0 ) ) ;
+        }
+
+        Q scale() const {
+            return Q( step );
+        }
+
+        Q offset() const {
+            return Q( origin );
+        }
+
+        /**
+         * Smallest value that can be stored.
+         */
+        Q lowest() const {
+            return Q( std::min( decode( std::numeric_limits<IntT>::min() ), decode( std::numeric_limits<IntT>::max() ) ) );
+        }
+
+        /**
+         * Largest value that can be stored.
+         */
+        Q highest() const {
+            return Q( std::max( decode( std::numeric_limits<IntT>::min() ), decode( std::numeric_limits<IntT>::max() ) ) );
+        }
+
+        /**
+         * Bytes of storage of the codes.
+         */
+        std::size_t bytes() const {
+            return codes.size() * sizeof(IntT);
+        }
+
+        IntT * data() {
+            return codes.data();
+        }
+
+        const IntT * data() const {
+            return codes.data();
+        }
+
+        Q operator[]( std::size_t i ) const {
+            return Q( decode( codes[i] ) );
+        }
+
+        void set( std::size_t i, const Q& x ) {
+            codes[i] = detail::quantizeOne<IntT>( x.getValue(), origin, inverse ) ;
+        }
+
+        /**
+         * Replace the contents with the codes of \c n values.
+         */
+        void assign( const Q * x, std::size_t n ) {
+            codes.resize( n ) ;
+            detail::quantize( reinterpret_cast<const double *>( x ), n, origin, inverse, codes.data() ) ;
+        }
+
+        void assign( const std::vector<Q>& values ) {
+            assign( values.data(), values.size() ) ;
+        }
+
+        /**
+         * Write all size() values to \c out.
+         */
+        void dequantize( Q * out ) const {
+            detail::dequantize( codes.data(), codes.size(), origin, step, reinterpret_cast<double *>( out ) ) ;
+        }
+
+        std::vector<Q> values() const {
+            std::vector<Q> out( codes.size() ) ;
+            dequantize( out.data() ) ;
+            return out;
+        }
+
+        /**
+         * Sum of the values, from the exact sum of the codes.
+         */
+        Q sum() const {
+            return Q( origin * double( codes.size() ) + step * double( detail::sumCodes( codes.data(), codes.size() ) ) );
+        }
+
+        Q mean() const {
+            requireValues() ;
+            return Q( origin + step * double( detail::sumCodes( codes.data(), codes.size() ) ) / double( codes.size() ) );
+        }
+
+        /**
+         * Population variance of the values: scale^2 times the variance of
+         * the codes, with the mean of the codes subtracted first.
+         */
+        SquareType variance() const {
+            requireValues() ;
+            const double n = double( codes.size() ) ;
+            const double m = double( detail::sumCodes( codes.data(), codes.size() ) ) / n ;
+            double squares = 0 ;
+            for( IntT c : codes ) {
+                const double d = double( c ) - m ;
+                squares += d * d ;
+            }
+            return SquareType( step * step * squares / n );
+        }
+
+        Q stddev() const {
+            return Q( std::sqrt( variance().getValue() ) );
+        }
+
+        Q min() const {
+            requireValues() ;
+            const std::pair<IntT, IntT> range = detail::codeRange( codes.data(), codes.size() ) ;
+            return Q( decode( step > 0 ? range.first : range.second ) );
+        }
+
+        Q max() const {
+            requireValues() ;
+            const std::pair<IntT, IntT> range = detail::codeRange( codes.data(), codes.size() ) ;
+            return Q( decode( step > 0 ? range.second : range.first ) );
+        }
+
+    private:
+        double decode( IntT c ) const {
+            return origin + step * double( c );
+        }
+
+        void requireValues() const {
+            if( codes.empty() ) {
+                throw std::domain_error( "QuantizedArray holds no values" );
+            }
+        }
+
+        double step ;
+        double origin ;
+        double inverse ;
+        std::vector<IntT> codes ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* QUANTIZEDARRAY_HPP_ */
@@ -0,0 +1,247 @@
+/*
+ * RollingWindow.hpp
+ *
+ *      Fixed-capacity sliding window of Quantity<> samples with rolling
+ *      statistics. Every statistic is updated incrementally, so push() is
+ *      amortized O(1), all queries are O(1) and no memory is allocated.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef ROLLINGWINDOW_HPP_
+#define ROLLINGWINDOW_HPP_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * Sliding window over the last N samples of the quantity Q. The window
+     * keeps the mean and the sum of squared deviations up to date with a
+     * sliding version of Welford's algorithm, and the minimum and maximum
+     * with monotonic queues. All storage is part of the object.
+     *
+     * The statistics have the dimension implied by Quantity<> arithmetic:
+     * the variance of a window of Pressure samples is a Pressure^2.
+     *
+     * While a NaN sample is in the window the sum, mean and variance are
+     * NaN; they are recomputed from the window once it leaves. min() and
+     * max() skip NaN samples and are NaN only if every sample is. The
+     * running sums are also recomputed every N samples so that rounding
+     * errors of the sliding update do not accumulate.
+     *
+     * \code
+     * RollingWindow<Pressure, 64> window ;
+     * window.push( 1_bar ) ;
+     * Pressure spread = window.max() - window.min() ;
+     * \endcode
+     */
+    template<typename Q, std::size_t N>
+    class RollingWindow {
+    public:
+        static_assert( N > 0, "A rolling window needs at least one sample" );
+
+        /**
+         * Type of the variance of the samples.
+         */
+        using SquareType = decltype( Q() * Q() ) ;
+
+        /**
+         * Add a sample to the window, evicting the oldest sample if the window
+         * is full.
+         */
+        void push( const Q& x ) {
+            const double v = x.getValue() ;
+            const bool full = count == N ;
+            const double old = full ? samples[next % N].getValue() : 0.0 ;
+            const bool nanLeaves = full && std::isnan( old ) ;
+            nans += std::isnan( v ) ? 1 : 0 ;
+            nans -= nanLeaves ? 1 : 0 ;
+            if( !full ) {
+                ++count ;
+            }
+            if( nans > 0 ) {
+                runningMean = std::numeric_limits<double>::quiet_NaN() ;
+                m2 = std::numeric_limits<double>::quiet_NaN() ;
+            } else if( !full ) {
+                const double delta = v - runningMean ;
+                runningMean += delta / count ;
+                m2 += delta * ( v - runningMean ) ;
+            } else if( !nanLeaves ) {
+                const double mean = runningMean + ( v - old ) / N ;
+                m2 += ( v - old ) * ( v - mean + old - runningMean ) ;
+                runningMean = mean ;
+            }
+
+            // Drop the indices that leave the window
+            const std::uint64_t oldest = next + 1 >= N ? next + 1 - N : 0 ;
+            minQueue.evict( oldest ) ;
+            maxQueue.evict( oldest ) ;
+
+            samples[next % N] = x ;
+            if( !std::isnan( v ) ) {
+                minQueue.push( next, samples, []( double a, double b ) { return a >= b; } ) ;
+                maxQueue.push( next, samples, []( double a, double b ) { return a <= b; } ) ;
+            }
+            ++next ;
+
+            if( nans == 0 && full && ( nanLeaves || next % N == 0 ) ) {
+                recompute() ;
+            }
+        }
+
+        /**
+         * Remove all samples.
+         */
+        void clear() {
+            *this = RollingWindow() ;
+        }
+
+        std::size_t size() const {
+            return count;
+        }
+
+        static constexpr std::size_t capacity() {
+            return N;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        bool full() const {
+            return count == N;
+        }
+
+        /**
+         * Get the i-th sample of the window, where 0 is the oldest sample.
+         */
+        const Q& operator[]( std::size_t i ) const {
+            return samples[( next - count + i ) % N];
+        }
+
+        /**
+         * Get the most recent sample.
+         */
+        const Q& back() const {
+            return samples[( next - 1 ) % N];
+        }
+
+        Q sum() const {
+            return Q( runningMean * count );
+        }
+
+        Q mean() const {
+            return Q( runningMean );
+        }
+
+        /**
+         * Population variance of the samples in the window.
+         */
+        SquareType variance() const {
+            return SquareType( count == 0 || m2 < 0 ? 0.0 : m2 / count );
+        }
+
+        /**
+         * Sample (Bessel corrected) variance of the samples in the window.
+         */
+        SquareType sampleVariance() const {
+            return SquareType( count < 2 || m2 < 0 ? 0.0 : m2 / ( count - 1 ) );
+        }
+
+        /**
+         * Population standard deviation of the samples in the window.
+         */
+        Q stddev() const {
+            return Q( std::sqrt( variance().getValue() ) );
+        }
+
+        /**
+         * Smallest sample in the window. The window must not be empty.
+         */
+        Q min() const {
+            assert( count > 0 );
+            return minQueue.empty() ? Q( std::numeric_limits<double>::quiet_NaN() ) : samples[minQueue.front() % N];
+        }
+
+        /**
+         * Largest sample in the window. The window must not be empty.
+         */
+        Q max() const {
+            assert( count > 0 );
+            return maxQueue.empty() ? Q( std::numeric_limits<double>::quiet_NaN() ) : samples[maxQueue.front() % N];
+        }
+
+    private:
+        /**
+         * Mean and sum of squared deviations of the window, in two passes.
+         */
+        void recompute() {
+            double total = 0 ;
+            for( std::size_t i = 0; i < count; ++i ) {
+                total += ( *this )[i].getValue() ;
+            }
+            runningMean = total / count ;
+            m2 = 0 ;
+            for( std::size_t i = 0; i < count; ++i ) {
+                const double delta = ( *this )[i].getValue() - runningMean ;
+                m2 += delta * delta ;
+            }
+        }
+
+        /**
+         * Queue of sample indices whose values are monotonic. The front is the
+         * index of the extreme value of the window. At most N indices are
+         * stored at any time, so a ring buffer of N entries suffices.
+         */
+        class MonotonicQueue {
+        public:
+            void evict( std::uint64_t oldest ) {
+                while( head != tail && indices[head % N] < oldest ) {
+                    ++head ;
+                }
+            }
+
+            template<typename Dominates>
+            void push( std::uint64_t index, const std::array<Q, N>& values, Dominates dominates ) {
+                const double v = values[index % N].getValue() ;
+                while( head != tail && dominates( values[indices[( tail - 1 ) % N] % N].getValue(), v ) ) {
+                    --tail ;
+                }
+                indices[tail % N] = index ;
+                ++tail ;
+            }
+
+            bool empty() const {
+                return head == tail;
+            }
+
+            std::uint64_t front() const {
+                return indices[head % N];
+            }
+
+        private:
+            std::array<std::uint64_t, N> indices {} ;
+            std::uint64_t head = 0 ;
+            std::uint64_t tail = 0 ;
+        } ;
+
+        std::array<Q, N> samples ;
+        std::uint64_t next = 0 ;
+        std::size_t count = 0 ;
+        std::size_t nans = 0 ;
+        double runningMean = 0 ;
+        double m2 = 0 ;
+        MonotonicQueue minQueue ;
+        MonotonicQueue maxQueue ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* ROLLINGWINDOW_HPP_ */
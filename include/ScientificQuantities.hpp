@@ -19,12 +19,426 @@
 #include <assert.h>
 #include <stdexcept>
 #include <array>
+#include <chrono>
 #include <ratio>
 #include <vector>
 #include <memory>
 #include <cstring>
+#include <limits>
+
+#if defined(SCIQ_CHECKED)
+#include <cstdlib>
+#endif
+#if defined(SCIQ_COUNT_OPS)
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <utility>
+#endif
 
 namespace SciQ {
+    /**
+     * Instrumentation of the arithmetic of Quantity<>. Every operator,
+     * sqrt(), pow<>() and in() passes its result through SCIQ_OBSERVE. Without
+     * any instrumentation enabled the macro is its result argument, so the
+     * operators compile to exactly the same code as without the hook. The
+     * instrumentations, SCIQ_CHECKED and SCIQ_COUNT_OPS, may be combined.
+     */
+    namespace instrument {
+        enum class Operation {
+            Add,
+            Subtract,
+            Multiply,
+            Divide,
+            Sqrt,
+            Pow,
+            In
+        } ;
+
+        constexpr const char * symbol( Operation op ) {
+            return op == Operation::Add ? "+"
+                 : op == Operation::Subtract ? "-"
+                 : op == Operation::Multiply ? "*"
+                 : op == Operation::Divide ? "/"
+                 : op == Operation::Sqrt ? "sqrt"
+                 : op == Operation::Pow ? "pow" : "in";
+        }
+    }
+    // namespace instrument;
+
+// Pastes after expanding, e.g. __LINE__ into the names of scope guards
+#define SCIQ_CONCAT_IMPL( a, b ) a##b
+#define SCIQ_CONCAT( a, b ) SCIQ_CONCAT_IMPL( a, b )
+
+#if defined(SCIQ_CHECKED)
+    /**
+     * Checked arithmetic, enabled by defining SCIQ_CHECKED. Every result
+     * of the Quantity<> operators is tested for being finite; the first
+     * NaN or infinity is reported with the operation, its operands, the
+     * dimension of the result and the enclosing SCIQ_CHECK_SCOPE()s, and
+     * the handler is called. The default handler prints the report to
+     * std::cerr and aborts. The test, r - r == 0, is false only for NaN and
+     * infinity and is a constant expression, so constexpr evaluation still
+     * works and fails to compile on a non-finite result. Do not combine
+     * with -ffinite-math-only (-ffast-math), which removes the test.
+     */
+    namespace checked {
+        /**
+         * A scope named with SCIQ_CHECK_SCOPE(). The scopes of a thread
+         * form a stack through their outer pointers.
+         */
+        struct Site {
+            const char * label ;
+            const char * file ;
+            int line ;
+            const Site * outer ;
+        } ;
+
+        inline const Site *& innermost() {
+            static thread_local const Site * site = nullptr ;
+            return site;
+        }
+
+        class Scope {
+        public:
+            Scope( const char * label, const char * file, int line )
+            : site{ label, file, line, innermost() } {
+                innermost() = &site ;
+            }
+
+            Scope( const Scope& ) = delete ;
+            Scope& operator=( const Scope& ) = delete ;
+
+            ~Scope() {
+                innermost() = site.outer ;
+            }
+
+        private:
+            Site site ;
+        } ;
+
+        struct Violation {
+            instrument::Operation operation ;
+            const char * reason ;
+            double lhs ;            ///< Operand, in its fundamental SI unit
+            double rhs ;            ///< Second operand, the unit of in() or the exponent of pow<>()
+            std::string result ;    ///< The result with its unit
+            const Site * site ;     ///< Innermost scope, or nullptr
+        } ;
+
+        using Handler = void (*)( const Violation& ) ;
+
+        inline std::string describe( const Violation& v ) {
+            std::ostringstream os ;
+            os << "SciQ: " << v.reason << ": " ;
+            switch( v.operation ) {
+            case instrument::Operation::Sqrt:
+                os << "sqrt(" << v.lhs << ")" ;
+                break;
+            case instrument::Operation::Pow:
+                os << "pow<" << v.rhs << ">(" << v.lhs << ")" ;
+                break;
+            default:
+                os << v.lhs << " " << instrument::symbol( v.operation ) << " " << v.rhs ;
+            }
+            os << " = " << v.result ;
+            for( const Site * s = v.site; s; s = s->outer ) {
+                os << "\n    in " << s->label << " at " << s->file << ":" << s->line ;
+            }
+            return os.str();
+        }
+
+        inline void abortHandler( const Violation& v ) {
+            std::cerr << describe( v ) << std::endl ;
+            std::abort() ;
+        }
+
+        inline Handler& handler() {
+            static Handler h = abortHandler ;
+            return h;
+        }
+
+        /**
+         * Install a handler for violations, e.g. one that throws, and
+         * return the previous one. The handler applies to all threads.
+         */
+        inline Handler setHandler( Handler h ) {
+            const Handler previous = handler() ;
+            handler() = h ;
+            return previous;
+        }
+
+        /**
+         * Find the reason for the non-finite result of \c op and call the
+         * handler. Kept out of line so the checks stay small.
+         */
+        template<typename Q>
+        void fail( instrument::Operation op, double result, double lhs, double rhs ) {
+            using instrument::Operation ;
+            const bool unary = op == Operation::Sqrt || op == Operation::Pow ;
+            const char * reason =
+                !( lhs - lhs == 0 ) || ( !unary && !( rhs - rhs == 0 ) ) ? "non-finite operand"
+                : ( op == Operation::Divide || op == Operation::In ) && rhs == 0 ? "division by zero"
+                : op == Operation::Sqrt && lhs < 0 ? "square root of a negative value"
+                : op == Operation::Pow && lhs == 0 ? "zero to a negative power"
+                : result == result ? "overflow" : "invalid operation" ;
+            std::ostringstream os ;
+            os << Q( result ) ;
+            handler()( Violation{ op, reason, lhs, rhs, os.str(), innermost() } ) ;
+        }
+
+    }
+    // namespace checked;
+
+/**
+ * Name the enclosing block in the reports of checked arithmetic. Expands to
+ * nothing unless SCIQ_CHECKED is defined.
+ */
+#define SCIQ_CHECK_SCOPE( label ) \
+    ::SciQ::checked::Scope SCIQ_CONCAT( sciqCheckScope, __LINE__ )( label, __FILE__, __LINE__ )
+#else
+#define SCIQ_CHECK_SCOPE( label )
+#endif
+
+#if defined(SCIQ_COUNT_OPS)
+    /**
+     * Operation counting, enabled by defining SCIQ_COUNT_OPS. Every
+     * Quantity<> operation increments a counter of its thread, one per
+     * operation and result dimension. summary() adds up the counters of
+     * all threads, including those that have finished, and print() shows
+     * them with the totals for a roofline model: one flop per operation
+     * and 8 bytes per operand and result. The byte count is the traffic of
+     * the values themselves, an upper bound that ignores registers and
+     * caches. The summary is printed to std::cerr at exit unless
+     * setReportAtExit( false ) is called.
+     */
+    namespace counters {
+        struct Count {
+            instrument::Operation operation ;
+            std::string dimension ;     ///< Unit of the result, "1" for in()
+            std::uint64_t operations ;
+        } ;
+
+        /**
+         * Unit of Q as printed by operator<<().
+         */
+        template<typename Q>
+        std::string dimensionName() {
+            std::ostringstream os ;
+            os << Q( 1.0 ) ;
+            const std::string s = os.str() ;
+            const std::size_t space = s.find( ' ' ) ;
+            return space == std::string::npos ? "1" : s.substr( space + 1 );
+        }
+
+        constexpr std::uint64_t bytesPerOperation( instrument::Operation op ) {
+            return op == instrument::Operation::Sqrt || op == instrument::Operation::Pow ? 16 : 24;
+        }
+
+        /**
+         * A counter owned by one thread. Only the owner writes it, with a
+         * plain load and store, so the increment needs no locked
+         * instruction; other threads may read it at any time.
+         */
+        struct Slot {
+            instrument::Operation operation ;
+            std::string (*dimension)() ;
+            std::atomic<std::uint64_t> count ;
+        } ;
+
+        class ThreadCounters ;
+
+        /**
+         * The counters of all threads and the totals of finished threads.
+         */
+        class Registry {
+        public:
+            static Registry& global() {
+                static Registry registry ;
+                return registry;
+            }
+
+            ~Registry() {
+                if( reportAtExit ) {
+                    print( std::cerr, summary() ) ;
+                }
+            }
+
+            std::mutex mutex ;
+            std::vector<ThreadCounters *> threads ;
+            std::map<std::pair<int, std::string>, std::uint64_t> finished ;
+            bool reportAtExit = true ;
+
+            std::vector<Count> summary() ;
+            static void print( std::ostream& os, const std::vector<Count>& counts ) ;
+        } ;
+
+        class ThreadCounters {
+        public:
+            ThreadCounters()
+            : registry( Registry::global() ) {
+                std::lock_guard<std::mutex> lock( registry.mutex ) ;
+                registry.threads.push_back( this ) ;
+            }
+
+            ThreadCounters( const ThreadCounters& ) = delete ;
+            ThreadCounters& operator=( const ThreadCounters& ) = delete ;
+
+            ~ThreadCounters() {
+                std::lock_guard<std::mutex> lock( registry.mutex ) ;
+                for( const Slot& s : slots ) {
+                    registry.finished[{ int( s.operation ), s.dimension() }] += s.count.load( std::memory_order_relaxed ) ;
+                }
+                registry.threads.erase( std::find( registry.threads.begin(), registry.threads.end(), this ) ) ;
+            }
+
+            static ThreadCounters& current() {
+                static thread_local ThreadCounters counters ;
+                return counters;
+            }
+
+            Slot * add( instrument::Operation op, std::string (*dimension)() ) {
+                std::lock_guard<std::mutex> lock( registry.mutex ) ;
+                slots.emplace_back() ;
+                Slot * s = &slots.back() ;
+                s->operation = op ;
+                s->dimension = dimension ;
+                s->count.store( 0, std::memory_order_relaxed ) ;
+                return s;
+            }
+
+            /**
+             * Reset the counters of this thread; the caller holds the
+             * mutex of the registry.
+             */
+            void clear() {
+                for( Slot& s : slots ) {
+                    s.count.store( 0, std::memory_order_relaxed ) ;
+                }
+            }
+
+            const std::deque<Slot>& all() const {
+                return slots;
+            }
+
+        private:
+            Registry& registry ;
+            std::deque<Slot> slots ;    // A deque keeps the slots in place
+        } ;
+
+        inline std::vector<Count> Registry::summary() {
+            std::map<std::pair<int, std::string>, std::uint64_t> totals ;
+            {
+                std::lock_guard<std::mutex> lock( mutex ) ;
+                totals = finished ;
+                for( const ThreadCounters * t : threads ) {
+                    for( const Slot& s : t->all() ) {
+                        totals[{ int( s.operation ), s.dimension() }] += s.count.load( std::memory_order_relaxed ) ;
+                    }
+                }
+            }
+            std::vector<Count> counts ;
+            for( const auto& t : totals ) {
+                if( t.second > 0 ) {
+                    counts.push_back( Count{ instrument::Operation( t.first.first ), t.first.second, t.second } ) ;
+                }
+            }
+            std::stable_sort( counts.begin(), counts.end(), []( const Count& a, const Count& b ) {
+                return a.operations > b.operations;
+            } ) ;
+            return counts;
+        }
+
+        inline void Registry::print( std::ostream& os, const std::vector<Count>& counts ) {
+            std::uint64_t flops = 0, bytes = 0 ;
+            os << "SciQ operation counts\n" ;
+            for( const Count& c : counts ) {
+                os << "  " << instrument::symbol( c.operation ) << "\t" << c.dimension << "\t" << c.operations << "\n" ;
+                flops += c.operations ;
+                bytes += c.operations * bytesPerOperation( c.operation ) ;
+            }
+            os << "  " << flops << " flops, " << bytes << " bytes, "
+               << ( bytes > 0 ? double( flops ) / double( bytes ) : 0.0 ) << " flops/byte" << std::endl ;
+        }
+
+        /**
+         * Counts of all threads, the most frequent first.
+         */
+        inline std::vector<Count> summary() {
+            return Registry::global().summary();
+        }
+
+        inline void print( std::ostream& os = std::cerr ) {
+            Registry::print( os, summary() ) ;
+        }
+
+        /**
+         * Zero the counters of all threads.
+         */
+        inline void reset() {
+            Registry& registry = Registry::global() ;
+            std::lock_guard<std::mutex> lock( registry.mutex ) ;
+            registry.finished.clear() ;
+            for( ThreadCounters * t : registry.threads ) {
+                t->clear() ;
+            }
+        }
+
+        inline void setReportAtExit( bool enabled ) {
+            Registry& registry = Registry::global() ;
+            std::lock_guard<std::mutex> lock( registry.mutex ) ;
+            registry.reportAtExit = enabled ;
+        }
+
+        template<typename Q, instrument::Operation op>
+        void increment() {
+            static thread_local Slot * slot = ThreadCounters::current().add( op, &dimensionName<Q> ) ;
+            slot->count.store( slot->count.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ) ;
+        }
+    }
+    // namespace counters;
+#endif
+
+#if defined(SCIQ_CHECKED) || defined(SCIQ_COUNT_OPS)
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define SCIQ_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+#if !defined(SCIQ_CONSTANT_EVALUATED)
+// Counting then makes the operators unusable in constant expressions
+#define SCIQ_CONSTANT_EVALUATED() false
+#endif
+
+    namespace instrument {
+        template<typename Q, Operation op>
+        constexpr double observe( double result, double lhs, double rhs ) {
+#if defined(SCIQ_COUNT_OPS)
+            if( !SCIQ_CONSTANT_EVALUATED() ) {
+                counters::increment<Q, op>() ;
+            }
+#endif
+#if defined(SCIQ_CHECKED)
+            if( !( result - result == 0 ) ) {
+                checked::fail<Q>( op, result, lhs, rhs ) ;
+            }
+#endif
+            ( void )lhs ;
+            ( void )rhs ;
+            return result;
+        }
+    }
+    // namespace instrument;
+
+#define SCIQ_OBSERVE( Q, op, result, lhs, rhs ) \
+    ::SciQ::instrument::observe<Q, ::SciQ::instrument::Operation::op>( result, lhs, rhs )
+#else
+#define SCIQ_OBSERVE( Q, op, result, lhs, rhs ) ( result )
+#endif
+
     /**
      * Number of base units. 
      *
@@ -53,6 +467,18 @@ namespace SciQ {
       // Interface class
     };
 
+    /**
+     * True for the dimension of Time, which alone converts to and from
+     * std::chrono durations.
+     */
+    template<class L, class M, class T, class EC, class TT, class AS, class LI>
+    struct IsTimeDimension : std::integral_constant<bool,
+        std::ratio_equal<L, std::ratio<0>>::value && std::ratio_equal<M, std::ratio<0>>::value &&
+        std::ratio_equal<T, std::ratio<1>>::value && std::ratio_equal<EC, std::ratio<0>>::value &&
+        std::ratio_equal<TT, std::ratio<0>>::value && std::ratio_equal<AS, std::ratio<0>>::value &&
+        std::ratio_equal<LI, std::ratio<0>>::value>
+    {} ;
+
     /**
      * Representation of a physical/scientific quantity using a combination of
      * seven base quantities: length (L), mass (M), time (T), electric
@@ -94,10 +520,40 @@ namespace SciQ {
         }
 
         /**
-         * Create a copy of the specified quantity. 
+         * Create a copy of the specified quantity. The copy constructor is
+         * trivial so that arrays of quantities can be copied with memcpy()
+         * and mapped directly from binary files.
+         */
+        constexpr Quantity( const Quantity& x ) = default;
+
+        /**
+         * Create a Time from a std::chrono duration, e.g.
+         * \code
+         * Time t = std::chrono::milliseconds( 5 ) ;
+         * \endcode
+         * The count is converted to double seconds, which is exact for
+         * counts up to 2^53 ticks. Only Time has this constructor.
+         */
+        template<class Rep, class Period,
+                 bool IsTime = IsTimeDimension<L, M, T, EC, TT, AS, LI>::value,
+                 typename std::enable_if<IsTime, int>::type = 0>
+        constexpr Quantity( const std::chrono::duration<Rep, Period>& d )
+        : value( std::chrono::duration<double>( d ).count() ) {
+        }
+
+        /**
+         * Convert a Time to a std::chrono duration with a floating point
+         * count, e.g. std::chrono::duration<double, std::milli>. Use copy
+         * initialization: direct initialization of a duration picks the
+         * duration constructor from a count and takes the value in seconds
+         * as the count via operator double(). For integer counts see
+         * toDuration().
          */
-        constexpr Quantity( const Quantity& x )
-        : value( x.value ) {
+        template<class Rep, class Period,
+                 bool IsTime = IsTimeDimension<L, M, T, EC, TT, AS, LI>::value,
+                 typename std::enable_if<IsTime && std::chrono::treat_as_floating_point<Rep>::value, int>::type = 0>
+        constexpr operator std::chrono::duration<Rep, Period>() const {
+            return std::chrono::duration_cast<std::chrono::duration<Rep, Period>>( std::chrono::duration<double>( value ) );
         }
 
         /**
@@ -113,7 +569,7 @@ namespace SciQ {
          * value equals 1 km. 
          */
         constexpr double in( const Quantity& rhs ) const {
-            return value / rhs.value;
+            return SCIQ_OBSERVE( double, In, value / rhs.value, value, rhs.value );
         }
 
         /**
@@ -149,7 +605,7 @@ namespace SciQ {
          * this quantity is updated.
          */
         Quantity& operator+=( const Quantity& rhs ) {
-            value += rhs.value;
+            value = SCIQ_OBSERVE( Type, Add, value + rhs.value, value, rhs.value );
             return *this;
         }
 
@@ -158,7 +614,7 @@ namespace SciQ {
          * value of this quantity is updated.
          */
         Quantity& operator-=( const Quantity& rhs ) {
-            value -= rhs.value;
+            value = SCIQ_OBSERVE( Type, Subtract, value - rhs.value, value, rhs.value );
             return *this;
         }
 
@@ -207,7 +663,7 @@ namespace SciQ {
     operator*( const Quantity<L1, M1, T1, EC1, TT1, AS1, LI1>& lhs,
                const Quantity<L2, M2, T2, EC2, TT2, AS2, LI2>& rhs ) {
         using ResultType = Quantity<std::ratio_add<L1,L2>, std::ratio_add<M1,M2>, std::ratio_add<T1,T2>, std::ratio_add<EC1,EC2>, std::ratio_add<TT1,TT2>, std::ratio_add<AS1,AS2>, std::ratio_add<LI1,LI2>> ;
-        return ResultType( lhs.getValue() * rhs.getValue() );
+        return ResultType( SCIQ_OBSERVE( ResultType, Multiply, lhs.getValue() * rhs.getValue(), lhs.getValue(), rhs.getValue() ) );
     }
 
     template<class L1, class M1, class T1, class EC1, class TT1, class AS1, class LI1, 
@@ -216,7 +672,7 @@ namespace SciQ {
     operator/( const Quantity<L1, M1, T1, EC1, TT1, AS1, LI1>& lhs,
                const Quantity<L2, M2, T2, EC2, TT2, AS2, LI2>& rhs ) {
         using ResultType = Quantity<std::ratio_subtract<L1,L2>, std::ratio_subtract<M1,M2>, std::ratio_subtract<T1,T2>, std::ratio_subtract<EC1,EC2>, std::ratio_subtract<TT1,TT2>, std::ratio_subtract<AS1,AS2>, std::ratio_subtract<LI1,LI2>> ;
-        return ResultType( lhs.getValue() / rhs.getValue() );
+        return ResultType( SCIQ_OBSERVE( ResultType, Divide, lhs.getValue() / rhs.getValue(), lhs.getValue(), rhs.getValue() ) );
     }
 
     template<class L1, class M1, class T1, class EC1, class TT1, class AS1, class LI1, 
@@ -320,28 +776,32 @@ namespace SciQ {
     constexpr Quantity<L, M, T, EC, TT, AS, LI> 
     operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs,
                const Type rhs ) {
-        return Quantity<L, M, T, EC, TT, AS, LI>( lhs.getValue() * rhs );
+        using ResultType = Quantity<L, M, T, EC, TT, AS, LI> ;
+        return ResultType( SCIQ_OBSERVE( ResultType, Multiply, lhs.getValue() * rhs, lhs.getValue(), rhs ) );
     }
 
     template<typename Type, class L, class M, class T, class EC, class TT, class AS, class LI>
     constexpr Quantity<L, M, T, EC, TT, AS, LI> 
     operator*( const Type lhs,
                const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
-        return Quantity<L, M, T, EC, TT, AS, LI>( lhs * rhs.getValue() );
+        using ResultType = Quantity<L, M, T, EC, TT, AS, LI> ;
+        return ResultType( SCIQ_OBSERVE( ResultType, Multiply, lhs * rhs.getValue(), lhs, rhs.getValue() ) );
     }
 
     template<typename Type, class L, class M, class T, class EC, class TT, class AS, class LI>
     constexpr Quantity<L, M, T, EC, TT, AS, LI> 
     operator/( const Quantity<L, M, T, EC, TT, AS, LI>& lhs,
                const Type rhs ) {
-        return Quantity<L, M, T, EC, TT, AS, LI>( lhs.getValue() / rhs );
+        using ResultType = Quantity<L, M, T, EC, TT, AS, LI> ;
+        return ResultType( SCIQ_OBSERVE( ResultType, Divide, lhs.getValue() / rhs, lhs.getValue(), rhs ) );
     }
 
     template<typename Type, class L, class M, class T, class EC, class TT, class AS, class LI>
     constexpr Quantity<std::ratio<-L::num>, std::ratio<-M::num>, std::ratio<-T::num>, std::ratio<-EC::num>, std::ratio<-TT::num>, std::ratio<-AS::num>, std::ratio<-LI::num> > 
     operator/( const Type lhs,
                const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
-        return Quantity<std::ratio<-L::num>, std::ratio<-M::num>, std::ratio<-T::num>, std::ratio<-EC::num>, std::ratio<-TT::num>, std::ratio<-AS::num>, std::ratio<-LI::num> >( lhs / rhs.getValue() );
+        using ResultType = Quantity<std::ratio<-L::num>, std::ratio<-M::num>, std::ratio<-T::num>, std::ratio<-EC::num>, std::ratio<-TT::num>, std::ratio<-AS::num>, std::ratio<-LI::num> > ;
+        return ResultType( SCIQ_OBSERVE( ResultType, Divide, lhs / rhs.getValue(), lhs, rhs.getValue() ) );
     }
 
 	// Mathematical operations
@@ -353,7 +813,7 @@ namespace SciQ {
 		
 		using ResultType = Quantity< std::ratio_divide<L,std::ratio<2> >, std::ratio_divide<M,std::ratio<2> >, std::ratio_divide<T,std::ratio<2> >, std::ratio_divide<EC,std::ratio<2> >, std::ratio_divide<TT,std::ratio<2> >, std::ratio_divide<AS,std::ratio<2> >, std::ratio_divide<LI,std::ratio<2> > >;
 
-    	return ResultType( std::sqrt(lhs.getValue()) );
+    	return ResultType( SCIQ_OBSERVE( ResultType, Sqrt, std::sqrt(lhs.getValue()), lhs.getValue(), lhs.getValue() ) );
     }
     // pow
     // TODO: is there away around than using template based power so we are consistent with the std::pow??
@@ -363,7 +823,7 @@ namespace SciQ {
 		
 		using ResultType = Quantity< std::ratio_multiply<L,std::ratio<power> >, std::ratio_multiply<M,std::ratio<power> >, std::ratio_multiply<T,std::ratio<power> >, std::ratio_multiply<EC,std::ratio<power> >, std::ratio_multiply<TT,std::ratio<power> >, std::ratio_multiply<AS,std::ratio<power> >, std::ratio_multiply<LI,std::ratio<power> > >;
 
-    	return ResultType( std::pow(lhs.getValue(), (double)power) );
+    	return ResultType( SCIQ_OBSERVE( ResultType, Pow, std::pow(lhs.getValue(), (double)power), lhs.getValue(), power ) );
     }
 
     // C++11 Physical quantity classes
@@ -376,6 +836,34 @@ namespace SciQ {
     using Substance         = Quantity<std::ratio<0>,std::ratio<0>,std::ratio<0>,std::ratio<0>,std::ratio<0>,std::ratio<1>,std::ratio<0> >;
     using Luminous          = Quantity<std::ratio<0>,std::ratio<0>,std::ratio<0>,std::ratio<0>,std::ratio<0>,std::ratio<0>,std::ratio<1> >;
 
+    /**
+     * Convert a Time to the std::chrono duration \c D. Integer counts are
+     * rounded to the nearest tick, unlike std::chrono::duration_cast which
+     * truncates:
+     * \code
+     * auto ns = toDuration<std::chrono::nanoseconds>( 1.5_s ) ;
+     * \endcode
+     * Throws std::overflow_error if a NaN or out-of-range Time does not fit
+     * the integer count of \c D.
+     */
+    template<class D>
+    constexpr typename std::enable_if<std::chrono::treat_as_floating_point<typename D::rep>::value, D>::type
+    toDuration( const Time& t ) {
+        return std::chrono::duration_cast<D>( std::chrono::duration<double>( t.getValue() ) );
+    }
+
+    template<class D>
+    constexpr typename std::enable_if<!std::chrono::treat_as_floating_point<typename D::rep>::value, D>::type
+    toDuration( const Time& t ) {
+        using rep = typename D::rep ;
+        const double ticks = t.getValue() * D::period::den / D::period::num + ( t.getValue() < 0 ? -0.5 : 0.5 ) ;
+        if( !( ticks >= static_cast<double>( std::numeric_limits<rep>::min() )
+               && ticks < static_cast<double>( std::numeric_limits<rep>::max() ) + 1.0 ) ) {
+            throw std::overflow_error( "toDuration: time out of range of the duration" );
+        }
+        return D( static_cast<rep>( ticks ) );
+    }
+
     // Additional units for our purpose
     //
     // (see Table 2 at http://physics.nist.gov/cuu/Units/units.html)
@@ -392,6 +880,7 @@ namespace SciQ {
     using SubstanceConcentration = decltype(Substance()/Volume()) ;
     using Luminance              = decltype(Luminous()/Area()) ; 
     using MassFraction           = decltype(Mass()/Mass()) ;
+    using Dimensionless          = decltype(Length()/Length()) ;
 
     // Derived SI units
     //
@@ -1135,9 +1624,9 @@ namespace SciQ {
                 continue ;
             } 
             if (1 == exponents[i] && 1 == exponents[i+1]) {
-                os << " " << base_units[i] ; 
+                os << " " << base_units[i/2] ; 
             } else {
-                os << " " << base_units[i] << "^" << exponents[i] ;
+                os << " " << base_units[i/2] << "^" << exponents[i] ;
             }
             if (1 != exponents[i+1]) {
             	os << "/" << exponents[i+1];
@@ -0,0 +1,362 @@
+/*
+ * Sort.hpp
+ *
+ *      Sorting and searching of Quantity<> arrays. sort() is a least
+ *      significant digit radix sort on the bit patterns of the values,
+ *      which runs on the thread pool for long arrays. lower_bound() and
+ *      upper_bound() are branch-free binary searches, and EytzingerIndex
+ *      keeps a copy of a sorted array in breadth-first order so that
+ *      repeated searches touch few cache lines. Searches compare with the
+ *      operator<() of the quantities, so searching a Length array with a
+ *      Time key fails to compile.
+ *      Link with the platform thread library (-pthread).
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef SORT_HPP_
+#define SORT_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+#include "Parallel.hpp"
+
+namespace SciQ {
+
+    /**
+     * Arrays of at least this many elements are sorted in blocks on the
+     * thread pool.
+     */
+    constexpr std::size_t PARALLEL_SORT_SIZE = std::size_t( 1 ) << 18 ;
+
+    namespace detail {
+        constexpr int RADIX_BITS = 8 ;
+        constexpr int RADIX_PASSES = 64 / RADIX_BITS ;
+        constexpr std::size_t RADIX_BUCKETS = std::size_t( 1 ) << RADIX_BITS ;
+
+        using RadixCounts = std::array<std::size_t, RADIX_BUCKETS> ;
+
+        /**
+         * Unsigned key with the order of the double: the sign bit is set
+         * for positive values and all bits are flipped for negative ones.
+         */
+        inline std::uint64_t sortKey( double x ) {
+            std::uint64_t u ;
+            std::memcpy( &u, &x, sizeof(u) ) ;
+            return u & 0x8000000000000000ull ? ~u : u | 0x8000000000000000ull;
+        }
+
+        inline double fromSortKey( std::uint64_t u ) {
+            u = u & 0x8000000000000000ull ? u & 0x7fffffffffffffffull : ~u ;
+            double x ;
+            std::memcpy( &x, &u, sizeof(x) ) ;
+            return x;
+        }
+
+        inline std::size_t digit( std::uint64_t key, int pass ) {
+            return std::size_t( key >> ( pass * RADIX_BITS ) ) & ( RADIX_BUCKETS - 1 );
+        }
+
+        /**
+         * A pass is needed unless all keys have the same digit.
+         */
+        inline bool needed( const RadixCounts& counts, std::size_t n ) {
+            for( std::size_t c : counts ) {
+                if( c == n ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Stable scatter of keys[first, last) by their digit; \c offsets
+         * holds the first output position of every digit.
+         */
+        inline void scatter( const std::uint64_t * keys, std::size_t first, std::size_t last,
+                             int pass, RadixCounts offsets, std::uint64_t * out ) {
+            for( std::size_t i = first; i < last; ++i ) {
+                out[offsets[digit( keys[i], pass )]++] = keys[i] ;
+            }
+        }
+
+        /**
+         * Sort the \c n keys, using \c buffer of the same size; returns the
+         * array that holds the result. Without a \c pool the keys are
+         * sorted on the calling thread.
+         */
+        inline std::uint64_t * radixSort( std::uint64_t * keys, std::uint64_t * buffer, std::size_t n,
+                                          parallel::ThreadPool * pool = nullptr ) {
+            // The digits of all passes are counted in one read; skipping a
+            // pass does not change the counts of the others
+            std::array<RadixCounts, RADIX_PASSES> counts = {} ;
+            for( std::size_t i = 0; i < n; ++i ) {
+                for( int p = 0; p < RADIX_PASSES; ++p ) {
+                    ++counts[p][digit( keys[i], p )] ;
+                }
+            }
+            const bool inParallel = pool && n >= PARALLEL_SORT_SIZE && pool->size() > 1 ;
+            const std::size_t blocks = inParallel ? 4 * pool->size() : 1 ;
+            const std::size_t block = ( n + blocks - 1 ) / blocks ;
+            std::vector<RadixCounts> blockCounts( blocks ) ;
+
+            for( int p = 0; p < RADIX_PASSES; ++p ) {
+                if( !needed( counts[p], n ) ) {
+                    continue ;
+                }
+                if( inParallel ) {
+                    pool->parallelFor( 0, blocks, 1, [&]( std::size_t b, std::size_t e ) {
+                        for( std::size_t k = b; k < e; ++k ) {
+                            RadixCounts& c = blockCounts[k] ;
+                            c.fill( 0 ) ;
+                            for( std::size_t i = k * block; i < std::min( n, ( k + 1 ) * block ); ++i ) {
+                                ++c[digit( keys[i], p )] ;
+                            }
+                        }
+                    } ) ;
+                    // Turn the counts into output positions, digit by
+                    // digit and within a digit block by block
+                    std::size_t sum = 0 ;
+                    for( std::size_t d = 0; d < RADIX_BUCKETS; ++d ) {
+                        for( RadixCounts& c : blockCounts ) {
+                            const std::size_t count = c[d] ;
+                            c[d] = sum ;
+                            sum += count ;
+                        }
+                    }
+                    pool->parallelFor( 0, blocks, 1, [&]( std::size_t b, std::size_t e ) {
+                        for( std::size_t k = b; k < e; ++k ) {
+                            scatter( keys, std::min( n, k * block ), std::min( n, ( k + 1 ) * block ),
+                                     p, blockCounts[k], buffer ) ;
+                        }
+                    } ) ;
+                } else {
+                    RadixCounts offsets ;
+                    std::size_t sum = 0 ;
+                    for( std::size_t d = 0; d < RADIX_BUCKETS; ++d ) {
+                        offsets[d] = sum ;
+                        sum += counts[p][d] ;
+                    }
+                    scatter( keys, 0, n, p, offsets, buffer ) ;
+                }
+                std::swap( keys, buffer ) ;
+            }
+            return keys;
+        }
+
+        inline int countTrailingZeros( std::uint64_t x ) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll( x );
+#else
+            int n = 0 ;
+            for( ; ( x & 1 ) == 0; x >>= 1 ) {
+                ++n ;
+            }
+            return n;
+#endif
+        }
+    }
+    // namespace detail;
+
+    /**
+     * Sort the quantities in [first, last) in ascending order. Negative
+     * zero sorts before positive zero; NaNs sort before all other values
+     * if their sign bit is set and after them otherwise. Needs twice the
+     * size of the array as temporary memory.
+     */
+    template<typename Q>
+    void sort( Q * first, Q * last, parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+        static_assert( sizeof(Q) == sizeof(double), "Quantity must be layout compatible with double" );
+        const std::size_t n = std::size_t( last - first ) ;
+        if( n < 2 ) {
+            return;
+        }
+        std::vector<std::uint64_t> keys( n ), buffer( n ) ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            keys[i] = detail::sortKey( first[i].getValue() ) ;
+        }
+        const std::uint64_t * sorted = detail::radixSort( keys.data(), buffer.data(), n, &pool ) ;
+        for( std::size_t i = 0; i < n; ++i ) {
+            first[i] = Q( detail::fromSortKey( sorted[i] ) ) ;
+        }
+    }
+
+    template<typename Q>
+    void sort( std::vector<Q>& values, parallel::ThreadPool& pool = parallel::ThreadPool::global() ) {
+        sort( values.data(), values.data() + values.size(), pool ) ;
+    }
+
+    /**
+     * First element of the sorted range [first, last) that is not less
+     * than \c key, or \c last. The loop has no data dependent branches,
+     * so its length depends only on the size of the range, and the two
+     * possible next probes are prefetched.
+     */
+    template<typename Q, typename K>
+    const Q * lower_bound( const Q * first, const Q * last, const K& key ) {
+        std::size_t n = std::size_t( last - first ) ;
+        if( n == 0 ) {
+            return first;
+        }
+        while( n > 1 ) {
+            const std::size_t half = n / 2 ;
+#if defined(__GNUC__) || defined(__clang__)
+            // Fetch both possible next probes while this one is compared
+            __builtin_prefetch( first + half / 2 ) ;
+            __builtin_prefetch( first + half + half / 2 ) ;
+#endif
+            first = first[half] < key ? first + half : first ;
+            n -= half ;
+        }
+        return first + ( *first < key );
+    }
+
+    /**
+     * First element of the sorted range [first, last) that is greater
+     * than \c key, or \c last.
+     */
+    template<typename Q, typename K>
+    const Q * upper_bound( const Q * first, const Q * last, const K& key ) {
+        std::size_t n = std::size_t( last - first ) ;
+        if( n == 0 ) {
+            return first;
+        }
+        while( n > 1 ) {
+            const std::size_t half = n / 2 ;
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch( first + half / 2 ) ;
+            __builtin_prefetch( first + half + half / 2 ) ;
+#endif
+            first = key < first[half] ? first : first + half ;
+            n -= half ;
+        }
+        return first + !( key < *first );
+    }
+
+    template<typename Q, typename K>
+    std::size_t lower_bound( const std::vector<Q>& values, const K& key ) {
+        return std::size_t( lower_bound( values.data(), values.data() + values.size(), key ) - values.data() );
+    }
+
+    template<typename Q, typename K>
+    std::size_t upper_bound( const std::vector<Q>& values, const K& key ) {
+        return std::size_t( upper_bound( values.data(), values.data() + values.size(), key ) - values.data() );
+    }
+
+    /**
+     * Static search index over a sorted array in Eytzinger order: the
+     * children of node k are nodes 2k and 2k + 1. The first levels of the
+     * tree share a few cache lines, and the descendants of a node three
+     * levels down lie in one cache line, which is fetched while the search
+     * descends. For many searches in a large array this beats a binary
+     * search, whose first probes are spread over the whole array.
+     *
+     * \code
+     * EytzingerIndex<Time> index( stamps ) ;
+     * std::size_t i = index.lower_bound( 12.5_s ) ;    // As lower_bound( stamps, 12.5_s )
+     * \endcode
+     */
+    template<typename Q>
+    class EytzingerIndex {
+    public:
+        /**
+         * Index the \c n values at \c sorted, which must be sorted in
+         * ascending order.
+         */
+        EytzingerIndex( const Q * sorted, std::size_t n )
+        : count( n ), storage( n + 1 + LINE ), rank( n + 1 ) {
+            for( std::size_t i = 1; i < n; ++i ) {
+                if( sorted[i] < sorted[i - 1] ) {
+                    throw std::invalid_argument( "EytzingerIndex needs sorted values" );
+                }
+            }
+            // Node 0 is unused; align the tree so that nodes 8k to 8k + 7
+            // share a cache line
+            const std::size_t misalignment = reinterpret_cast<std::uintptr_t>( storage.data() ) / sizeof(double) % LINE ;
+            tree = storage.data() + ( LINE - misalignment ) % LINE ;
+            tree[0] = 0.0 ;
+            rank[0] = n ;
+            std::size_t next = 0 ;
+            fill( sorted, 1, next ) ;
+        }
+
+        explicit EytzingerIndex( const std::vector<Q>& sorted )
+        : EytzingerIndex( sorted.data(), sorted.size() ) {
+        }
+
+        EytzingerIndex( const EytzingerIndex& ) = delete ;
+        EytzingerIndex& operator=( const EytzingerIndex& ) = delete ;
+
+        std::size_t size() const {
+            return count;
+        }
+
+        /**
+         * Position in the sorted array of the first value that is not less
+         * than \c key, or size().
+         */
+        template<typename K>
+        std::size_t lower_bound( const K& key ) const {
+            std::size_t k = 1 ;
+            while( k <= count ) {
+#if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch( tree + LINE * k ) ;
+#endif
+                k = 2 * k + ( Q( tree[k] ) < key ) ;
+            }
+            // Climb back over the right turns that followed the last
+            // left turn, the node where the search went left
+            k >>= detail::countTrailingZeros( ~std::uint64_t( k ) ) + 1 ;
+            return rank[k];
+        }
+
+        /**
+         * Position in the sorted array of the first value that is greater
+         * than \c key, or size().
+         */
+        template<typename K>
+        std::size_t upper_bound( const K& key ) const {
+            std::size_t k = 1 ;
+            while( k <= count ) {
+#if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch( tree + LINE * k ) ;
+#endif
+                k = 2 * k + !( key < Q( tree[k] ) ) ;
+            }
+            k >>= detail::countTrailingZeros( ~std::uint64_t( k ) ) + 1 ;
+            return rank[k];
+        }
+
+    private:
+        static constexpr std::size_t LINE = 64 / sizeof(double) ;
+
+        /**
+         * Fill the subtree of node k in order with the next values.
+         */
+        void fill( const Q * sorted, std::size_t k, std::size_t& next ) {
+            if( k > count ) {
+                return;
+            }
+            fill( sorted, 2 * k, next ) ;
+            tree[k] = sorted[next].getValue() ;
+            rank[k] = next++ ;
+            fill( sorted, 2 * k + 1, next ) ;
+        }
+
+        std::size_t count ;
+        std::vector<double> storage ;
+        std::vector<std::size_t> rank ;
+        double * tree ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* SORT_HPP_ */
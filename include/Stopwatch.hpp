@@ -0,0 +1,463 @@
+/*
+ * Stopwatch.hpp
+ *
+ *      Cheap timing of code sections in Time quantities. Ticks are read
+ *      from the time stamp counter on x86 processors with an invariant TSC
+ *      and from std::chrono::steady_clock elsewhere; they are converted to
+ *      seconds only when a Time is asked for. ScopedTimer records into a
+ *      TimerSite, which keeps the count, total, extremes and a log2
+ *      histogram of the durations of one code site for all threads.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef STOPWATCH_HPP_
+#define STOPWATCH_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(SCIQ_NO_TSC) && ( defined(__x86_64__) || defined(__i386__) ) && ( defined(__GNUC__) || defined(__clang__) )
+#include <cpuid.h>
+#include <x86intrin.h>
+#define SCIQ_HAS_TSC 1
+#elif !defined(SCIQ_NO_TSC) && ( defined(_M_X64) || defined(_M_IX86) )
+#include <intrin.h>
+#define SCIQ_HAS_TSC 1
+#endif
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    namespace detail {
+        /**
+         * True if the time stamp counter runs at a constant rate in all
+         * power states (CPUID 0x80000007, EDX bit 8), which makes it a
+         * clock.
+         */
+        inline bool invariantTsc() {
+#if defined(SCIQ_HAS_TSC) && defined(_MSC_VER)
+            int regs[4] ;
+            __cpuid( regs, 0x80000000 ) ;
+            if( unsigned( regs[0] ) < 0x80000007u ) {
+                return false;
+            }
+            __cpuid( regs, 0x80000007 ) ;
+            return ( regs[3] & ( 1 << 8 ) ) != 0;
+#elif defined(SCIQ_HAS_TSC)
+            unsigned a, b, c, d ;
+            if( __get_cpuid_max( 0x80000000, nullptr ) < 0x80000007u || !__get_cpuid( 0x80000007, &a, &b, &c, &d ) ) {
+                return false;
+            }
+            return ( d & ( 1u << 8 ) ) != 0;
+#else
+            return false;
+#endif
+        }
+
+        inline std::uint64_t steadyTicks() {
+            return std::uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch() ).count() );
+        }
+
+        /**
+         * Number of significant bits of \c x, 0 for 0.
+         */
+        inline int bitWidth( std::uint64_t x ) {
+#if defined(__GNUC__) || defined(__clang__)
+            return x == 0 ? 0 : 64 - __builtin_clzll( x );
+#else
+            int n = 0 ;
+            for( ; x != 0; x >>= 1 ) {
+                ++n ;
+            }
+            return n;
+#endif
+        }
+    }
+    // namespace detail;
+
+    /**
+     * The tick source of Stopwatch and ScopedTimer. The choice between the
+     * TSC and steady_clock is made once, and the TSC is calibrated against
+     * steady_clock for 20 ms when the first ticks are converted to a Time.
+     * Reading the TSC does not wait for earlier instructions to finish, so
+     * sections of less than about a hundred cycles are not resolved.
+     * Define SCIQ_NO_TSC to always use steady_clock.
+     */
+    class TickClock {
+    public:
+        /**
+         * Current tick count; only differences are meaningful.
+         */
+        static std::uint64_t now() {
+#if defined(SCIQ_HAS_TSC)
+            if( usesTsc() ) {
+                return __rdtsc();
+            }
+#endif
+            return detail::steadyTicks();
+        }
+
+        static bool usesTsc() {
+            static const bool tsc = detail::invariantTsc() ;
+            return tsc;
+        }
+
+        /**
+         * Duration of one tick in seconds.
+         */
+        static double secondsPerTick() {
+            static const double seconds = calibrate() ;
+            return seconds;
+        }
+
+        static Time toTime( std::uint64_t ticks ) {
+            return Time( double( ticks ) * secondsPerTick() );
+        }
+
+        static Frequency frequency() {
+            return Frequency( 1.0 / secondsPerTick() );
+        }
+
+    private:
+        static double calibrate() {
+            if( !usesTsc() ) {
+                return 1e-9;
+            }
+            const std::uint64_t steady0 = detail::steadyTicks() ;
+            const std::uint64_t ticks0 = now() ;
+            std::uint64_t steady1 = steady0 ;
+            while( steady1 - steady0 < 20000000 ) {
+                steady1 = detail::steadyTicks() ;
+            }
+            const std::uint64_t ticks1 = now() ;
+            return double( steady1 - steady0 ) * 1e-9 / double( ticks1 - ticks0 );
+        }
+    } ;
+
+    /**
+     * A stopwatch that accumulates the time between start() and stop().
+     *
+     * \code
+     * Stopwatch watch = Stopwatch::started() ;
+     * solve() ;
+     * Time t = watch.stop() ;
+     * \endcode
+     */
+    class Stopwatch {
+    public:
+        Stopwatch()
+        : begin( 0 ), total( 0 ), isRunning( false ) {
+        }
+
+        static Stopwatch started() {
+            Stopwatch watch ;
+            watch.start() ;
+            return watch;
+        }
+
+        void start() {
+            isRunning = true ;
+            begin = TickClock::now() ;
+        }
+
+        /**
+         * Stop and return the time since start(). Stopping a stopwatch
+         * that is not running returns zero.
+         */
+        Time stop() {
+            const std::uint64_t end = TickClock::now() ;
+            if( !isRunning ) {
+                return Time( 0.0 );
+            }
+            isRunning = false ;
+            total += end - begin ;
+            return TickClock::toTime( end - begin );
+        }
+
+        /**
+         * Return the time since start() or the previous lap() and keep
+         * running.
+         */
+        Time lap() {
+            const std::uint64_t end = TickClock::now() ;
+            if( !isRunning ) {
+                return Time( 0.0 );
+            }
+            const std::uint64_t ticks = end - begin ;
+            total += ticks ;
+            begin = end ;
+            return TickClock::toTime( ticks );
+        }
+
+        /**
+         * Sum of all measured intervals, including the current one.
+         */
+        Time elapsed() const {
+            return TickClock::toTime( elapsedTicks() );
+        }
+
+        std::uint64_t elapsedTicks() const {
+            return total + ( isRunning ? TickClock::now() - begin : 0 );
+        }
+
+        void reset() {
+            total = 0 ;
+            isRunning = false ;
+        }
+
+        bool running() const {
+            return isRunning;
+        }
+
+    private:
+        std::uint64_t begin ;
+        std::uint64_t total ;
+        bool isRunning ;
+    } ;
+
+    /**
+     * Statistics of the durations measured at one code site. Bucket b of
+     * the histogram counts durations of b significant bits, i.e. from
+     * 2^(b-1) to 2^b - 1 ticks. All members may be used from several
+     * threads at once.
+     */
+    class TimerSite {
+    public:
+        static constexpr int BUCKETS = 65 ;
+
+        explicit TimerSite( std::string label, const char * sourceFile = "", int sourceLine = 0 )
+        : name( std::move( label ) ), file( sourceFile ), line( sourceLine ), totalTicks( 0 ),
+          minTicks( UINT64_MAX ), maxTicks( 0 ) {
+            for( auto& b : buckets ) {
+                b.store( 0, std::memory_order_relaxed ) ;
+            }
+            std::lock_guard<std::mutex> lock( registryMutex() ) ;
+            registry().push_back( this ) ;
+        }
+
+        TimerSite( const TimerSite& ) = delete ;
+        TimerSite& operator=( const TimerSite& ) = delete ;
+
+        ~TimerSite() {
+            std::lock_guard<std::mutex> lock( registryMutex() ) ;
+            auto& sites = registry() ;
+            sites.erase( std::find( sites.begin(), sites.end(), this ) ) ;
+        }
+
+        void record( std::uint64_t ticks ) {
+            buckets[detail::bitWidth( ticks )].fetch_add( 1, std::memory_order_relaxed ) ;
+            totalTicks.fetch_add( ticks, std::memory_order_relaxed ) ;
+            std::uint64_t m = minTicks.load( std::memory_order_relaxed ) ;
+            while( ticks < m && !minTicks.compare_exchange_weak( m, ticks, std::memory_order_relaxed ) ) {
+            }
+            m = maxTicks.load( std::memory_order_relaxed ) ;
+            while( ticks > m && !maxTicks.compare_exchange_weak( m, ticks, std::memory_order_relaxed ) ) {
+            }
+        }
+
+        void record( const Time& t ) {
+            record( std::uint64_t( std::max( 0.0, t.getValue() ) / TickClock::secondsPerTick() + 0.5 ) ) ;
+        }
+
+        const std::string& label() const {
+            return name;
+        }
+
+        std::string location() const {
+            return std::string( file ) + ":" + std::to_string( line );
+        }
+
+        std::uint64_t count() const {
+            std::uint64_t n = 0 ;
+            for( const auto& b : buckets ) {
+                n += b.load( std::memory_order_relaxed ) ;
+            }
+            return n;
+        }
+
+        /**
+         * Number of measurements in bucket \c b.
+         */
+        std::uint64_t bucket( int b ) const {
+            return buckets[b].load( std::memory_order_relaxed );
+        }
+
+        Time total() const {
+            return TickClock::toTime( totalTicks.load( std::memory_order_relaxed ) );
+        }
+
+        Time mean() const {
+            const std::uint64_t n = count() ;
+            return n == 0 ? Time( 0.0 ) : Time( total().getValue() / double( n ) );
+        }
+
+        Time min() const {
+            return count() == 0 ? Time( 0.0 ) : TickClock::toTime( minTicks.load( std::memory_order_relaxed ) );
+        }
+
+        Time max() const {
+            return TickClock::toTime( maxTicks.load( std::memory_order_relaxed ) );
+        }
+
+        /**
+         * Quantile \c p, from 0 to 1, interpolated linearly within its
+         * histogram bucket and thus accurate to a factor of two at worst.
+         */
+        Time quantile( double p ) const {
+            std::array<std::uint64_t, BUCKETS> counts ;
+            std::uint64_t n = 0 ;
+            for( int b = 0; b < BUCKETS; ++b ) {
+                counts[b] = bucket( b ) ;
+                n += counts[b] ;
+            }
+            if( n == 0 ) {
+                return Time( 0.0 );
+            }
+            const double rank = std::min( std::max( p, 0.0 ), 1.0 ) * double( n ) ;
+            double below = 0 ;
+            int b = 0 ;
+            for( ; b < BUCKETS - 1 && below + double( counts[b] ) < rank; ++b ) {
+                below += double( counts[b] ) ;
+            }
+            const double lo = b == 0 ? 0.0 : std::ldexp( 1.0, b - 1 ) ;
+            const double hi = b == 0 ? 1.0 : std::ldexp( 1.0, b ) ;
+            const double ticks = counts[b] == 0 ? lo : lo + ( hi - lo ) * ( rank - below ) / double( counts[b] ) ;
+            const double clamped = std::min( std::max( ticks, double( minTicks.load( std::memory_order_relaxed ) ) ),
+                                             double( maxTicks.load( std::memory_order_relaxed ) ) ) ;
+            return Time( clamped * TickClock::secondsPerTick() );
+        }
+
+        void reset() {
+            for( auto& b : buckets ) {
+                b.store( 0, std::memory_order_relaxed ) ;
+            }
+            totalTicks.store( 0, std::memory_order_relaxed ) ;
+            minTicks.store( UINT64_MAX, std::memory_order_relaxed ) ;
+            maxTicks.store( 0, std::memory_order_relaxed ) ;
+        }
+
+        /**
+         * The sites that exist now, in the order of their construction.
+         */
+        static std::vector<const TimerSite *> all() {
+            std::lock_guard<std::mutex> lock( registryMutex() ) ;
+            return std::vector<const TimerSite *>( registry().begin(), registry().end() );
+        }
+
+        /**
+         * Print one line per site that has measurements: count, total,
+         * mean, median, 99th percentile and maximum.
+         */
+        static void report( std::ostream& os ) {
+            const std::streamsize precision = os.precision( 4 ) ;
+            os << std::left << std::setw( 24 ) << "site" << std::right
+               << std::setw( 10 ) << "count" << std::setw( 13 ) << "total"
+               << std::setw( 13 ) << "mean" << std::setw( 13 ) << "p50"
+               << std::setw( 13 ) << "p99" << std::setw( 13 ) << "max" << "\n" ;
+            for( const TimerSite * s : all() ) {
+                if( s->count() == 0 ) {
+                    continue ;
+                }
+                os << std::left << std::setw( 24 ) << s->label() << std::right
+                   << std::setw( 10 ) << s->count() ;
+                for( const Time& t : { s->total(), s->mean(), s->quantile( 0.5 ), s->quantile( 0.99 ), s->max() } ) {
+                    os << std::setw( 11 ) << t.getValue() << " s" ;
+                }
+                os << "\n" ;
+            }
+            os.precision( precision ) ;
+            os << std::flush ;
+        }
+
+    private:
+        static std::mutex& registryMutex() {
+            static std::mutex mutex ;
+            return mutex;
+        }
+
+        static std::vector<TimerSite *>& registry() {
+            static std::vector<TimerSite *> sites ;
+            return sites;
+        }
+
+        std::string name ;
+        const char * file ;
+        int line ;
+        std::array<std::atomic<std::uint64_t>, BUCKETS> buckets ;
+        std::atomic<std::uint64_t> totalTicks ;
+        std::atomic<std::uint64_t> minTicks ;
+        std::atomic<std::uint64_t> maxTicks ;
+    } ;
+
+    /**
+     * Measure the lifetime of the timer and record it in a TimerSite or add
+     * it to a Time.
+     *
+     * \code
+     * static TimerSite assembly( "assembly" ) ;
+     * {
+     *     ScopedTimer timer( assembly ) ;
+     *     assemble() ;
+     * }
+     * \endcode
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer( TimerSite& into )
+        : site( &into ), sum( nullptr ), begin( TickClock::now() ) {
+        }
+
+        explicit ScopedTimer( Time& addTo )
+        : site( nullptr ), sum( &addTo ), begin( TickClock::now() ) {
+        }
+
+        ScopedTimer( const ScopedTimer& ) = delete ;
+        ScopedTimer& operator=( const ScopedTimer& ) = delete ;
+
+        ~ScopedTimer() {
+            const std::uint64_t ticks = TickClock::now() - begin ;
+            if( site ) {
+                site->record( ticks ) ;
+            } else {
+                *sum += TickClock::toTime( ticks ) ;
+            }
+        }
+
+        /**
+         * Time since construction.
+         */
+        Time elapsed() const {
+            return TickClock::toTime( TickClock::now() - begin );
+        }
+
+    private:
+        TimerSite * site ;
+        Time * sum ;
+        std::uint64_t begin ;
+    } ;
+
+}
+// namespace SciQ;
+
+/**
+ * Time the rest of the enclosing block into a TimerSite named \c label,
+ * one per use of the macro.
+ */
+#define SCIQ_TIME_SCOPE( label ) \
+    static ::SciQ::TimerSite SCIQ_CONCAT( sciqTimerSite, __LINE__ )( label, __FILE__, __LINE__ ) ; \
+    ::SciQ::ScopedTimer SCIQ_CONCAT( sciqTimer, __LINE__ )( SCIQ_CONCAT( sciqTimerSite, __LINE__ ) )
+
+#endif /* STOPWATCH_HPP_ */
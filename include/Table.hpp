@@ -0,0 +1,367 @@
+/*
+ * Table.hpp
+ *
+ *      Lookup tables over Quantity<> axes with nearest, linear and cubic
+ *      interpolation. Uniformly spaced axes are detected on construction and
+ *      looked up with a single multiplication instead of a binary search.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef TABLE_HPP_
+#define TABLE_HPP_
+
+#include <algorithm>
+#include <vector>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * Interpolation between the points of a table.
+     *
+     * - Nearest: value of the closest point.
+     * - Linear: straight line between the two surrounding points.
+     * - Cubic: cubic Hermite spline whose slopes are the central differences
+     *   of the neighbouring points (Catmull-Rom on uniform axes).
+     */
+    enum class Interpolation {
+        Nearest,
+        Linear,
+        Cubic
+    } ;
+
+    /**
+     * Sorted axis of a table. Stores the points as plain doubles in the
+     * fundamental SI unit.
+     */
+    class TableAxis {
+    public:
+        /**
+         * Maximum number of table points that contribute to an interpolated
+         * value along one axis.
+         */
+        static constexpr int MAX_TAPS = 4 ;
+
+        TableAxis() = default ;
+
+        /**
+         * Creates an axis from strictly increasing points. Throws
+         * std::invalid_argument if there are fewer than two points or if
+         * they are not strictly increasing.
+         */
+        explicit TableAxis( std::vector<double> pts )
+        : points( std::move( pts ) ) {
+            if( points.size() < 2 ) {
+                throw std::invalid_argument( "Table axis needs at least two points" );
+            }
+            for( std::size_t i = 1; i < points.size(); ++i ) {
+                if( !( points[i] > points[i-1] ) ) {
+                    throw std::invalid_argument( "Table axis must be strictly increasing" );
+                }
+            }
+            step = ( points.back() - points.front() ) / ( points.size() - 1 ) ;
+            invStep = 1.0 / step ;
+            uniform = true ;
+            const double tolerance = 1e-9 * step ;
+            for( std::size_t i = 1; i + 1 < points.size() && uniform; ++i ) {
+                uniform = std::abs( points[i] - ( points.front() + i * step ) ) <= tolerance ;
+            }
+        }
+
+        /**
+         * Creates a uniform axis with \c n points starting at \c first.
+         */
+        TableAxis( double first, double step, std::size_t n )
+        : TableAxis( uniformPoints( first, step, n ) ) {
+        }
+
+        std::size_t size() const {
+            return points.size();
+        }
+
+        double operator[]( std::size_t i ) const {
+            return points[i];
+        }
+
+        /**
+         * True if the points are (numerically) equally spaced.
+         */
+        bool isUniform() const {
+            return uniform;
+        }
+
+        /**
+         * Find the interval [points[i], points[i+1]] that contains \c x and the
+         * position \c t in [0,1] of \c x inside it. Values outside the axis
+         * are clamped to its ends; NaN gives the first interval and a NaN
+         * \c t, so that interpolation returns NaN.
+         */
+        std::size_t locate( double x, double * t ) const {
+            const std::size_t last = points.size() - 2 ;
+            std::size_t i ;
+            if( uniform ) {
+                const double s = ( x - points.front() ) * invStep ;
+                // Written so that NaN is clamped to 0 as well
+                const double clamped = s > 0.0 ? std::min( s, static_cast<double>( last ) ) : 0.0 ;
+                i = static_cast<std::size_t>( clamped ) ;
+                *t = std::min( std::max( s - i, 0.0 ), 1.0 ) ;
+            } else {
+                i = std::upper_bound( points.begin() + 1, points.end() - 1, x ) - points.begin() - 1 ;
+                *t = std::min( std::max( ( x - points[i] ) / ( points[i+1] - points[i] ), 0.0 ), 1.0 ) ;
+            }
+            return i;
+        }
+
+        /**
+         * Compute the points that contribute to the interpolated value at \c x
+         * and their weights. The interpolated value is the sum of
+         * weights[k] * value[indices[k]] for k < MAX_TAPS; unused taps have a
+         * weight of zero. All weights are NaN if \c x is NaN.
+         */
+        void weights( double x, Interpolation method, std::size_t indices[MAX_TAPS], double w[MAX_TAPS] ) const {
+            double t ;
+            const std::size_t i = locate( x, &t ) ;
+            const std::size_t n = points.size() ;
+            for( int k = 0; k < MAX_TAPS; ++k ) {
+                indices[k] = std::min( n - 1, i + k > 0 ? i + k - 1 : 0 ) ;
+                w[k] = t == t ? 0.0 : t ;
+            }
+            if( t != t ) {
+                return;
+            }
+            switch( method ) {
+                case Interpolation::Nearest:
+                    w[t < 0.5 ? 1 : 2] = 1 ;
+                    break;
+                case Interpolation::Linear:
+                    w[1] = 1 - t ;
+                    w[2] = t ;
+                    break;
+                case Interpolation::Cubic: {
+                    const double h = points[i+1] - points[i] ;
+                    const double t2 = t * t ;
+                    const double t3 = t2 * t ;
+                    const double h00 = 2 * t3 - 3 * t2 + 1 ;
+                    const double h10 = t3 - 2 * t2 + t ;
+                    const double h01 = -2 * t3 + 3 * t2 ;
+                    const double h11 = t3 - t2 ;
+                    w[1] += h00 ;
+                    w[2] += h01 ;
+                    // Slope at point i: difference of its neighbours (one sided at the ends)
+                    const std::size_t lo0 = i > 0 ? i - 1 : i ;
+                    const std::size_t hi0 = i + 1 ;
+                    const double c0 = h * h10 / ( points[hi0] - points[lo0] ) ;
+                    w[lo0 + 1 - i] -= c0 ;
+                    w[hi0 + 1 - i] += c0 ;
+                    // Slope at point i+1
+                    const std::size_t lo1 = i ;
+                    const std::size_t hi1 = i + 2 < n ? i + 2 : i + 1 ;
+                    const double c1 = h * h11 / ( points[hi1] - points[lo1] ) ;
+                    w[lo1 + 1 - i] -= c1 ;
+                    w[hi1 + 1 - i] += c1 ;
+                    break;
+                }
+            }
+        }
+
+    private:
+        static std::vector<double> uniformPoints( double first, double step, std::size_t n ) {
+            std::vector<double> pts( n ) ;
+            for( std::size_t i = 0; i < n; ++i ) {
+                pts[i] = first + i * step ;
+            }
+            return pts;
+        }
+
+        std::vector<double> points ;
+        double step = 0 ;
+        double invStep = 0 ;
+        bool uniform = false ;
+    } ;
+
+    namespace detail {
+        template<typename Q>
+        std::vector<double> valuesOf( const std::vector<Q>& quantities ) {
+            std::vector<double> values( quantities.size() ) ;
+            for( std::size_t i = 0; i < quantities.size(); ++i ) {
+                values[i] = quantities[i].getValue() ;
+            }
+            return values;
+        }
+    }
+
+    /**
+     * One dimensional lookup table that maps a quantity XQ to a quantity YQ.
+     * Arguments outside of the table are clamped to its first and last
+     * point.
+     *
+     * \code
+     * Table1D<Temperature, DynamicViscosity> viscosity(
+     *     { 273.15_K, 293.15_K, 313.15_K },
+     *     { DynamicViscosity(1.79e-3), DynamicViscosity(1.00e-3), DynamicViscosity(0.65e-3) },
+     *     Interpolation::Cubic ) ;
+     * DynamicViscosity mu = viscosity( 300_K ) ;
+     * \endcode
+     */
+    template<typename XQ, typename YQ>
+    class Table1D {
+    public:
+        /**
+         * Creates a table from the strictly increasing points \c x and the
+         * corresponding values \c y.
+         */
+        Table1D( const std::vector<XQ>& x, const std::vector<YQ>& y,
+                 Interpolation method = Interpolation::Linear )
+        : axis( detail::valuesOf( x ) ), values( detail::valuesOf( y ) ), method( method ) {
+            if( values.size() != axis.size() ) {
+                throw std::invalid_argument( "Table1D: number of values does not match the axis" );
+            }
+        }
+
+        /**
+         * Creates a table with a uniform axis starting at \c first with the
+         * spacing \c step.
+         */
+        Table1D( const XQ& first, const XQ& step, const std::vector<YQ>& y,
+                 Interpolation method = Interpolation::Linear )
+        : axis( first.getValue(), step.getValue(), y.size() ), values( detail::valuesOf( y ) ), method( method ) {
+        }
+
+        const TableAxis& getAxis() const {
+            return axis;
+        }
+
+        Interpolation getInterpolation() const {
+            return method;
+        }
+
+        /**
+         * Interpolated value at \c x.
+         */
+        YQ operator()( const XQ& x ) const {
+            if( method == Interpolation::Linear ) {
+                double t ;
+                const std::size_t i = axis.locate( x.getValue(), &t ) ;
+                return YQ( values[i] + t * ( values[i+1] - values[i] ) );
+            }
+            std::size_t indices[TableAxis::MAX_TAPS] ;
+            double w[TableAxis::MAX_TAPS] ;
+            axis.weights( x.getValue(), method, indices, w ) ;
+            double y = 0 ;
+            for( int k = 0; k < TableAxis::MAX_TAPS; ++k ) {
+                y += w[k] * values[indices[k]] ;
+            }
+            return YQ( y );
+        }
+
+        /**
+         * Interpolate the table at the \c n arguments \c x and store the
+         * results in \c y. Linear interpolation on a uniform axis is done in
+         * a branch-free loop that the compiler can vectorize.
+         */
+        void evaluate( const XQ * x, std::size_t n, YQ * y ) const {
+            if( method == Interpolation::Linear && axis.isUniform() ) {
+                const double first = axis[0] ;
+                const double inv_step = ( axis.size() - 1 ) / ( axis[axis.size() - 1] - first ) ;
+                const double last = static_cast<double>( axis.size() - 2 ) ;
+                const double * v = values.data() ;
+                for( std::size_t k = 0; k < n; ++k ) {
+                    const double s = ( x[k].getValue() - first ) * inv_step ;
+                    // Clamps NaN to 0 as well; t and the result stay NaN
+                    const double c = s > 0.0 ? std::min( s, last ) : 0.0 ;
+                    const std::size_t i = static_cast<std::size_t>( c ) ;
+                    const double t = std::min( std::max( s - i, 0.0 ), 1.0 ) ;
+                    y[k] = YQ( v[i] + t * ( v[i+1] - v[i] ) ) ;
+                }
+                return;
+            }
+            for( std::size_t k = 0; k < n; ++k ) {
+                y[k] = (*this)( x[k] ) ;
+            }
+        }
+
+        std::vector<YQ> evaluate( const std::vector<XQ>& x ) const {
+            std::vector<YQ> y( x.size() ) ;
+            evaluate( x.data(), x.size(), y.data() ) ;
+            return y;
+        }
+
+    private:
+        TableAxis axis ;
+        std::vector<double> values ;
+        Interpolation method ;
+    } ;
+
+    /**
+     * Two dimensional lookup table that maps the quantities (XQ, YQ) to a
+     * quantity ZQ. The values are stored row-major: the value at (x[i], y[j])
+     * is z[i * y.size() + j]. Interpolation is the tensor product of the
+     * one dimensional interpolation along each axis.
+     */
+    template<typename XQ, typename YQ, typename ZQ>
+    class Table2D {
+    public:
+        Table2D( const std::vector<XQ>& x, const std::vector<YQ>& y, const std::vector<ZQ>& z,
+                 Interpolation method = Interpolation::Linear )
+        : xAxis( detail::valuesOf( x ) ), yAxis( detail::valuesOf( y ) ), values( detail::valuesOf( z ) ),
+          method( method ) {
+            if( values.size() != xAxis.size() * yAxis.size() ) {
+                throw std::invalid_argument( "Table2D: number of values does not match the axes" );
+            }
+        }
+
+        const TableAxis& getXAxis() const {
+            return xAxis;
+        }
+
+        const TableAxis& getYAxis() const {
+            return yAxis;
+        }
+
+        /**
+         * Interpolated value at (x, y).
+         */
+        ZQ operator()( const XQ& x, const YQ& y ) const {
+            std::size_t xi[TableAxis::MAX_TAPS], yi[TableAxis::MAX_TAPS] ;
+            double xw[TableAxis::MAX_TAPS], yw[TableAxis::MAX_TAPS] ;
+            xAxis.weights( x.getValue(), method, xi, xw ) ;
+            yAxis.weights( y.getValue(), method, yi, yw ) ;
+            const std::size_t ny = yAxis.size() ;
+            double z = 0 ;
+            for( int a = 0; a < TableAxis::MAX_TAPS; ++a ) {
+                if( xw[a] == 0 ) {
+                    continue;
+                }
+                const double * row = values.data() + xi[a] * ny ;
+                double r = 0 ;
+                for( int b = 0; b < TableAxis::MAX_TAPS; ++b ) {
+                    r += yw[b] * row[yi[b]] ;
+                }
+                z += xw[a] * r ;
+            }
+            return ZQ( z );
+        }
+
+        /**
+         * Interpolate the table at the \c n points (x[k], y[k]) and store the
+         * results in \c z.
+         */
+        void evaluate( const XQ * x, const YQ * y, std::size_t n, ZQ * z ) const {
+            for( std::size_t k = 0; k < n; ++k ) {
+                z[k] = (*this)( x[k], y[k] ) ;
+            }
+        }
+
+    private:
+        TableAxis xAxis ;
+        TableAxis yAxis ;
+        std::vector<double> values ;
+        Interpolation method ;
+    } ;
+
+}
+// namespace SciQ;
+
+#endif /* TABLE_HPP_ */
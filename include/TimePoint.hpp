@@ -0,0 +1,201 @@
+/*
+ * TimePoint.hpp
+ *
+ *      Timestamps as integer nanoseconds. A double holds about 16
+ *      significant digits, so a Time of 1.7e9 s since the Unix epoch
+ *      resolves only about 0.2 us; a TimePoint keeps every nanosecond for
+ *      +/- 292 years around its epoch. The difference of two TimePoints is
+ *      computed exactly in integers and only then converted to a Time.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef TIMEPOINT_HPP_
+#define TIMEPOINT_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * A point in time, stored as a signed 64-bit count of nanoseconds since
+     * an epoch: the Unix epoch for now() and the epoch of the clock for
+     * time points converted from std::chrono. TimePoints of different
+     * epochs must not be mixed.
+     *
+     * Adding a Time rounds it to the nearest nanosecond; adding a
+     * std::chrono duration is exact for whole nanoseconds.
+     *
+     * \code
+     * TimePoint start = TimePoint::now() ;
+     * TimePoint deadline = start + 2.5_s ;
+     * Time left = deadline - TimePoint::now() ;
+     * \endcode
+     */
+    class TimePoint {
+    public:
+        constexpr TimePoint()
+        : ns( 0 ) {
+        }
+
+        /**
+         * The time point \c nanoseconds after the epoch.
+         */
+        static constexpr TimePoint fromNanoseconds( std::int64_t nanoseconds ) {
+            return TimePoint( nanoseconds );
+        }
+
+        /**
+         * Convert a std::chrono time point, relative to the epoch of its
+         * clock. Ticks finer than a nanosecond are truncated.
+         */
+        template<class Clock, class Duration>
+        constexpr explicit TimePoint( const std::chrono::time_point<Clock, Duration>& t )
+        : ns( std::chrono::duration_cast<std::chrono::nanoseconds>( t.time_since_epoch() ).count() ) {
+        }
+
+        /**
+         * The current time of the system clock, relative to the Unix epoch.
+         */
+        static TimePoint now() {
+            return TimePoint( std::chrono::system_clock::now() );
+        }
+
+        constexpr std::int64_t nanoseconds() const {
+            return ns;
+        }
+
+        constexpr std::chrono::nanoseconds sinceEpoch() const {
+            return std::chrono::nanoseconds( ns );
+        }
+
+        /**
+         * Convert to a std::chrono time point of \c Clock, which must have
+         * the same epoch.
+         */
+        template<class Clock>
+        constexpr typename Clock::time_point toTimePoint() const {
+            return typename Clock::time_point(
+                std::chrono::duration_cast<typename Clock::duration>( std::chrono::nanoseconds( ns ) ) );
+        }
+
+        /**
+         * Exact time elapsed since \c earlier.
+         */
+        constexpr std::chrono::nanoseconds since( const TimePoint& earlier ) const {
+            return std::chrono::nanoseconds( ns - earlier.ns );
+        }
+
+        TimePoint& operator+=( const Time& dt ) {
+            ns += toDuration<std::chrono::nanoseconds>( dt ).count() ;
+            return *this;
+        }
+
+        TimePoint& operator-=( const Time& dt ) {
+            ns -= toDuration<std::chrono::nanoseconds>( dt ).count() ;
+            return *this;
+        }
+
+        template<class Rep, class Period>
+        TimePoint& operator+=( const std::chrono::duration<Rep, Period>& dt ) {
+            ns += std::chrono::duration_cast<std::chrono::nanoseconds>( dt ).count() ;
+            return *this;
+        }
+
+        template<class Rep, class Period>
+        TimePoint& operator-=( const std::chrono::duration<Rep, Period>& dt ) {
+            ns -= std::chrono::duration_cast<std::chrono::nanoseconds>( dt ).count() ;
+            return *this;
+        }
+
+    private:
+        constexpr explicit TimePoint( std::int64_t nanoseconds )
+        : ns( nanoseconds ) {
+        }
+
+        std::int64_t ns ;
+    } ;
+
+    inline TimePoint operator+( TimePoint lhs, const Time& rhs ) {
+        return lhs += rhs;
+    }
+
+    inline TimePoint operator+( const Time& lhs, TimePoint rhs ) {
+        return rhs += lhs;
+    }
+
+    inline TimePoint operator-( TimePoint lhs, const Time& rhs ) {
+        return lhs -= rhs;
+    }
+
+    template<class Rep, class Period>
+    TimePoint operator+( TimePoint lhs, const std::chrono::duration<Rep, Period>& rhs ) {
+        return lhs += rhs;
+    }
+
+    template<class Rep, class Period>
+    TimePoint operator-( TimePoint lhs, const std::chrono::duration<Rep, Period>& rhs ) {
+        return lhs -= rhs;
+    }
+
+    /**
+     * Time from \c rhs to \c lhs. The difference is exact; its conversion to
+     * double seconds is exact for up to 104 days.
+     */
+    inline constexpr Time operator-( const TimePoint& lhs, const TimePoint& rhs ) {
+        return Time( lhs.since( rhs ) );
+    }
+
+    inline constexpr bool operator==( const TimePoint& lhs, const TimePoint& rhs ) {
+        return lhs.nanoseconds() == rhs.nanoseconds();
+    }
+
+    inline constexpr bool operator!=( const TimePoint& lhs, const TimePoint& rhs ) {
+        return lhs.nanoseconds() != rhs.nanoseconds();
+    }
+
+    inline constexpr bool operator<( const TimePoint& lhs, const TimePoint& rhs ) {
+        return lhs.nanoseconds() < rhs.nanoseconds();
+    }
+
+    inline constexpr bool operator<=( const TimePoint& lhs, const TimePoint& rhs ) {
+        return lhs.nanoseconds() <= rhs.nanoseconds();
+    }
+
+    inline constexpr bool operator>( const TimePoint& lhs, const TimePoint& rhs ) {
+        return lhs.nanoseconds() > rhs.nanoseconds();
+    }
+
+    inline constexpr bool operator>=( const TimePoint& lhs, const TimePoint& rhs ) {
+        return lhs.nanoseconds() >= rhs.nanoseconds();
+    }
+
+    /**
+     * Print the seconds since the epoch with all nine decimals, e.g.
+     * "1700000000.000000001 s".
+     */
+    inline std::ostream& operator<<( std::ostream& os, const TimePoint& t )
+    {
+        const std::int64_t s = t.nanoseconds() / 1000000000 ;
+        std::int64_t f = t.nanoseconds() % 1000000000 ;
+        if( f < 0 ) {
+            f = -f ;
+        }
+        if( t.nanoseconds() < 0 && s == 0 ) {
+            os << "-" ;
+        }
+        const char fill = os.fill( '0' ) ;
+        os << s << "." << std::setw( 9 ) << f << " s" ;
+        os.fill( fill ) ;
+        return os ;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* TIMEPOINT_HPP_ */
@@ -0,0 +1,334 @@
+/*
+ * Vector.hpp
+ *
+ *      Fixed-size vectors of Quantity<> values (Vec2, Vec3, Vec4). The
+ *      components are stored as aligned doubles, with Vec3 padded to four
+ *      lanes, so that the element-wise loops below compile to SSE/AVX
+ *      instructions. Results are dimensioned the same way as the scalar
+ *      operators: the cross product of a Vec3<Length> and a Vec3<Force> is a
+ *      Vec3<MomentOfForce>.
+ *
+ *      Location: https://github.com/nourani/ScientificQuantities
+ */
+
+#ifndef VECTOR_HPP_
+#define VECTOR_HPP_
+
+#include <type_traits>
+
+#include "ScientificQuantities.hpp"
+
+namespace SciQ {
+
+    /**
+     * Vector of N components of the quantity Q. Use the aliases Vec2, Vec3
+     * and Vec4.
+     */
+    template<typename Q, std::size_t N>
+    class Vector {
+    public:
+        static_assert( N >= 2 && N <= 4, "Vectors have two, three or four components" );
+
+        /**
+         * Number of lanes of the storage. Vec3 is padded with a fourth lane
+         * that is always zero.
+         */
+        static constexpr std::size_t LANES = N == 2 ? 2 : 4 ;
+
+        /**
+         * The quantity of the components.
+         */
+        using ValueType = Q ;
+
+        /**
+         * Creates a vector with all components zero.
+         */
+        constexpr Vector()
+        : v{} {
+        }
+
+        template<std::size_t M = N, typename std::enable_if<M == 2>::type* = nullptr>
+        constexpr Vector( const Q& x, const Q& y )
+        : v{ x.getValue(), y.getValue() } {
+        }
+
+        template<std::size_t M = N, typename std::enable_if<M == 3>::type* = nullptr>
+        constexpr Vector( const Q& x, const Q& y, const Q& z )
+        : v{ x.getValue(), y.getValue(), z.getValue(), 0.0 } {
+        }
+
+        template<std::size_t M = N, typename std::enable_if<M == 4>::type* = nullptr>
+        constexpr Vector( const Q& x, const Q& y, const Q& z, const Q& w )
+        : v{ x.getValue(), y.getValue(), z.getValue(), w.getValue() } {
+        }
+
+        static constexpr std::size_t size() {
+            return N;
+        }
+
+        constexpr Q operator[]( std::size_t i ) const {
+            return Q( v[i] );
+        }
+
+        constexpr Q x() const {
+            return Q( v[0] );
+        }
+
+        constexpr Q y() const {
+            return Q( v[1] );
+        }
+
+        template<std::size_t M = N, typename std::enable_if<(M >= 3)>::type* = nullptr>
+        constexpr Q z() const {
+            return Q( v[2] );
+        }
+
+        template<std::size_t M = N, typename std::enable_if<(M == 4)>::type* = nullptr>
+        constexpr Q w() const {
+            return Q( v[3] );
+        }
+
+        void set( std::size_t i, const Q& q ) {
+            v[i] = q.getValue() ;
+        }
+
+        /**
+         * Pointer to the component values in the fundamental SI unit.
+         */
+        const double * data() const {
+            return v;
+        }
+
+        double * data() {
+            return v;
+        }
+
+        Vector& operator+=( const Vector& rhs ) {
+            for( std::size_t i = 0; i < LANES; ++i ) {
+                v[i] += rhs.v[i] ;
+            }
+            return *this;
+        }
+
+        Vector& operator-=( const Vector& rhs ) {
+            for( std::size_t i = 0; i < LANES; ++i ) {
+                v[i] -= rhs.v[i] ;
+            }
+            return *this;
+        }
+
+        Vector& operator*=( double rhs ) {
+            for( std::size_t i = 0; i < LANES; ++i ) {
+                v[i] *= rhs ;
+            }
+            // 0 * inf would turn the padding into NaN
+            for( std::size_t i = N; i < LANES; ++i ) {
+                v[i] = 0 ;
+            }
+            return *this;
+        }
+
+        Vector& operator/=( double rhs ) {
+            return *this *= 1.0 / rhs;
+        }
+
+    private:
+        alignas( LANES * sizeof(double) ) double v[LANES] ;
+    } ;
+
+    template<typename Q> using Vec2 = Vector<Q, 2> ;
+    template<typename Q> using Vec3 = Vector<Q, 3> ;
+    template<typename Q> using Vec4 = Vector<Q, 4> ;
+
+    namespace detail {
+        /**
+         * Apply \c op to all lanes of \c a and \c b and store the results
+         * in a vector of quantity R. The padding lane is reset to zero
+         * afterwards, whatever \c op made of it.
+         */
+        template<typename R, typename Q1, typename Q2, std::size_t N, typename Op>
+        Vector<R, N> lanewise( const Vector<Q1, N>& a, const Vector<Q2, N>& b, Op op ) {
+            Vector<R, N> result ;
+            double * r = result.data() ;
+            const double * x = a.data() ;
+            const double * y = b.data() ;
+            for( std::size_t i = 0; i < Vector<R, N>::LANES; ++i ) {
+                r[i] = op( x[i], y[i] ) ;
+            }
+            for( std::size_t i = N; i < Vector<R, N>::LANES; ++i ) {
+                r[i] = 0 ;
+            }
+            return result;
+        }
+
+        template<typename R, typename Q, std::size_t N, typename Op>
+        Vector<R, N> lanewise( const Vector<Q, N>& a, Op op ) {
+            Vector<R, N> result ;
+            double * r = result.data() ;
+            const double * x = a.data() ;
+            for( std::size_t i = 0; i < Vector<R, N>::LANES; ++i ) {
+                r[i] = op( x[i] ) ;
+            }
+            for( std::size_t i = N; i < Vector<R, N>::LANES; ++i ) {
+                r[i] = 0 ;
+            }
+            return result;
+        }
+    }
+
+    //
+    // Arithmetic operators for Vector<> instances.
+    //
+    template<typename Q, std::size_t N>
+    Vector<Q, N> operator+( const Vector<Q, N>& lhs, const Vector<Q, N>& rhs ) {
+        return Vector<Q, N>( lhs ) += rhs;
+    }
+
+    template<typename Q, std::size_t N>
+    Vector<Q, N> operator-( const Vector<Q, N>& lhs, const Vector<Q, N>& rhs ) {
+        return Vector<Q, N>( lhs ) -= rhs;
+    }
+
+    template<typename Q, std::size_t N>
+    Vector<Q, N> operator-( const Vector<Q, N>& rhs ) {
+        return detail::lanewise<Q>( rhs, []( double a ) { return -a; } );
+    }
+
+    template<typename Q, std::size_t N>
+    Vector<Q, N> operator*( const Vector<Q, N>& lhs, double rhs ) {
+        return Vector<Q, N>( lhs ) *= rhs;
+    }
+
+    template<typename Q, std::size_t N>
+    Vector<Q, N> operator*( double lhs, const Vector<Q, N>& rhs ) {
+        return Vector<Q, N>( rhs ) *= lhs;
+    }
+
+    template<typename Q, std::size_t N>
+    Vector<Q, N> operator/( const Vector<Q, N>& lhs, double rhs ) {
+        return Vector<Q, N>( lhs ) /= rhs;
+    }
+
+    /**
+     * Scale a vector by a quantity: Vec3<Speed> * Time is a Vec3<Length>.
+     */
+    template<typename Q, std::size_t N, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Vector<decltype( Q() * Quantity<L, M, T, EC, TT, AS, LI>() ), N>
+    operator*( const Vector<Q, N>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        const double s = rhs.getValue() ;
+        return detail::lanewise<decltype( Q() * rhs )>( lhs, [s]( double a ) { return a * s; } );
+    }
+
+    template<typename Q, std::size_t N, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Vector<decltype( Quantity<L, M, T, EC, TT, AS, LI>() * Q() ), N>
+    operator*( const Quantity<L, M, T, EC, TT, AS, LI>& lhs, const Vector<Q, N>& rhs ) {
+        const double s = lhs.getValue() ;
+        return detail::lanewise<decltype( lhs * Q() )>( rhs, [s]( double a ) { return s * a; } );
+    }
+
+    template<typename Q, std::size_t N, class L, class M, class T, class EC, class TT, class AS, class LI>
+    Vector<decltype( Q() / Quantity<L, M, T, EC, TT, AS, LI>() ), N>
+    operator/( const Vector<Q, N>& lhs, const Quantity<L, M, T, EC, TT, AS, LI>& rhs ) {
+        const double s = 1.0 / rhs.getValue() ;
+        return detail::lanewise<decltype( Q() / rhs )>( lhs, [s]( double a ) { return a * s; } );
+    }
+
+    template<typename Q, std::size_t N>
+    bool operator==( const Vector<Q, N>& lhs, const Vector<Q, N>& rhs ) {
+        for( std::size_t i = 0; i < N; ++i ) {
+            if( lhs.data()[i] != rhs.data()[i] ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename Q, std::size_t N>
+    bool operator!=( const Vector<Q, N>& lhs, const Vector<Q, N>& rhs ) {
+        return !( lhs == rhs );
+    }
+
+    /**
+     * Component-wise product of two vectors.
+     */
+    template<typename Q1, typename Q2, std::size_t N>
+    Vector<decltype( Q1() * Q2() ), N> elementwiseMultiply( const Vector<Q1, N>& lhs, const Vector<Q2, N>& rhs ) {
+        return detail::lanewise<decltype( Q1() * Q2() )>( lhs, rhs, []( double a, double b ) { return a * b; } );
+    }
+
+    /**
+     * Component-wise quotient of two vectors; 0/0 components are NaN.
+     */
+    template<typename Q1, typename Q2, std::size_t N>
+    Vector<decltype( Q1() / Q2() ), N> elementwiseDivide( const Vector<Q1, N>& lhs, const Vector<Q2, N>& rhs ) {
+        return detail::lanewise<decltype( Q1() / Q2() )>( lhs, rhs, []( double a, double b ) { return a / b; } );
+    }
+
+    /**
+     * Dot product: dot( Vec3<Force>, Vec3<Length> ) is an Energy.
+     */
+    template<typename Q1, typename Q2, std::size_t N>
+    decltype( Q1() * Q2() ) dot( const Vector<Q1, N>& lhs, const Vector<Q2, N>& rhs ) {
+        const double * a = lhs.data() ;
+        const double * b = rhs.data() ;
+        double sum = 0 ;
+        for( std::size_t i = 0; i < Vector<Q1, N>::LANES; ++i ) {
+            sum += a[i] * b[i] ;
+        }
+        return decltype( Q1() * Q2() )( sum );
+    }
+
+    /**
+     * Cross product: cross( Vec3<Length>, Vec3<Force> ) is a
+     * Vec3<MomentOfForce>.
+     */
+    template<typename Q1, typename Q2>
+    Vec3<decltype( Q1() * Q2() )> cross( const Vec3<Q1>& lhs, const Vec3<Q2>& rhs ) {
+        const double * a = lhs.data() ;
+        const double * b = rhs.data() ;
+        using R = decltype( Q1() * Q2() ) ;
+        return Vec3<R>( R( a[1] * b[2] - a[2] * b[1] ),
+                        R( a[2] * b[0] - a[0] * b[2] ),
+                        R( a[0] * b[1] - a[1] * b[0] ) );
+    }
+
+    /**
+     * Squared Euclidean norm of a vector.
+     */
+    template<typename Q, std::size_t N>
+    decltype( Q() * Q() ) squaredNorm( const Vector<Q, N>& v ) {
+        return dot( v, v );
+    }
+
+    /**
+     * Euclidean norm of a vector.
+     */
+    template<typename Q, std::size_t N>
+    Q norm( const Vector<Q, N>& v ) {
+        return Q( std::sqrt( squaredNorm( v ).getValue() ) );
+    }
+
+    /**
+     * Unit vector in the direction of \c v. The result is dimensionless.
+     */
+    template<typename Q, std::size_t N>
+    Vector<Dimensionless, N> normalized( const Vector<Q, N>& v ) {
+        const double s = 1.0 / norm( v ).getValue() ;
+        return detail::lanewise<Dimensionless>( v, [s]( double a ) { return a * s; } );
+    }
+
+    template<typename Q, std::size_t N>
+    std::ostream& operator<<( std::ostream& os, const Vector<Q, N>& v )
+    {
+        os << "(" ;
+        for( std::size_t i = 0; i < N; ++i ) {
+            os << ( i == 0 ? "" : ", " ) << v[i] ;
+        }
+        os << ")" ;
+        return os ;
+    }
+
+}
+// namespace SciQ;
+
+#endif /* VECTOR_HPP_ */
@@ -11,6 +11,29 @@
 
 #include "ScientificQuantities.hpp"
 #include "PhysicalConstants.hpp"
+#include "DynamicQuantity.hpp"
+#include "BinaryIO.hpp"
+#include "MappedColumn.hpp"
+#include "RollingWindow.hpp"
+#include "Table.hpp"
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#include "Integrators.hpp"
+#include "ParticleSystem.hpp"
+#include "Parallel.hpp"
+#include "Cumulative.hpp"
+#include "Measured.hpp"
+#include "Dual.hpp"
+#include "Interval.hpp"
+#include "Complex.hpp"
+#include "TimePoint.hpp"
+#include "Stopwatch.hpp"
+#include "Sort.hpp"
+#include "Histogram.hpp"
+#include "QuantileSketch.hpp"
+#include "SeriesCodec.hpp"
+#include "QuantizedArray.hpp"
+#include "HalfPrecision.hpp"
 
 using namespace SciQ;
 using namespace std;
@@ -191,6 +214,286 @@ int main( int argc, char ** argv ) {
         << "\tunit is accepted\n"
         << "\tvalue = " << val << endl;
 
+    // Quantities with a dimension known only at runtime
+    DynamicQuantity dq;
+    if( ! from_string( val_unit_str, &dq ) ) {
+      cout << "parse failed\n";
+    }
+    DynamicQuantity dq_speed = DynamicQuantity( l1 ) / t1;
+    cout << "\n\tDynamic quantity parsed from \"" << val_unit_str << "\" = " << dq
+         << " (" << sizeof(Dimension) << " byte dimension)" << endl;
+    cout << "\t" << l1 << " / " << t1 << " as a dynamic quantity = " << dq_speed
+         << "; as Speed = " << dq_speed.as<Speed>() << endl;
+    try {
+      dq_speed.as<Time>();
+    }
+    catch( const std::invalid_argument& e ) {
+      cout << "\tConverting it to Time fails: " << e.what() << endl;
+    }
+
+    // Binary storage of quantity arrays
+    std::vector<Pressure> pressures = { 1_bar, 2_atm, 300_Pa };
+    std::stringstream binary;
+    write_binary( binary, pressures );
+    std::vector<Pressure> pressures_read = read_binary<Pressure>( binary );
+    const std::string bytes = binary.str();
+    std::vector<double> aligned( bytes.size() / sizeof(double) );
+    std::memcpy( aligned.data(), bytes.data(), bytes.size() );
+    BinaryArrayView<Pressure> pressure_view( aligned.data(), bytes.size() );
+    cout << "\n\tWrote " << pressures.size() << " pressures in " << bytes.size() << " bytes, read back "
+         << pressures_read[1] << ", viewed in place " << pressure_view[2] << endl;
+
+    // Memory-mapped column files
+    const std::string column_file = "test_column.sciq";
+    std::remove( column_file.c_str() );
+    {
+      ColumnWriter<Speed> writer( column_file );
+      for( int i = 0; i < 1000; ++i ) {
+        writer.append( Speed( i ) );
+      }
+    }
+    MappedColumn<Speed> speeds( column_file );
+    speeds.advise( ColumnAccess::Sequential );
+    Speed speed_sum;
+    speeds.forEachChunk( [&speed_sum]( const Speed * first, const Speed * last ) {
+      for( ; first != last; ++first ) {
+        speed_sum += *first;
+      }
+    }, 4096 );
+    cout << "\tMapped a column of " << speeds.size() << " speeds, sum = " << speed_sum << endl;
+    std::remove( column_file.c_str() );
+
+    // Rolling statistics over the last samples
+    RollingWindow<Pressure, 4> window;
+    for( Pressure p : { 1_Pa, 3_Pa, 2_Pa, 5_Pa, 4_Pa } ) {
+      window.push( p );
+    }
+    cout << "\n\tRolling window of the last " << window.size() << " pressures: mean = " << window.mean()
+         << ", min = " << window.min() << ", max = " << window.max()
+         << ", variance = " << window.variance() << endl;
+
+    // Table lookup with interpolation
+    Table1D<Length, Pressure> pressure_vs_altitude( { 0_m, 1000_m, 2000_m, 3000_m },
+        { Pressure(101325), Pressure(89875), Pressure(79495), Pressure(70109) }, Interpolation::Cubic );
+    cout << "\n\tPressure at " << 1500_m << " from a cubic table: " << pressure_vs_altitude( 1500_m ) << endl;
+
+    // Vectors of quantities
+    Vec3<Length> arm( 1_m, 0_m, 0_m );
+    Vec3<Force> push( 0_N, 10_N, 0_N );
+    Vec3<MomentOfForce> torque = cross( arm, push );
+    Vec3<Speed> velocity( 3_mps, 4_mps, 0_mps );
+    cout << "\n\t" << arm << " x " << push << " = " << torque << endl;
+    cout << "\t|" << velocity << "| = " << norm( velocity ) << ", after " << t1 << " moved "
+         << velocity * t1 << ", direction " << normalized( velocity ) << endl;
+
+    // State vectors and covariance matrices with per-element quantities
+    using State = StateVector<Length, Speed>;
+    State state( 0_m, 2_mps );
+    Covariance<State> covariance;
+    covariance.set<0,0>( 1_m2 );
+    covariance.set<1,1>( 0.1_mps * 1_mps );
+    Matrix<State, State> transition = Matrix<State, State>::identity();
+    transition.set<0,1>( 1_s );
+    state = transition * state;
+    covariance = transition * covariance * transpose( transition );
+    cout << "\n\tPredicted state: " << state.get<0>() << ", " << state.get<1>()
+         << "; position variance " << covariance.get<0,0>() << endl;
+
+    // Integrating a Speed yields a Length
+    auto falling = []( const Time& t, const Length& ) { return Speed( 9.81 * t.getValue() ); };
+    Length fallen = integrate( falling, 0_s, 0_m, 2_s, 0.1_s );
+    std::size_t accepted = 0;
+    Length fallen_adaptive = integrateAdaptive( falling, 0_s, 0_m, 2_s, 1e-6_m, 1e-9, 0.1_s, &accepted );
+    cout << "\n\tFallen in " << 2_s << ": " << fallen << " (RK4), " << fallen_adaptive
+         << " (RK45, " << accepted << " steps)" << endl;
+
+    // A satellite in a circular orbit around the earth
+    ParticleSystem orbit;
+    const Length radius = 7000_km;
+    orbit.add( Vec3<Length>(), Vec3<Speed>(), MassOfEarth );
+    orbit.add( Vec3<Length>( radius, 0_m, 0_m ),
+               Vec3<Speed>( 0_mps, Speed( std::sqrt( ( GravitationalConstant * MassOfEarth / radius ).getValue() ) ), 0_mps ), 1000_kg );
+    const Energy orbit_energy = orbit.totalEnergy();
+    for( int i = 0; i < 600; ++i ) {
+      orbit.step( 1_s );
+    }
+    cout << "\n\tSatellite after " << 600_s << ": altitude " << norm( orbit.position( 1 ) - orbit.position( 0 ) ) - radius
+         << " above the initial orbit, energy drift " << orbit.totalEnergy() - orbit_energy << endl;
+
+    // Parallel algorithms keep the quantities of the callables
+    std::vector<Time> intervals( 100000, 0.01_s );
+    std::vector<Time> timestamps( intervals.size() );
+    parallel::inclusive_scan( intervals.data(), intervals.data() + intervals.size(), timestamps.data() );
+    std::vector<Speed> walking( intervals.size(), 2_mps );
+    std::vector<Length> steps = parallel::transform( walking, []( const Speed& v ) { return v * 0.01_s; } );
+    cout << "\n\tAfter " << intervals.size() << " intervals: t = " << timestamps.back() << ", distance "
+         << parallel::reduce( steps.data(), steps.data() + steps.size() ) << endl;
+
+    // Cumulative integral of sampled power is an energy series
+    std::vector<Power> consumption = { 100_W, 120_W, 140_W, 120_W, 100_W };
+    std::vector<Energy> consumed = cumtrapz( consumption, 60_s );
+    cout << "\n\tEnergy used after " << consumption.size() - 1 << " minutes: " << consumed.back()
+         << ", running total of the samples " << cumsum( consumption ).back() << endl;
+
+    // First order propagation of measurement uncertainty
+    Measured<Length> lever( 0.5_m, 0.005_m );
+    Measured<Force> load( 200_N, 4_N );
+    Measured<MomentOfForce> moment = lever * load;
+    cout << "\n\tMoment " << moment << " (" << 100 * moment.relativeError() << " %), lever^2 = "
+         << pow<2>( lever ) << ", sqrt(lever) = " << sqrt( lever ) << endl;
+
+    // Derivatives carry their own dimension: dP/dU is a current
+    auto supply = Dual<Voltage, Voltage>::variable( 12_V );
+    Dual<Power, Voltage> dissipated = supply * supply / 6_Ohm;
+    Current dp_du = dissipated.derivative();
+    using Sensitivity = MultiDual<Power, Voltage, Resistance>;
+    Sensitivity heat = pow<2>( MultiDual<Voltage, Voltage, Resistance>::variable<0>( 12_V ) )
+                       / MultiDual<Resistance, Voltage, Resistance>::variable<1>( 6_Ohm );
+    cout << "\n\tP = " << dissipated.value() << ", dP/dU = " << dp_du << ", dP/dR = " << heat.partial<1>() << endl;
+
+    // Guaranteed bounds: is the contact pressure certainly below the limit?
+    Interval<Force> clamping( 900_N, 1100_N );
+    Interval<Area> pad( 0.0099_m2, 0.0101_m2 );
+    Interval<Pressure> contact = clamping / pad;
+    cout << "\n\tContact pressure " << contact << ", below 120 kPa: " << ( contact < 120000_Pa )
+         << ", below 110 kPa: " << ( contact < 110000_Pa ) << ", sqrt(pad) = " << sqrt( pad ) << endl;
+
+    // Phasors: a series RLC circuit at 50 Hz
+    AngularVelocity omega = 2 * M_PI * 50_Hz;
+    Impedance rlc( 10_Ohm, omega * 0.1_H - 1 / ( omega * 100e-6_F ) );
+    Complex<Current> phasor = Complex<Voltage>( 230_V ) / rlc;
+    cout << "\n\tZ = " << rlc << ", |I| = " << abs( phasor ) << " at " << arg( phasor ).in( degree )
+         << " deg, S = " << Complex<Voltage>( 230_V ) * conj( phasor ) << endl;
+
+    // std::chrono interop and integer nanosecond timestamps
+    Time slice = std::chrono::milliseconds( 20 );
+    std::chrono::duration<double, std::milli> sliceMs = slice;
+    TimePoint stamp = TimePoint::fromNanoseconds( 1700000000000000000 );
+    TimePoint next = stamp + std::chrono::nanoseconds( 1 );
+    cout << "\n\tSlice " << slice << " = " << sliceMs.count() << " ms = "
+         << toDuration<std::chrono::microseconds>( slice ).count() << " us; " << next << " is "
+         << ( next - stamp ) << " after " << stamp << endl;
+
+    // Timing code sections in Time quantities
+    Stopwatch watch = Stopwatch::started();
+    Length summed = 0_m;
+    for( int i = 0; i < 1000; ++i ) {
+        SCIQ_TIME_SCOPE( "summation step" );
+        summed += 1_mm;
+    }
+    Time spent = watch.stop();
+    cout << "\n\tSummed " << summed << " in " << spent.in( microsecond ) << " us, "
+         << TimerSite::all().back()->count() << " steps timed" << endl;
+
+    // Radix sort and searches over quantity arrays
+    std::vector<Time> arrivals = { 4.5_s, 0.25_s, 3_s, 1_s, 2.5_s, 0.75_s };
+    SciQ::sort( arrivals );
+    EytzingerIndex<Time> arrivalIndex( arrivals );
+    cout << "\n\tArrivals " << arrivals.front() << " to " << arrivals.back() << ", first at or after 2 s is #"
+         << SciQ::lower_bound( arrivals, 2_s ) << " = #" << arrivalIndex.lower_bound( 2_s )
+         << ", " << SciQ::upper_bound( arrivals, 3_s ) << " arrive by 3 s" << endl;
+
+    // Histogram of voltage samples
+    Histogram<Voltage> ripple( 11_V, 13_V, 4 );
+    ripple.add( std::vector<Voltage>{ 11.9_V, 12.1_V, 12.2_V, 12.4_V, 12.6_V, 13.5_V } );
+    cout << "\n\tMost samples in the bin around " << ripple.center( ripple.maximum() ) << " of width "
+         << ripple.width( ripple.maximum() ) << ", density " << ripple.density( ripple.maximum() )
+         << ", " << ripple.overflow() << " above" << endl;
+
+    // Mergeable quantile sketches of power draw
+    QuantileSketch<Power> nodeA, nodeB;
+    for( int i = 1; i <= 1000; ++i ) {
+        nodeA.add( Power( i ) );
+        nodeB.add( Power( 1000 + i ) );
+    }
+    std::vector<unsigned char> wire = nodeB.serialize();
+    nodeA += QuantileSketch<Power>::deserialize( wire );
+    cout << "\n\tPower draw of " << nodeA.count() << " samples: median " << nodeA.quantile( 0.5 )
+         << ", p99 " << nodeA.quantile( 0.99 ) << ", sketch of " << wire.size() << " bytes" << endl;
+
+    // Every quantile of a small sketch lies within its extremes
+    std::size_t strays = 0;
+    for( double compression : { 10.0, 20.0, 100.0 } ) {
+        for( int n = 1; n <= 2100; ++n ) {
+            QuantileSketch<Power> small( compression );
+            for( int i = 1; i <= n; ++i ) {
+                small.add( Power( i ) );
+            }
+            for( int k = 0; k <= 32; ++k ) {
+                for( double q : { k / 32.0, double( k ) / n, double( n - k ) / n } ) {
+                    const Power p = small.quantile( q );
+                    if( !( p >= small.min() && p <= small.max() ) ) {
+                        ++strays;
+                    }
+                }
+            }
+        }
+    }
+    if( strays != 0 ) {
+        throw std::logic_error( "QuantileSketch: " + std::to_string( strays ) + " quantiles outside the extremes" );
+    }
+    cout << "\n\tQuantiles of small sketches within their extremes" << endl;
+
+    // Compressed time series of temperature readings
+    SeriesEncoder<Temperature> logger( true );
+    TimePoint reading = stamp;
+    for( int i = 0; i < 600; ++i ) {
+        logger.append( reading, Temperature( 293.0 + ( i / 60 ) * 0.0625 ) );
+        reading += 1_s;
+    }
+    std::vector<unsigned char> series = logger.finish();
+    SeriesDecoder<Temperature> reader( series );
+    Temperature last;
+    while( reader.next( reading, last ) ) {
+    }
+    cout << "\n\t" << reader.size() << " readings in " << series.size() << " bytes, last " << last
+         << " after " << reading.since( stamp ).count() / 1e9 << " s";
+    try {
+        decodeSeries<Pressure>( series );
+    } catch( const std::invalid_argument& e ) {
+        cout << ", read as pressure: " << e.what();
+    }
+    cout << endl;
+
+    // Voltage trace stored as 16-bit codes of 1 mV
+    QuantizedArray<Voltage, std::int16_t> trace( 0.001_V, 12_V,
+        std::vector<Voltage>{ 11.9874_V, 12.0003_V, 12.0119_V, 12.0502_V, 50_V } );
+    cout << "\n\tTrace of " << trace.size() << " samples in " << trace.bytes() << " bytes: second " << trace[1]
+         << ", mean " << trace.mean() << ", max " << trace.max() << " (saturated), spread " << trace.stddev() << endl;
+
+    // Speed features stored in 16 bits
+    std::vector<Speed> features = { 1.5_mps, 13.89_mps, 340.29_mps };
+    std::vector<HalfQuantity<Speed>> halves = pack<Float16>( features );
+    std::vector<BFloat16Quantity<Speed>> coarse = pack<BFloat16>( features );
+    cout << "\n\tSpeeds in " << sizeof(HalfQuantity<Speed>) << " bytes each: " << unpack( halves )[2] << " as fp16, "
+         << Speed( coarse[2] ) << " as bfloat16" << endl;
+
+    // Checked arithmetic, configure with -DENABLE_CHECKED=ON
+#if defined(SCIQ_CHECKED)
+    checked::Handler previous = checked::setHandler( []( const checked::Violation& v ) {
+        throw std::domain_error( checked::describe( v ) );
+    } );
+    try {
+        SCIQ_CHECK_SCOPE( "speed estimate" );
+        Time stalled = 0_s;
+        Speed estimate = 100_m / stalled;
+        cout << "\n\tSpeed " << estimate << endl;
+    } catch( const std::domain_error& e ) {
+        cout << "\n\t" << e.what() << endl;
+    }
+    checked::setHandler( previous );
+#endif
+
+    // Operation counts per dimension, configure with -DENABLE_COUNT_OPS=ON
+#if defined(SCIQ_COUNT_OPS)
+    counters::reset();
+    Length travelled = 0_m;
+    for( int i = 0; i < 10; ++i ) {
+        travelled += 3_m / 1_s * 0.5_s;
+    }
+    cout << "\n\tTravelled " << travelled << endl;
+    counters::print( cout );
+#endif
 	
     return 0;
 }
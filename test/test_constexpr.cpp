@@ -8,6 +8,7 @@
  * indication of a successful test.
  */
 #include "ScientificQuantities.hpp"
+#include "DynamicQuantity.hpp"
 
 using namespace SciQ ;
 
@@ -138,5 +139,24 @@ int main(int argc, char *argv[])
         constexpr double bar = 5.0 ; 
         constexpr auto ratio = bar / foo ; 
     }
+    //
+    // Time and std::chrono
+    //
+    {
+        constexpr Time foo = std::chrono::milliseconds( 1500 ) ;
+        constexpr std::chrono::duration<double, std::milli> bar = foo ;
+        constexpr auto ticks = toDuration<std::chrono::microseconds>( foo ) ;
+        static_assert( ticks.count() == 1500000, "1.5 s must be 1500000 us" ) ;
+    }
+    //
+    // DynamicQuantity
+    //
+    {
+        constexpr DynamicQuantity foo = Length(1.0) ;
+        constexpr DynamicQuantity bar = Time(2.0) ;
+        constexpr auto ratio = foo / bar ;
+        static_assert( ratio.getDimension() == dimensionOf<Speed>(), "Length/Time must be a Speed" ) ;
+        constexpr Speed speed = ratio.as<Speed>() ;
+    }
     return 0 ;
 }